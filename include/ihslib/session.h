@@ -45,6 +45,147 @@ typedef struct IHS_SessionConfig {
     bool enableHevc;
 } IHS_SessionConfig;
 
+typedef struct IHS_SessionPlayoutConfig {
+    /**
+     * Latency budget of video frames in milliseconds, counted from when a frame would arrive without network jitter.
+     * Complete frames are held for up to this long to absorb jitter, and frames not complete by then are dropped.
+     * 0 disables scheduling: frames are released as soon as they are complete.
+     */
+    uint32_t targetLatency;
+} IHS_SessionPlayoutConfig;
+
+typedef enum IHS_SessionVideoQueuePolicy {
+    /**
+     * Drop oldest frames waiting in the queue to make room for new ones
+     */
+    IHS_SessionVideoQueueDropOldest = 0,
+    /**
+     * Drop all frames in the queue, and following frames until next keyframe. A keyframe will be requested.
+     */
+    IHS_SessionVideoQueueSkipToKeyFrame = 1,
+} IHS_SessionVideoQueuePolicy;
+
+typedef struct IHS_SessionVideoQueueConfig {
+    /**
+     * Maximum number of frames waiting for the decoder. When not 0, video submit callbacks will be called from a
+     * dedicated thread, so slow decoding won't block receiving.
+     * 0 disables the queue: frames are submitted from the receiving thread.
+     */
+    uint32_t depth;
+    /**
+     * What to do when the queue is full
+     */
+    IHS_SessionVideoQueuePolicy policy;
+} IHS_SessionVideoQueueConfig;
+
+/**
+ * Priority of outgoing packets. Packets of a higher class are always sent first.
+ * @note Classes only reorder packets of different channels. All control messages, large or not, share one class, as
+ *       the host handles them in order, so input queued after a large control message still waits for it.
+ */
+typedef enum IHS_SessionSendClass {
+    /**
+     * ACKs, control messages including input, data loss reports and discovery packets
+     */
+    IHS_SessionSendClassInteractive = 0,
+    /**
+     * Stats reports, sent only when there's nothing interactive to send
+     */
+    IHS_SessionSendClassBulk = 1,
+    IHS_SessionSendClassCount,
+} IHS_SessionSendClass;
+
+typedef struct IHS_SessionInputConfig {
+    /**
+     * Interval in milliseconds to send accumulated mouse and touch motion. Relative movements are summed up, and only
+     * the latest position is kept. Button, key, wheel and touch down/up events send pending motion first.
+     * 0 disables coalescing: every motion is sent right away.
+     */
+    uint32_t coalesceInterval;
+} IHS_SessionInputConfig;
+
+/**
+ * Number of buckets in latency histograms. Bucket 0 counts latencies below 1ms, bucket n counts latencies from
+ * 2^(n-1)ms to 2^n ms, and the last bucket counts all longer latencies.
+ */
+#define IHS_SESSION_LATENCY_HISTOGRAM_SIZE 8
+
+typedef struct IHS_SessionStats {
+    /**
+     * Number of receive syscalls that returned data
+     */
+    uint64_t receiveCalls;
+    /**
+     * Number of datagrams received. Divide by receiveCalls to get packets per syscall.
+     */
+    uint64_t packetsReceived;
+    /**
+     * Maximum number of packet buffers kept by the session
+     */
+    size_t packetPoolCapacity;
+    /**
+     * Largest number of packet buffers in use at the same time
+     */
+    size_t packetPoolHighWaterMark;
+    /**
+     * Number of times a packet buffer had to be allocated while packetPoolCapacity buffers were already in use
+     */
+    uint64_t packetPoolExhausted;
+    /**
+     * Interarrival jitter of video packets in microseconds
+     */
+    uint32_t videoJitter;
+    /**
+     * Number of video frames dropped because they were not complete before their deadline
+     */
+    uint64_t videoFramesIncomplete;
+    /**
+     * Number of video frames dropped because they were completed after their deadline
+     */
+    uint64_t videoFramesLate;
+    /**
+     * Number of video frames waiting in the queue for the decoder
+     */
+    uint32_t videoQueueDepth;
+    /**
+     * Number of video frames dropped because the queue was full
+     */
+    uint64_t videoQueueFramesDropped;
+    /**
+     * Histogram of video decoding time, from decode begin to decode end
+     */
+    uint64_t videoDecodeLatency[IHS_SESSION_LATENCY_HISTOGRAM_SIZE];
+    /**
+     * Histogram of client side video latency, from frame received to displayed
+     */
+    uint64_t videoDisplayLatency[IHS_SESSION_LATENCY_HISTOGRAM_SIZE];
+    /**
+     * Smoothed round trip time in microseconds, measured from acknowledged packets. 0 if not measured yet.
+     */
+    uint32_t roundTripTime;
+    /**
+     * Round trip time variation in microseconds
+     */
+    uint32_t roundTripTimeVariance;
+    /**
+     * Current retransmission timeout in milliseconds, before backoff
+     */
+    uint32_t retransmissionTimeout;
+    /**
+     * Number of packets sent, indexed by IHS_SessionSendClass. Retransmitted packets are counted again in their class.
+     * @note Stats only tell apart what the session sends with each class, see IHS_SessionSendClass for what's bulk
+     */
+    uint64_t packetsSent[IHS_SessionSendClassCount];
+    /**
+     * Smoothed time packets waited in the send queue until sent in microseconds, indexed by IHS_SessionSendClass
+     */
+    uint32_t sendQueueLatency[IHS_SessionSendClassCount];
+    /**
+     * Longest time a packet waited in the send queue in microseconds, indexed by IHS_SessionSendClass
+     */
+    uint32_t sendQueueMaxLatency[IHS_SessionSendClassCount];
+} IHS_SessionStats;
+
 typedef struct IHS_StreamSessionCallbacks {
     void (*initialized)(IHS_Session *session, void *context);
 
@@ -115,4 +256,44 @@ void IHS_SessionSetInputCallbacks(IHS_Session *session, const IHS_StreamInputCal
 
 void IHS_SessionSetLogFunction(IHS_Session *session, IHS_LogFunction *logFunction);
 
-const IHS_SessionInfo *IHS_SessionGetInfo(const IHS_Session *session);
\ No newline at end of file
+const IHS_SessionInfo *IHS_SessionGetInfo(const IHS_Session *session);
+
+/**
+ * Take a snapshot of session statistics. Counters are cumulative since the session was created.
+ * @param session Session instance
+ * @param stats Stats to fill
+ */
+void IHS_SessionGetStats(const IHS_Session *session, IHS_SessionStats *stats);
+
+/**
+ * Change when received video frames are handed to the decoder. Can be called at any time.
+ * @param session Session instance
+ * @param config Playout config
+ */
+void IHS_SessionSetPlayoutConfig(IHS_Session *session, const IHS_SessionPlayoutConfig *config);
+
+/**
+ * Change how video frames are queued for the decoder. Takes effect when next video stream starts.
+ * @param session Session instance
+ * @param config Queue config
+ */
+void IHS_SessionSetVideoQueueConfig(IHS_Session *session, const IHS_SessionVideoQueueConfig *config);
+
+/**
+ * Change how mouse and touch motion are sent. Can be called at any time.
+ * @param session Session instance
+ * @param config Input config
+ */
+void IHS_SessionSetInputConfig(IHS_Session *session, const IHS_SessionInputConfig *config);
+
+/**
+ * Report progress of a video frame given to submitFrame callback, so the host and session stats get measured
+ * decoding and display latency. Once any event is reported, frames are only considered displayed after
+ * IHS_StreamVideoFrameEventComplete is reported for them. Can be called from any thread.
+ * @param session Session instance
+ * @param frameId ID from IHS_StreamVideoFrameGetId
+ * @param event Event happened to the frame
+ * @param timestamp Time of the event in microseconds of CLOCK_MONOTONIC, or 0 for current time
+ */
+void IHS_SessionVideoReportFrameEvent(IHS_Session *session, uint16_t frameId, IHS_StreamVideoFrameEvent event,
+                                      uint64_t timestamp);
\ No newline at end of file
@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 
@@ -61,12 +62,121 @@ typedef enum IHS_StreamVideoSubmitResult {
     IHS_StreamVideoSubmitError = -1,
 } IHS_StreamVideoSubmitResult;
 
+/**
+ * Reference counted video frame. It will be recycled by the library after the last reference is released.
+ */
+typedef struct IHS_StreamVideoFrame IHS_StreamVideoFrame;
+
+/**
+ * Position of a NAL unit in H264 or HEVC frame data
+ */
+typedef struct IHS_StreamVideoNALUnit {
+    /**
+     * Offset of NAL unit header, after the start code
+     */
+    uint32_t offset;
+    /**
+     * Length of NAL unit, without the start code
+     */
+    uint32_t length;
+    /**
+     * NAL unit type from the header
+     */
+    uint8_t type;
+} IHS_StreamVideoNALUnit;
+
+/**
+ * Part of a video frame, submitted as soon as it's received in order
+ */
+typedef struct IHS_StreamVideoSlice {
+    /**
+     * Slice data, only valid during the call
+     */
+    const uint8_t *data;
+    size_t size;
+    /**
+     * Same for all slices of a frame
+     */
+    uint16_t frameId;
+    IHS_StreamVideoFrameFlag flags;
+    /**
+     * Set for the last slice of the frame. A frame can also end without it if the rest of it was lost,
+     * in that case next slice will have a different frameId.
+     */
+    bool endOfFrame;
+} IHS_StreamVideoSlice;
+
+/**
+ * Client side events of a video frame, reported with IHS_SessionVideoReportFrameEvent
+ */
+typedef enum IHS_StreamVideoFrameEvent {
+    IHS_StreamVideoFrameEventDecodeBegin = 14,
+    IHS_StreamVideoFrameEventDecodeEnd = 15,
+    IHS_StreamVideoFrameEventUploadBegin = 16,
+    IHS_StreamVideoFrameEventUploadEnd = 17,
+    /**
+     * Frame has been displayed
+     */
+    IHS_StreamVideoFrameEventComplete = 18,
+} IHS_StreamVideoFrameEvent;
+
 typedef struct IHS_StreamVideoCallbacks {
     int (*start)(IHS_Session *session, const IHS_StreamVideoConfig *config, void *context);
 
     IHS_StreamVideoSubmitResult (*submit)(IHS_Session *session, IHS_Buffer *data, IHS_StreamVideoFrameFlag flags, void *context);
 
+    /**
+     * Optional. If set, it will be used instead of submit, so decoder can keep the frame data without copying.
+     * Callee owns one reference of the frame, and must call IHS_StreamVideoFrameRelease when done with it.
+     * Release can be called from any thread, even after the session is destroyed.
+     * Decoding progress of the frame can be reported with IHS_SessionVideoReportFrameEvent.
+     */
+    IHS_StreamVideoSubmitResult (*submitFrame)(IHS_Session *session, IHS_StreamVideoFrame *frame, void *context);
+
     void (*stop)(IHS_Session *session, void *context);
 
     int (*setCaptureSize)(IHS_Session *session, int width, int height, void *context);
-} IHS_StreamVideoCallbacks;
\ No newline at end of file
+
+    /**
+     * Optional. Called before submitting a keyframe with changed codec parameter sets (VPS, SPS and PPS), so decoder
+     * can be configured before the first keyframe, or reconfigured after resolution changes.
+     * Called from the same thread as submit callbacks.
+     * @param paramSets All known parameter sets in Annex B format
+     */
+    void (*parameterSetsChanged)(IHS_Session *session, const IHS_Buffer *paramSets, void *context);
+
+    /**
+     * Optional. If set, it will be used instead of submit and submitFrame, and frame data will be submitted as soon as
+     * each part of it is received in order, so decoding can start before the whole frame arrives.
+     * Called from the receiving thread, so the video queue is not used.
+     * Result of slices is handled once the frame ends, or when the frame is cut short.
+     */
+    IHS_StreamVideoSubmitResult (*submitSlice)(IHS_Session *session, const IHS_StreamVideoSlice *slice, void *context);
+} IHS_StreamVideoCallbacks;
+
+IHS_Buffer *IHS_StreamVideoFrameGetData(IHS_StreamVideoFrame *frame);
+
+IHS_StreamVideoFrameFlag IHS_StreamVideoFrameGetFlags(const IHS_StreamVideoFrame *frame);
+
+/**
+ * @return ID to identify this frame in IHS_SessionVideoReportFrameEvent
+ */
+uint16_t IHS_StreamVideoFrameGetId(const IHS_StreamVideoFrame *frame);
+
+/**
+ * Get NAL units in frame data, so decoder doesn't need to look for start codes
+ * @param count Number of NAL units. It will be 0 for codecs other than H264 and HEVC.
+ * @return NAL units in order. Valid until the frame is released.
+ */
+const IHS_StreamVideoNALUnit *IHS_StreamVideoFrameGetNALUnits(const IHS_StreamVideoFrame *frame, size_t *count);
+
+/**
+ * Add a reference to the frame
+ * @return The same frame
+ */
+IHS_StreamVideoFrame *IHS_StreamVideoFrameRetain(IHS_StreamVideoFrame *frame);
+
+/**
+ * Remove a reference from the frame. Frame data must not be accessed after the last reference is released.
+ */
+void IHS_StreamVideoFrameRelease(IHS_StreamVideoFrame *frame);
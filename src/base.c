@@ -33,13 +33,21 @@
 #include "endianness.h"
 #include "crypto.h"
 #include "ihs_buffer.h"
+#include "crc32c.h"
+
+#define RECV_BATCH_SIZE 16
 
 static void BaseWorker(IHS_Base *base);
 
+static void ReceiveBufferObtain(IHS_Base *base, IHS_Buffer *buffer);
+
+static void ReceiveBufferRecycle(IHS_Base *base, IHS_Buffer *buffer);
+
 static bool initialized;
 
 void IHS_Init() {
     initialized = true;
+    IHS_CRC32CInit();
     IHS_TimerInit();
 }
 
@@ -156,6 +164,14 @@ bool IHS_BaseSend(IHS_Base *base, IHS_SocketAddress address, const IHS_Buffer *d
     return IHS_UDPSocketSend(base->socket, &packet);
 }
 
+int IHS_BaseSendBatch(IHS_Base *base, const IHS_UDPPacket *packets, int count) {
+    assert(base != NULL);
+    if (base->socket == NULL) {
+        return 0;
+    }
+    return IHS_UDPSocketSendBatch(base->socket, packets, count);
+}
+
 void IHS_BaseLock(IHS_Base *base) {
     assert(base != NULL);
     IHS_MutexLock(base->lock);
@@ -172,22 +188,50 @@ static void BaseWorker(IHS_Base *base) {
     if (base->callbacks.run && base->callbacks.run->initialized) {
         base->callbacks.run->initialized(base, base->callbackContexts.run);
     }
-    IHS_UDPPacket recv;
-    IHS_BufferInit(&recv.buffer, 2048, 2048);
+    IHS_UDPPacket recv[RECV_BATCH_SIZE];
+    for (int i = 0; i < RECV_BATCH_SIZE; i++) {
+        ReceiveBufferObtain(base, &recv[i].buffer);
+    }
     while (!base->interrupted) {
         int ret;
-        if ((ret = IHS_UDPSocketReceive(base->socket, &recv)) < 0) {
+        if ((ret = IHS_UDPSocketReceiveBatch(base->socket, recv, RECV_BATCH_SIZE)) < 0) {
             break;
         }
         if (ret) {
-            base->callbacks.received(base, &recv.address, &recv.buffer);
+            base->stats.receiveCalls++;
+            base->stats.packetsReceived += ret;
+            base->callbacks.received(base, recv, ret);
+        }
+        for (int i = 0; i < ret; i++) {
+            if (IHS_BufferIsNull(&recv[i].buffer)) {
+                // Ownership has been taken by the callback
+                ReceiveBufferObtain(base, &recv[i].buffer);
+            } else {
+                IHS_BufferClear(&recv[i].buffer, false);
+            }
         }
-        IHS_BufferClear(&recv.buffer, false);
     }
-    IHS_BufferClear(&recv.buffer, true);
+    for (int i = 0; i < RECV_BATCH_SIZE; i++) {
+        ReceiveBufferRecycle(base, &recv[i].buffer);
+    }
     if (base->callbacks.run && base->callbacks.run->finalized) {
         base->callbacks.run->finalized(base, base->callbackContexts.run);
     }
     IHS_UDPSocketClose(base->socket);
 }
 
+static void ReceiveBufferObtain(IHS_Base *base, IHS_Buffer *buffer) {
+    if (base->receivePool != NULL) {
+        IHS_BufferPoolObtain(base->receivePool, buffer);
+    } else {
+        IHS_BufferInit(buffer, 2048, 2048);
+    }
+}
+
+static void ReceiveBufferRecycle(IHS_Base *base, IHS_Buffer *buffer) {
+    if (base->receivePool != NULL) {
+        IHS_BufferPoolRecycle(base->receivePool, buffer);
+    } else {
+        IHS_BufferClear(buffer, true);
+    }
+}
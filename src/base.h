@@ -32,10 +32,17 @@
 #include "ihs_udp.h"
 #include "ihs_thread.h"
 #include "ihs_timer.h"
+#include "ihs_buffer_pool.h"
 
 typedef struct IHS_Base IHS_Base;
 
-typedef void (IHS_BaseReceivedFunction)(IHS_Base *base, const IHS_SocketAddress *address, IHS_Buffer *buffer);
+/**
+ * Called from the worker thread with every datagram returned by one receive call.
+ * @param base Base instance
+ * @param packets Received packets. Buffers can be taken over by the callee.
+ * @param count Number of packets
+ */
+typedef void (IHS_BaseReceivedFunction)(IHS_Base *base, IHS_UDPPacket *packets, size_t count);
 
 typedef struct IHS_BaseRunCallbacks {
     void (*initialized)(IHS_Base *base, void *context);
@@ -66,10 +73,22 @@ struct IHS_Base {
 
     bool broadcast;
     IHS_UDPSocket *socket;
+    /**
+     * If set, receive buffers will be taken from this pool. Not owned by base.
+     */
+    IHS_BufferPool *receivePool;
 
     IHS_Thread *worker;
     IHS_Mutex *lock;
     bool interrupted;
+
+    /**
+     * Only written by worker thread
+     */
+    struct {
+        uint64_t receiveCalls;
+        uint64_t packetsReceived;
+    } stats;
 };
 
 #define IHS_UNUSED(x) (void) (x)
@@ -104,6 +123,15 @@ void IHS_BaseDestroy(IHS_Base *base);
  */
 bool IHS_BaseSend(IHS_Base *base, IHS_SocketAddress address, const IHS_Buffer *data);
 
+/**
+ * Send multiple datagrams immediately, in order. Failed ones are skipped.
+ * @param base Base instance
+ * @param packets Packets to send
+ * @param count Number of packets
+ * @return Number of packets sent
+ */
+int IHS_BaseSendBatch(IHS_Base *base, const IHS_UDPPacket *packets, int count);
+
 void IHS_BaseLock(IHS_Base *base);
 
 void IHS_BaseUnlock(IHS_Base *base);
\ No newline at end of file
@@ -42,7 +42,9 @@ static void ClientInitialized(IHS_Base *base, void *context);
 
 static const unsigned char PACKET_MAGIC[8] = {0xff, 0xff, 0xff, 0xff, 0x21, 0x4c, 0x5f, 0xa0};
 
-static void ClientRecvCallback(IHS_Base *base, const IHS_SocketAddress *address, IHS_Buffer *data);
+static void ClientRecvCallback(IHS_Base *base, IHS_UDPPacket *packets, size_t count);
+
+static void ClientPacketReceived(IHS_Base *base, const IHS_SocketAddress *address, IHS_Buffer *data);
 
 static const ProtobufCMessageDescriptor *MessageDescriptors[k_ERemoteDeviceStreamingProgress + 1] = {
         &cmsg_remote_client_broadcast_discovery__descriptor,
@@ -155,7 +157,13 @@ bool IHS_ClientBroadcast(IHS_Client *client, ERemoteClientBroadcastMsg type,
     return IHS_ClientSend(client, address, type, message);
 }
 
-static void ClientRecvCallback(IHS_Base *base, const IHS_SocketAddress *address, IHS_Buffer *data) {
+static void ClientRecvCallback(IHS_Base *base, IHS_UDPPacket *packets, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        ClientPacketReceived(base, &packets[i].address, &packets[i].buffer);
+    }
+}
+
+static void ClientPacketReceived(IHS_Base *base, const IHS_SocketAddress *address, IHS_Buffer *data) {
     if (memcmp(IHS_BufferPointer(data), PACKET_MAGIC, sizeof(PACKET_MAGIC)) != 0) {
         IHS_BaseLog(base, IHS_LogLevelDebug, "Client", "Unrecognized packet!");
         return;
@@ -104,7 +104,7 @@ static uint32_t crctable[256] = {
         0xBE2DA0A5L, 0x4C4623A6L, 0x5F16D052L, 0xAD7D5351L
 };
 
-uint32_t IHS_CRC32C(const uint8_t *buf, size_t len)
+uint32_t IHS_CRC32CTable(const uint8_t *buf, size_t len)
 {
     uint32_t crc = 0xffffffff;
     while (len-- > 0) {
@@ -27,5 +27,34 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
 
-uint32_t IHS_CRC32C(const uint8_t *buf, size_t len);
\ No newline at end of file
+/**
+ * Calculate CRC32C with the fastest implementation available. Table lookup will be used until IHS_CRC32CInit is called.
+ */
+uint32_t IHS_CRC32C(const uint8_t *buf, size_t len);
+
+/**
+ * Detect CPU features and select implementation for IHS_CRC32C. Called by IHS_Init.
+ */
+void IHS_CRC32CInit();
+
+/**
+ * Byte-at-a-time table lookup
+ */
+uint32_t IHS_CRC32CTable(const uint8_t *buf, size_t len);
+
+/**
+ * Portable slicing-by-8. Only usable after IHS_CRC32CInit.
+ */
+uint32_t IHS_CRC32CSlicing8(const uint8_t *buf, size_t len);
+
+/**
+ * @return true if IHS_CRC32CHardware is supported by this CPU
+ */
+bool IHS_CRC32CHardwareSupported();
+
+/**
+ * SSE4.2 on x86, or CRC extension on ARMv8. Must only be called when IHS_CRC32CHardwareSupported returns true.
+ */
+uint32_t IHS_CRC32CHardware(const uint8_t *buf, size_t len);
@@ -0,0 +1,173 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "crc32c.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define CRC32C_HW_X86
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#define CRC32C_HW_ARM64
+#endif
+
+/* Reversed 0x1EDC6F41 */
+#define CRC32C_POLY 0x82F63B78u
+
+typedef uint32_t (CRC32CFunction)(const uint8_t *buf, size_t len);
+
+static CRC32CFunction *CRC32CImpl = IHS_CRC32CTable;
+
+static uint32_t slicingTable[8][256];
+
+static void SlicingTableInit();
+
+uint32_t IHS_CRC32C(const uint8_t *buf, size_t len) {
+    return CRC32CImpl(buf, len);
+}
+
+void IHS_CRC32CInit() {
+    SlicingTableInit();
+    CRC32CImpl = IHS_CRC32CHardwareSupported() ? IHS_CRC32CHardware : IHS_CRC32CSlicing8;
+}
+
+uint32_t IHS_CRC32CSlicing8(const uint8_t *buf, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    while (len >= 8) {
+        uint32_t lo = crc ^ ((uint32_t) buf[0] | (uint32_t) buf[1] << 8 | (uint32_t) buf[2] << 16 |
+                             (uint32_t) buf[3] << 24);
+        uint32_t hi = (uint32_t) buf[4] | (uint32_t) buf[5] << 8 | (uint32_t) buf[6] << 16 | (uint32_t) buf[7] << 24;
+        crc = slicingTable[7][lo & 0xFF] ^ slicingTable[6][(lo >> 8) & 0xFF] ^
+              slicingTable[5][(lo >> 16) & 0xFF] ^ slicingTable[4][lo >> 24] ^
+              slicingTable[3][hi & 0xFF] ^ slicingTable[2][(hi >> 8) & 0xFF] ^
+              slicingTable[1][(hi >> 16) & 0xFF] ^ slicingTable[0][hi >> 24];
+        buf += 8;
+        len -= 8;
+    }
+    while (len-- > 0) {
+        crc = (crc >> 8) ^ slicingTable[0][(crc ^ *buf++) & 0xFF];
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+#if defined(CRC32C_HW_X86)
+
+bool IHS_CRC32CHardwareSupported() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+
+__attribute__((target("sse4.2")))
+uint32_t IHS_CRC32CHardware(const uint8_t *buf, size_t len) {
+#if defined(__x86_64__)
+    uint64_t crc = 0xFFFFFFFF;
+    while (len >= 8) {
+        uint64_t value;
+        memcpy(&value, buf, 8);
+        crc = _mm_crc32_u64(crc, value);
+        buf += 8;
+        len -= 8;
+    }
+    uint32_t crc32 = (uint32_t) crc;
+#else
+    uint32_t crc32 = 0xFFFFFFFF;
+#endif
+    while (len >= 4) {
+        uint32_t value;
+        memcpy(&value, buf, 4);
+        crc32 = _mm_crc32_u32(crc32, value);
+        buf += 4;
+        len -= 4;
+    }
+    while (len-- > 0) {
+        crc32 = _mm_crc32_u8(crc32, *buf++);
+    }
+    return crc32 ^ 0xFFFFFFFF;
+}
+
+#elif defined(CRC32C_HW_ARM64)
+
+bool IHS_CRC32CHardwareSupported() {
+#if defined(__ARM_FEATURE_CRC32) || defined(__APPLE__)
+    return true;
+#elif defined(__linux__) && defined(HWCAP_CRC32)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+    return false;
+#endif
+}
+
+#if defined(__clang__)
+__attribute__((target("crc")))
+#else
+__attribute__((target("+crc")))
+#endif
+uint32_t IHS_CRC32CHardware(const uint8_t *buf, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    while (len >= 8) {
+        uint64_t value;
+        memcpy(&value, buf, 8);
+        crc = __crc32cd(crc, value);
+        buf += 8;
+        len -= 8;
+    }
+    while (len-- > 0) {
+        crc = __crc32cb(crc, *buf++);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+#else
+
+bool IHS_CRC32CHardwareSupported() {
+    return false;
+}
+
+uint32_t IHS_CRC32CHardware(const uint8_t *buf, size_t len) {
+    return IHS_CRC32CSlicing8(buf, len);
+}
+
+#endif
+
+static void SlicingTableInit() {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (CRC32C_POLY & (0 - (crc & 1)));
+        }
+        slicingTable[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int slice = 1; slice < 8; slice++) {
+            uint32_t prev = slicingTable[slice - 1][i];
+            slicingTable[slice][i] = (prev >> 8) ^ slicingTable[0][prev & 0xFF];
+        }
+    }
+}
@@ -43,6 +43,67 @@ int IHS_CryptoSymmetricDecrypt(const uint8_t *in, size_t inLen, const uint8_t *k
 int IHS_CryptoSymmetricDecryptWithIV(const uint8_t *in, size_t inLen, const uint8_t *iv, size_t ivLen,
                                      const uint8_t *key, size_t keyLen, uint8_t *out, size_t *outLen);
 
+/**
+ * AES-CBC cipher with expanded keys, so they don't need to be computed for every call.
+ * Once created, it can be used from multiple threads.
+ */
+typedef struct IHS_CryptoCipher IHS_CryptoCipher;
+
+IHS_CryptoCipher *IHS_CryptoCipherCreate(const uint8_t *key, size_t keyLen);
+
+void IHS_CryptoCipherDestroy(IHS_CryptoCipher *cipher);
+
+/**
+ * Same as IHS_CryptoSymmetricEncryptWithIV, with key of the cipher
+ */
+int IHS_CryptoCipherEncryptWithIV(const IHS_CryptoCipher *cipher, const uint8_t *in, size_t inLen, const uint8_t *iv,
+                                  size_t ivLen, bool withIV, uint8_t *out, size_t *outLen);
+
+/**
+ * Same as IHS_CryptoSymmetricDecryptWithIV, with key of the cipher
+ */
+int IHS_CryptoCipherDecryptWithIV(const IHS_CryptoCipher *cipher, const uint8_t *in, size_t inLen, const uint8_t *iv,
+                                  size_t ivLen, uint8_t *out, size_t *outLen);
+
+/**
+ * Decrypt into the input memory, as plain text is never longer than cipher text
+ * @param data Cipher text, will be overwritten by plain text
+ * @param len Length of cipher text, will be set to length of plain text
+ */
+int IHS_CryptoCipherDecryptInPlace(const IHS_CryptoCipher *cipher, uint8_t *data, size_t *len, const uint8_t *iv,
+                                   size_t ivLen);
+
+/**
+ * Encrypt into the input memory, without prepending IV
+ * @param data Plain text, will be overwritten by cipher text
+ * @param len Length of plain text, will be set to length of cipher text
+ * @param capacity Size of memory at data, must have room for padding
+ */
+int IHS_CryptoCipherEncryptInPlace(const IHS_CryptoCipher *cipher, uint8_t *data, size_t *len, size_t capacity,
+                                   const uint8_t *iv, size_t ivLen);
+
+typedef enum IHS_CryptoHMACType {
+    IHS_CryptoHMACMD5,
+    IHS_CryptoHMACSHA256,
+} IHS_CryptoHMACType;
+
+/**
+ * HMAC with key already mixed into inner and outer hash states.
+ * Not thread safe, as every computation uses the same working state.
+ */
+typedef struct IHS_CryptoHMAC IHS_CryptoHMAC;
+
+IHS_CryptoHMAC *IHS_CryptoHMACCreate(IHS_CryptoHMACType type, const uint8_t *key, size_t keyLen);
+
+void IHS_CryptoHMACDestroy(IHS_CryptoHMAC *hmac);
+
+size_t IHS_CryptoHMACSize(const IHS_CryptoHMAC *hmac);
+
+/**
+ * @param out Output with at least IHS_CryptoHMACSize bytes
+ */
+int IHS_CryptoHMACCompute(IHS_CryptoHMAC *hmac, const uint8_t *in, size_t inLen, uint8_t *out);
+
 int IHS_CryptoRSAEncrypt(const uint8_t *in, size_t inLen, const uint8_t *key, size_t keyLen, uint8_t *out,
                          size_t *outLen);
 
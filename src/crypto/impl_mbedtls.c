@@ -30,19 +30,42 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#include <mbedtls/aes.h>
+#include <mbedtls/md.h>
 #include <mbedtls/pk.h>
 #include <mbedtls/ctr_drbg.h>
 #include <mbedtls/entropy.h>
 
-#define MIN(a, b) ((a) < (b) ? (a) : (b))
+/* Both MD5 and SHA-256 have 64 bytes block */
+#define HMAC_BLOCK_SIZE 64
+#define HMAC_MAX_SIZE 32
+
+struct IHS_CryptoCipher {
+    mbedtls_aes_context enc;
+    mbedtls_aes_context dec;
+};
+
+struct IHS_CryptoHMAC {
+    const mbedtls_md_info_t *md;
+    /**
+     * Hash states after absorbing the key XOR ipad/opad
+     */
+    mbedtls_md_context_t inner, outer;
+    mbedtls_md_context_t work;
+};
 
 static bool CheckPKCS7Pad(const uint8_t *data, uint8_t pad);
 
-static int CryptoAES_CBC_PKCS7Pad(const uint8_t *in, size_t inLen, const uint8_t iv[16],
-                                  const uint8_t *key, size_t keyLen, uint8_t *out, size_t *outLen, bool enc);
+static int CryptoAES_CBC_PKCS7Pad(mbedtls_aes_context *aes, const uint8_t *in, size_t inLen, const uint8_t iv[16],
+                                  uint8_t *out, size_t *outLen, bool enc);
 
 static int CryptoAES_ECB(const uint8_t *in, const uint8_t *key, size_t keyLen, uint8_t *out, bool enc);
 
+static int CryptoAES_EncryptWithIV(mbedtls_aes_context *aes, const uint8_t *in, size_t inLen, const uint8_t *iv,
+                                   size_t ivLen, bool withIV, uint8_t *out, size_t *outLen);
+
+static int HMACPadState(mbedtls_md_context_t *ctx, const mbedtls_md_info_t *md, const uint8_t *key, uint8_t pad);
+
 
 int IHS_CryptoSymmetricEncrypt(const uint8_t *in, size_t inLen, const uint8_t *key, size_t keyLen, uint8_t *out,
                                size_t *outLen) {
@@ -61,25 +84,13 @@ int IHS_CryptoSymmetricEncrypt(const uint8_t *in, size_t inLen, const uint8_t *k
 
 int IHS_CryptoSymmetricEncryptWithIV(const uint8_t *in, size_t inLen, const uint8_t *iv, size_t ivLen,
                                      const uint8_t *key, size_t keyLen, bool withIV, uint8_t *out, size_t *outLen) {
-
-    size_t offset = 0;
-    int ret;
-    if (withIV) {
-        uint8_t *ivEnc = malloc(ivLen);
-        if ((ret = CryptoAES_ECB(iv, key, keyLen, ivEnc, true)) != 0) {
-            free(ivEnc);
-            return ret;
-        }
-        memcpy(out + offset, ivEnc, ivLen);
-        free(ivEnc);
-        offset += ivLen;
-    }
-    size_t cipherLen = *outLen - offset;
-    if ((ret = CryptoAES_CBC_PKCS7Pad(in, inLen, iv, key, keyLen, out + offset, &cipherLen, true)) != 0) {
-        return ret;
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    int ret = mbedtls_aes_setkey_enc(&aes, key, keyLen * 8);
+    if (ret == 0) {
+        ret = CryptoAES_EncryptWithIV(&aes, in, inLen, iv, ivLen, withIV, out, outLen);
     }
-    offset += cipherLen;
-    *outLen = offset;
+    mbedtls_aes_free(&aes);
     return ret;
 }
 
@@ -93,7 +104,125 @@ int IHS_CryptoSymmetricDecrypt(const uint8_t *in, size_t inLen, const uint8_t *k
 int IHS_CryptoSymmetricDecryptWithIV(const uint8_t *in, size_t inLen, const uint8_t *iv, size_t ivLen,
                                      const uint8_t *key, size_t keyLen, uint8_t *out, size_t *outLen) {
     assert(ivLen == 16);
-    return CryptoAES_CBC_PKCS7Pad(in, inLen, iv, key, keyLen, out, outLen, false);
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    int ret = mbedtls_aes_setkey_dec(&aes, key, keyLen * 8);
+    if (ret == 0) {
+        ret = CryptoAES_CBC_PKCS7Pad(&aes, in, inLen, iv, out, outLen, false);
+    }
+    mbedtls_aes_free(&aes);
+    return ret;
+}
+
+IHS_CryptoCipher *IHS_CryptoCipherCreate(const uint8_t *key, size_t keyLen) {
+    IHS_CryptoCipher *cipher = calloc(1, sizeof(IHS_CryptoCipher));
+    mbedtls_aes_init(&cipher->enc);
+    mbedtls_aes_init(&cipher->dec);
+    if (mbedtls_aes_setkey_enc(&cipher->enc, key, keyLen * 8) != 0 ||
+        mbedtls_aes_setkey_dec(&cipher->dec, key, keyLen * 8) != 0) {
+        IHS_CryptoCipherDestroy(cipher);
+        return NULL;
+    }
+    return cipher;
+}
+
+void IHS_CryptoCipherDestroy(IHS_CryptoCipher *cipher) {
+    mbedtls_aes_free(&cipher->enc);
+    mbedtls_aes_free(&cipher->dec);
+    free(cipher);
+}
+
+int IHS_CryptoCipherEncryptWithIV(const IHS_CryptoCipher *cipher, const uint8_t *in, size_t inLen, const uint8_t *iv,
+                                  size_t ivLen, bool withIV, uint8_t *out, size_t *outLen) {
+    /* Expanded key is only read by AES functions */
+    return CryptoAES_EncryptWithIV((mbedtls_aes_context *) &cipher->enc, in, inLen, iv, ivLen, withIV, out, outLen);
+}
+
+int IHS_CryptoCipherDecryptWithIV(const IHS_CryptoCipher *cipher, const uint8_t *in, size_t inLen, const uint8_t *iv,
+                                  size_t ivLen, uint8_t *out, size_t *outLen) {
+    assert(ivLen == 16);
+    return CryptoAES_CBC_PKCS7Pad((mbedtls_aes_context *) &cipher->dec, in, inLen, iv, out, outLen, false);
+}
+
+int IHS_CryptoCipherDecryptInPlace(const IHS_CryptoCipher *cipher, uint8_t *data, size_t *len, const uint8_t *iv,
+                                   size_t ivLen) {
+    assert(ivLen == 16);
+    /* CBC decryption keeps a copy of each cipher block before overwriting it */
+    return CryptoAES_CBC_PKCS7Pad((mbedtls_aes_context *) &cipher->dec, data, *len, iv, data, len, false);
+}
+
+int IHS_CryptoCipherEncryptInPlace(const IHS_CryptoCipher *cipher, uint8_t *data, size_t *len, size_t capacity,
+                                   const uint8_t *iv, size_t ivLen) {
+    assert(ivLen == 16);
+    /* CBC encryption reads each plain block before writing the same block, and padding goes after plain text */
+    size_t outLen = capacity;
+    int ret = CryptoAES_CBC_PKCS7Pad((mbedtls_aes_context *) &cipher->enc, data, *len, iv, data, &outLen, true);
+    if (ret == 0) {
+        *len = outLen;
+    }
+    return ret;
+}
+
+IHS_CryptoHMAC *IHS_CryptoHMACCreate(IHS_CryptoHMACType type, const uint8_t *key, size_t keyLen) {
+    const mbedtls_md_info_t *md = mbedtls_md_info_from_type(type == IHS_CryptoHMACSHA256 ? MBEDTLS_MD_SHA256
+                                                                                          : MBEDTLS_MD_MD5);
+    if (md == NULL) {
+        return NULL;
+    }
+    IHS_CryptoHMAC *hmac = calloc(1, sizeof(IHS_CryptoHMAC));
+    hmac->md = md;
+    mbedtls_md_init(&hmac->inner);
+    mbedtls_md_init(&hmac->outer);
+    mbedtls_md_init(&hmac->work);
+
+    /* Keys longer than block size are hashed first */
+    uint8_t blockKey[HMAC_BLOCK_SIZE];
+    memset(blockKey, 0, sizeof(blockKey));
+    int ret = 0;
+    if (keyLen > HMAC_BLOCK_SIZE) {
+        ret = mbedtls_md(md, key, keyLen, blockKey);
+    } else {
+        memcpy(blockKey, key, keyLen);
+    }
+    if (ret != 0 || HMACPadState(&hmac->inner, md, blockKey, 0x36) != 0 ||
+        HMACPadState(&hmac->outer, md, blockKey, 0x5c) != 0 || mbedtls_md_setup(&hmac->work, md, 0) != 0) {
+        IHS_CryptoHMACDestroy(hmac);
+        hmac = NULL;
+    }
+    memset(blockKey, 0, sizeof(blockKey));
+    return hmac;
+}
+
+void IHS_CryptoHMACDestroy(IHS_CryptoHMAC *hmac) {
+    mbedtls_md_free(&hmac->inner);
+    mbedtls_md_free(&hmac->outer);
+    mbedtls_md_free(&hmac->work);
+    free(hmac);
+}
+
+size_t IHS_CryptoHMACSize(const IHS_CryptoHMAC *hmac) {
+    return mbedtls_md_get_size(hmac->md);
+}
+
+int IHS_CryptoHMACCompute(IHS_CryptoHMAC *hmac, const uint8_t *in, size_t inLen, uint8_t *out) {
+    uint8_t innerHash[HMAC_MAX_SIZE];
+    int ret;
+    if ((ret = mbedtls_md_clone(&hmac->work, &hmac->inner)) != 0) {
+        return ret;
+    }
+    if ((ret = mbedtls_md_update(&hmac->work, in, inLen)) != 0) {
+        return ret;
+    }
+    if ((ret = mbedtls_md_finish(&hmac->work, innerHash)) != 0) {
+        return ret;
+    }
+    if ((ret = mbedtls_md_clone(&hmac->work, &hmac->outer)) != 0) {
+        return ret;
+    }
+    if ((ret = mbedtls_md_update(&hmac->work, innerHash, mbedtls_md_get_size(hmac->md))) != 0) {
+        return ret;
+    }
+    return mbedtls_md_finish(&hmac->work, out);
 }
 
 
@@ -140,64 +269,48 @@ int IHS_CryptoRSAEncrypt(const uint8_t *in, size_t inLen, const uint8_t *key, si
     return ret;
 }
 
-static int CryptoAES_CBC_PKCS7Pad(const uint8_t *in, size_t inLen, const uint8_t iv[16], const uint8_t *key,
-                                  size_t keyLen, uint8_t *out, size_t *outLen, bool enc) {
-    int ret = 0;
-    mbedtls_aes_context aes;
-    mbedtls_aes_init(&aes);
+static int CryptoAES_CBC_PKCS7Pad(mbedtls_aes_context *aes, const uint8_t *in, size_t inLen, const uint8_t iv[16],
+                                  uint8_t *out, size_t *outLen, bool enc) {
+    int ret;
     uint8_t block[IHS_CRYPTO_AES_BLOCK_SIZE], blockIv[IHS_CRYPTO_AES_BLOCK_SIZE];
     memcpy(blockIv, iv, IHS_CRYPTO_AES_BLOCK_SIZE);
     if (enc) {
-        size_t blockCount = (inLen / IHS_CRYPTO_AES_BLOCK_SIZE + 1), writeLen = blockCount * IHS_CRYPTO_AES_BLOCK_SIZE;
+        size_t fullLen = inLen - inLen % IHS_CRYPTO_AES_BLOCK_SIZE, writeLen = fullLen + IHS_CRYPTO_AES_BLOCK_SIZE;
         if (*outLen < writeLen) {
-            ret = -1;
-            goto cleanup;
+            return -1;
         }
-        mbedtls_aes_setkey_enc(&aes, key, keyLen * 8);
-        for (size_t i = 0; i < writeLen; i += IHS_CRYPTO_AES_BLOCK_SIZE) {
-            size_t inCopyLen = MIN(inLen - i, IHS_CRYPTO_AES_BLOCK_SIZE);
-            if (inCopyLen > 0) {
-                memcpy(block, in + i, inCopyLen);
-            }
-            if (inCopyLen < IHS_CRYPTO_AES_BLOCK_SIZE) {
-                /* Perform PKCS7 padding */
-                memset(&block[inCopyLen], (uint8_t) (IHS_CRYPTO_AES_BLOCK_SIZE - inCopyLen),
-                       IHS_CRYPTO_AES_BLOCK_SIZE - inCopyLen);
-            }
-            ret = mbedtls_aes_crypt_cbc(&aes, MBEDTLS_AES_ENCRYPT, IHS_CRYPTO_AES_BLOCK_SIZE, blockIv, block, &out[i]);
-            if (ret != 0) break;
+        /* Whole blocks are encrypted in one call, only the last block needs to be copied for padding */
+        if (fullLen > 0 && (ret = mbedtls_aes_crypt_cbc(aes, MBEDTLS_AES_ENCRYPT, fullLen, blockIv, in, out)) != 0) {
+            return ret;
         }
-        if (ret == 0) {
-            *outLen = writeLen;
+        size_t remaining = inLen - fullLen;
+        memcpy(block, in + fullLen, remaining);
+        /* Perform PKCS7 padding */
+        memset(&block[remaining], (uint8_t) (IHS_CRYPTO_AES_BLOCK_SIZE - remaining),
+               IHS_CRYPTO_AES_BLOCK_SIZE - remaining);
+        if ((ret = mbedtls_aes_crypt_cbc(aes, MBEDTLS_AES_ENCRYPT, IHS_CRYPTO_AES_BLOCK_SIZE, blockIv, block,
+                                         &out[fullLen])) != 0) {
+            return ret;
         }
+        *outLen = writeLen;
     } else {
-        if (*outLen < inLen || (inLen % IHS_CRYPTO_AES_BLOCK_SIZE) != 0) {
-            ret = -1;
-            goto cleanup;
+        if (inLen == 0 || *outLen < inLen || (inLen % IHS_CRYPTO_AES_BLOCK_SIZE) != 0) {
+            return -1;
         }
-        mbedtls_aes_setkey_dec(&aes, key, keyLen * 8);
-        for (size_t i = 0; i < inLen; i += IHS_CRYPTO_AES_BLOCK_SIZE) {
-            memcpy(block, in + i, IHS_CRYPTO_AES_BLOCK_SIZE);
-            ret = mbedtls_aes_crypt_cbc(&aes, MBEDTLS_AES_DECRYPT, IHS_CRYPTO_AES_BLOCK_SIZE, blockIv, block, &out[i]);
-            if (ret != 0) {
-                goto cleanup;
-            }
+        if ((ret = mbedtls_aes_crypt_cbc(aes, MBEDTLS_AES_DECRYPT, inLen, blockIv, in, out)) != 0) {
+            return ret;
         }
         /* Remove PKCS7 padding */
         uint8_t padLen = out[inLen - 1];
         if (padLen > IHS_CRYPTO_AES_BLOCK_SIZE) {
-            ret = -1;
-            goto cleanup;
+            return -1;
         }
         if (!CheckPKCS7Pad(&out[inLen - padLen], padLen)) {
-            ret = -1;
-            goto cleanup;
+            return -1;
         }
         *outLen = inLen - padLen;
     }
-    cleanup:
-    mbedtls_aes_free(&aes);
-    return ret;
+    return 0;
 }
 
 static int CryptoAES_ECB(const uint8_t *in, const uint8_t *key, size_t keyLen, uint8_t *out, bool enc) {
@@ -214,6 +327,46 @@ static int CryptoAES_ECB(const uint8_t *in, const uint8_t *key, size_t keyLen, u
     return ret;
 }
 
+static int CryptoAES_EncryptWithIV(mbedtls_aes_context *aes, const uint8_t *in, size_t inLen, const uint8_t *iv,
+                                   size_t ivLen, bool withIV, uint8_t *out, size_t *outLen) {
+    assert(ivLen == IHS_CRYPTO_AES_BLOCK_SIZE);
+    size_t offset = 0;
+    int ret;
+    if (withIV) {
+        if (*outLen < ivLen) {
+            return -1;
+        }
+        if ((ret = mbedtls_aes_crypt_ecb(aes, MBEDTLS_AES_ENCRYPT, iv, out)) != 0) {
+            return ret;
+        }
+        offset += ivLen;
+    }
+    size_t cipherLen = *outLen - offset;
+    if ((ret = CryptoAES_CBC_PKCS7Pad(aes, in, inLen, iv, out + offset, &cipherLen, true)) != 0) {
+        return ret;
+    }
+    offset += cipherLen;
+    *outLen = offset;
+    return ret;
+}
+
+static int HMACPadState(mbedtls_md_context_t *ctx, const mbedtls_md_info_t *md, const uint8_t *key, uint8_t pad) {
+    uint8_t padded[HMAC_BLOCK_SIZE];
+    for (int i = 0; i < HMAC_BLOCK_SIZE; i++) {
+        padded[i] = key[i] ^ pad;
+    }
+    int ret;
+    if ((ret = mbedtls_md_setup(ctx, md, 0)) != 0) {
+        return ret;
+    }
+    if ((ret = mbedtls_md_starts(ctx)) != 0) {
+        return ret;
+    }
+    ret = mbedtls_md_update(ctx, padded, HMAC_BLOCK_SIZE);
+    memset(padded, 0, sizeof(padded));
+    return ret;
+}
+
 static bool CheckPKCS7Pad(const uint8_t *data, uint8_t pad) {
     for (int i = 0; i < pad; i++) {
         if (data[i] != pad) {
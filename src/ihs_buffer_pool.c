@@ -0,0 +1,131 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "ihs_buffer_pool.h"
+#include "ihs_buffer.h"
+#include "ihs_thread.h"
+
+#include <stdlib.h>
+#include <assert.h>
+
+struct IHS_BufferPool {
+    size_t bufferSize;
+    size_t capacity;
+    /**
+     * Stack of idle blocks
+     */
+    uint8_t **blocks;
+    size_t numBlocks;
+    /**
+     * Blocks handed out and not recycled yet. Blocks are only allocated on demand, so while this is below capacity,
+     * an empty stack only means the pool is still growing.
+     */
+    size_t inUse;
+    IHS_Mutex *lock;
+    struct {
+        size_t highWaterMark;
+        uint64_t exhausted;
+    } stats;
+};
+
+IHS_BufferPool *IHS_BufferPoolCreate(size_t bufferSize, size_t capacity) {
+    assert(bufferSize > 0);
+    assert(capacity > 0);
+    IHS_BufferPool *pool = calloc(1, sizeof(IHS_BufferPool));
+    pool->bufferSize = bufferSize;
+    pool->capacity = capacity;
+    pool->blocks = calloc(capacity, sizeof(uint8_t *));
+    pool->lock = IHS_MutexCreate();
+    return pool;
+}
+
+void IHS_BufferPoolDestroy(IHS_BufferPool *pool) {
+    for (size_t i = 0; i < pool->numBlocks; i++) {
+        free(pool->blocks[i]);
+    }
+    free(pool->blocks);
+    IHS_MutexDestroy(pool->lock);
+    free(pool);
+}
+
+void IHS_BufferPoolObtain(IHS_BufferPool *pool, IHS_Buffer *buffer) {
+    uint8_t *block = NULL;
+    IHS_MutexLock(pool->lock);
+    if (pool->numBlocks > 0) {
+        block = pool->blocks[--pool->numBlocks];
+    } else if (pool->inUse >= pool->capacity) {
+        pool->stats.exhausted++;
+    }
+    pool->inUse++;
+    if (pool->inUse > pool->stats.highWaterMark) {
+        pool->stats.highWaterMark = pool->inUse;
+    }
+    IHS_MutexUnlock(pool->lock);
+    if (block == NULL) {
+        block = malloc(pool->bufferSize);
+        assert(block != NULL);
+    }
+    IHS_BufferInit(buffer, pool->bufferSize, pool->bufferSize);
+    buffer->data = block;
+    buffer->capacity = pool->bufferSize;
+}
+
+void IHS_BufferPoolRecycle(IHS_BufferPool *pool, IHS_Buffer *buffer) {
+    if (IHS_BufferIsNull(buffer)) {
+        return;
+    }
+    uint8_t *block = buffer->data;
+    bool accepted = false;
+    IHS_MutexLock(pool->lock);
+    if (buffer->capacity == pool->bufferSize) {
+        // Copies made by IHS_BufferTransferOwnership in sanitizer builds stand in for the obtained buffer
+        if (pool->inUse > 0) {
+            pool->inUse--;
+        }
+        if (pool->numBlocks < pool->capacity) {
+            pool->blocks[pool->numBlocks++] = block;
+            accepted = true;
+        }
+    }
+    IHS_MutexUnlock(pool->lock);
+    if (accepted) {
+        IHS_BufferReleaseOwnership(buffer);
+    } else {
+        IHS_BufferClear(buffer, true);
+    }
+}
+
+size_t IHS_BufferPoolGetBufferSize(const IHS_BufferPool *pool) {
+    return pool->bufferSize;
+}
+
+void IHS_BufferPoolGetStats(IHS_BufferPool *pool, IHS_BufferPoolStats *stats) {
+    IHS_MutexLock(pool->lock);
+    stats->capacity = pool->capacity;
+    stats->idle = pool->numBlocks;
+    stats->inUse = pool->inUse;
+    stats->highWaterMark = pool->stats.highWaterMark;
+    stats->exhausted = pool->stats.exhausted;
+    IHS_MutexUnlock(pool->lock);
+}
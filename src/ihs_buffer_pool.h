@@ -0,0 +1,96 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ihslib/buffer.h"
+
+/**
+ * @file ihs_buffer_pool.h
+ * @brief Pool of fixed-size buffers, so hot paths don't need to malloc/free for every packet
+ * @note This pool is thread safe. Obtained buffers must be given back with IHS_BufferPoolRecycle, even when they're
+ *       not going to be kept, so the pool knows how many buffers are in use.
+ */
+
+typedef struct IHS_BufferPool IHS_BufferPool;
+
+typedef struct IHS_BufferPoolStats {
+    /**
+     * Maximum number of buffers kept by the pool
+     */
+    size_t capacity;
+    /**
+     * Number of buffers currently kept by the pool and ready to be obtained
+     */
+    size_t idle;
+    /**
+     * Number of buffers obtained and not recycled yet
+     */
+    size_t inUse;
+    /**
+     * Largest value of inUse seen so far
+     */
+    size_t highWaterMark;
+    /**
+     * Number of times a buffer was obtained while capacity buffers were already in use
+     */
+    uint64_t exhausted;
+} IHS_BufferPoolStats;
+
+/**
+ * Create a buffer pool
+ * @param bufferSize Capacity of every buffer
+ * @param capacity Maximum number of buffers kept by the pool
+ * @return Pool instance
+ */
+IHS_BufferPool *IHS_BufferPoolCreate(size_t bufferSize, size_t capacity);
+
+/**
+ * Free the pool and all idle buffers. Buffers still in use can be recycled with IHS_BufferClear.
+ * @param pool Pool instance
+ */
+void IHS_BufferPoolDestroy(IHS_BufferPool *pool);
+
+/**
+ * Take an empty buffer from the pool. When the pool is exhausted, a new buffer will be allocated.
+ * @param pool Pool instance
+ * @param buffer Buffer to initialize. Its previous content will be overwritten without freeing.
+ */
+void IHS_BufferPoolObtain(IHS_BufferPool *pool, IHS_Buffer *buffer);
+
+/**
+ * Give the memory owned by buffer back to the pool, and leave buffer empty. Buffers not obtained from any pool are
+ * accepted too, if they have the same capacity, and are counted as returned ones.
+ * Buffers are freed instead if the pool already keeps capacity buffers.
+ * @param pool Pool instance
+ * @param buffer Buffer to recycle. Nothing happens if it doesn't own any memory.
+ */
+void IHS_BufferPoolRecycle(IHS_BufferPool *pool, IHS_Buffer *buffer);
+
+size_t IHS_BufferPoolGetBufferSize(const IHS_BufferPool *pool);
+
+void IHS_BufferPoolGetStats(IHS_BufferPool *pool, IHS_BufferPoolStats *stats);
@@ -0,0 +1,125 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "ihs_mpsc_ring.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <assert.h>
+
+/*
+ * Each slot carries a sequence number telling whose turn it is:
+ *   sequence == pos            slot is free for the producer claiming pos
+ *   sequence == pos + 1        slot holds item pos, ready for the consumer
+ *   sequence == pos + capacity slot has been consumed, free for the next lap
+ */
+typedef struct RingSlot {
+    atomic_size_t sequence;
+} RingSlot;
+
+struct IHS_MPSCRing {
+    size_t itemSize;
+    size_t slotSize;
+    size_t mask;
+    uint8_t *slots;
+    atomic_size_t head;
+    /* Only touched by consumer */
+    size_t tail;
+};
+
+static inline RingSlot *SlotAt(IHS_MPSCRing *ring, size_t pos);
+
+IHS_MPSCRing *IHS_MPSCRingCreate(size_t itemSize, size_t capacity) {
+    assert(capacity > 0);
+    size_t roundedCapacity = 1;
+    while (roundedCapacity < capacity) {
+        roundedCapacity <<= 1;
+    }
+    IHS_MPSCRing *ring = calloc(1, sizeof(IHS_MPSCRing));
+    ring->itemSize = itemSize;
+    // Payload follows the sequence number. Round up so every sequence number stays aligned
+    ring->slotSize = (sizeof(RingSlot) + itemSize + sizeof(RingSlot) - 1) / sizeof(RingSlot) * sizeof(RingSlot);
+    ring->mask = roundedCapacity - 1;
+    ring->slots = calloc(roundedCapacity, ring->slotSize);
+    for (size_t i = 0; i < roundedCapacity; i++) {
+        atomic_init(&SlotAt(ring, i)->sequence, i);
+    }
+    atomic_init(&ring->head, 0);
+    ring->tail = 0;
+    return ring;
+}
+
+void IHS_MPSCRingDestroy(IHS_MPSCRing *ring) {
+    free(ring->slots);
+    free(ring);
+}
+
+bool IHS_MPSCRingOffer(IHS_MPSCRing *ring, const void *item) {
+    size_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    RingSlot *slot;
+    while (true) {
+        slot = SlotAt(ring, pos);
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+        if (diff == 0) {
+            // Slot is free, try to claim it. On failure pos is reloaded with current head
+            if (atomic_compare_exchange_weak_explicit(&ring->head, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Consumer hasn't released this slot from previous lap
+            return false;
+        } else {
+            pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+    memcpy((uint8_t *) slot + sizeof(RingSlot), item, ring->itemSize);
+    atomic_store_explicit(&slot->sequence, pos + 1, memory_order_seq_cst);
+    return true;
+}
+
+bool IHS_MPSCRingPoll(IHS_MPSCRing *ring, void *item) {
+    size_t pos = ring->tail;
+    RingSlot *slot = SlotAt(ring, pos);
+    size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if (sequence != pos + 1) {
+        return false;
+    }
+    memcpy(item, (uint8_t *) slot + sizeof(RingSlot), ring->itemSize);
+    ring->tail = pos + 1;
+    atomic_store_explicit(&slot->sequence, pos + ring->mask + 1, memory_order_release);
+    return true;
+}
+
+bool IHS_MPSCRingIsEmpty(IHS_MPSCRing *ring) {
+    size_t pos = ring->tail;
+    return atomic_load_explicit(&SlotAt(ring, pos)->sequence, memory_order_seq_cst) != pos + 1;
+}
+
+static inline RingSlot *SlotAt(IHS_MPSCRing *ring, size_t pos) {
+    return (RingSlot *) (ring->slots + (pos & ring->mask) * ring->slotSize);
+}
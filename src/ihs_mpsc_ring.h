@@ -0,0 +1,72 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/**
+ * @file ihs_mpsc_ring.h
+ * @brief Bounded lock-free ring buffer for multiple producers and a single consumer
+ * @attention Only one thread can call IHS_MPSCRingPoll at a time. Items are copied in and out by value.
+ */
+
+typedef struct IHS_MPSCRing IHS_MPSCRing;
+
+/**
+ * Create a ring
+ * @param itemSize Size of each item
+ * @param capacity Maximum number of items, will be rounded up to power of 2
+ * @return Ring instance
+ */
+IHS_MPSCRing *IHS_MPSCRingCreate(size_t itemSize, size_t capacity);
+
+/**
+ * Free the ring. Remaining items will be discarded without any cleanup, poll them first if needed.
+ * @param ring Ring instance
+ */
+void IHS_MPSCRingDestroy(IHS_MPSCRing *ring);
+
+/**
+ * Copy an item into the ring. Safe to call from any thread.
+ * @param ring Ring instance
+ * @param item Item to copy
+ * @return false if the ring is full
+ */
+bool IHS_MPSCRingOffer(IHS_MPSCRing *ring, const void *item);
+
+/**
+ * Copy the oldest item out of the ring. Must only be called from the consumer thread.
+ * @param ring Ring instance
+ * @param item Destination of the item
+ * @return false if the ring is empty
+ */
+bool IHS_MPSCRingPoll(IHS_MPSCRing *ring, void *item);
+
+/**
+ * Check if the ring has nothing to poll. Must only be called from the consumer thread.
+ * @param ring Ring instance
+ */
+bool IHS_MPSCRingIsEmpty(IHS_MPSCRing *ring);
@@ -52,7 +52,7 @@ IHS_Queue *IHS_QueueCreate(size_t itemSize);
 void IHS_QueueDestroy(IHS_Queue *queue, IHS_QueueConsumerFunction *destroy, void *destroyContext);
 
 /**
- * Append an item allocated to the end of the queue.
+ * Append an item allocated to the end of the queue. This is a constant time operation.
  * @param queue Queue instance
  * @param item
  */
@@ -52,4 +52,15 @@ void IHS_CondDestroy(IHS_Cond *cond);
 
 void IHS_CondSignal(IHS_Cond *cond);
 
+void IHS_CondBroadcast(IHS_Cond *cond);
+
 bool IHS_CondWait(IHS_Cond *cond, IHS_Mutex *mutex);
+
+/**
+ * Wait until the condition is signaled, or the timeout has passed
+ * @param cond Condition variable
+ * @param mutex Locked mutex
+ * @param timeoutMs Timeout in milliseconds
+ * @return true if the condition was signaled, false if timed out or failed
+ */
+bool IHS_CondWaitTimeout(IHS_Cond *cond, IHS_Mutex *mutex, uint32_t timeoutMs);
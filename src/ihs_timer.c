@@ -22,19 +22,24 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  *
  */
-
 #include <stdbool.h>
+#include <stdlib.h>
 #include <time.h>
 #include <assert.h>
-#include <unistd.h>
 
 #include "ihs_timer.h"
 #include "ihs_thread.h"
 #include "ihs_queue.h"
 
 struct IHS_Timer {
-    IHS_Queue *tasks;
-    IHS_Mutex *mutex;
+    /**
+     * Number of tasks started with this timer and not ended yet
+     */
+    size_t numTasks;
+    /**
+     * Set when the timer is being destroyed, no more task can be started or rescheduled
+     */
+    bool destroyed;
 };
 
 struct IHS_TimerTask {
@@ -43,56 +48,124 @@ struct IHS_TimerTask {
     IHS_TimerEndFunction *end;
     void *context;
     uint64_t nextExecution;
+    /**
+     * Tie breaker for tasks with same deadline, so they run in the order they're started
+     */
+    uint64_t sequence;
     int runCount;
+    /**
+     * Position in the heap, or -1 if the task is not in the heap (i.e. it's running or ending)
+     */
+    int heapIndex;
+    bool stopped;
+    /**
+     * Set when the task is rescheduled while running, nextExecution holds the requested deadline
+     */
+    bool rescheduled;
+    /**
+     * Set once the end function returned. Task is freed by the last waiter instead of TaskEnd if anyone is waiting.
+     */
+    bool ended;
+    /**
+     * Number of threads waiting in TaskWaitEnded
+     */
+    int waiters;
 };
 
+/**
+ * All tasks of all timers, ordered by deadline in a binary min-heap. Everything is guarded by state.lock. Run and end
+ * functions are called without holding the lock, so they're free to start or stop tasks.
+ */
 static struct {
     IHS_Queue *timers;
     IHS_Mutex *lock;
+    /**
+     * Wakes up timer thread
+     */
+    IHS_Cond *cond;
+    /**
+     * Signaled every time a task ended
+     */
+    IHS_Cond *endCond;
     IHS_Thread *thread;
-} state = {NULL, NULL, NULL};
+    /**
+     * Incremented every time a new thread is started, so a thread about to quit knows it has been replaced
+     */
+    uintptr_t generation;
+    struct {
+        IHS_TimerTask **items;
+        int size;
+        int capacity;
+    } heap;
+    uint64_t sequence;
+} state = {NULL, NULL, NULL, NULL, NULL, 0, {NULL, 0, 0}, 0};
+
+/**
+ * Task whose run or end function is being called by this thread
+ */
+static _Thread_local IHS_TimerTask *currentTask = NULL;
 
-static void TimerThreadWorker();
+static void TimerThreadWorker(void *context);
 
 static bool ItemIdentical(IHS_QueueItem *item, void *context);
 
-/*
- * Timer functions
- */
+static void TimerDestroy(IHS_Timer *timer, void *context);
 
+static void TaskEnd(IHS_TimerTask *task);
 
-static bool TimerExecute(IHS_Timer *timer, void *context);
+static void TaskWaitEnded(IHS_TimerTask *task);
 
-static void TimerDestroy(IHS_Timer *timer, void *context);
+static inline bool TaskBefore(const IHS_TimerTask *a, const IHS_TimerTask *b);
 
-/*
- * Task functions
- */
+static void HeapPush(IHS_TimerTask *task);
+
+static void HeapRemove(IHS_TimerTask *task);
+
+static IHS_TimerTask *HeapFindByTimer(const IHS_Timer *timer);
 
-static bool TaskExecute(IHS_TimerTask *task, IHS_Timer *timer);
+static void HeapSiftUp(int index);
 
-static void TaskDestroy(IHS_TimerTask *task, IHS_Timer *timer);
+static void HeapSiftDown(int index);
+
+static inline void HeapSet(int index, IHS_TimerTask *task);
 
 void IHS_TimerInit() {
     state.lock = IHS_MutexCreate();
+    state.cond = IHS_CondCreate();
+    state.endCond = IHS_CondCreate();
     state.timers = IHS_QueueCreate(sizeof(IHS_Timer));
 }
 
 void IHS_TimerQuit() {
     IHS_MutexLock(state.lock);
     IHS_QueueDestroy(state.timers, (IHS_QueueConsumerFunction *) TimerDestroy, NULL);
+    state.timers = NULL;
+    IHS_Thread *thread = state.thread;
+    state.thread = NULL;
+    state.generation++;
+    IHS_CondSignal(state.cond);
     IHS_MutexUnlock(state.lock);
+    if (thread != NULL) {
+        IHS_ThreadJoin(thread);
+    }
+    assert(state.heap.size == 0);
+    free(state.heap.items);
+    state.heap.items = NULL;
+    state.heap.capacity = 0;
+    IHS_CondDestroy(state.endCond);
+    IHS_CondDestroy(state.cond);
     IHS_MutexDestroy(state.lock);
 }
 
 IHS_Timer *IHS_TimerCreate() {
     IHS_MutexLock(state.lock);
     IHS_Timer *timer = (IHS_Timer *) IHS_QueueItemObtain(state.timers);
-    timer->tasks = IHS_QueueCreate(sizeof(IHS_TimerTask));
-    timer->mutex = IHS_MutexCreate();
+    timer->numTasks = 0;
+    timer->destroyed = false;
     IHS_QueueAppend(state.timers, (IHS_QueueItem *) timer);
     if (state.thread == NULL) {
-        state.thread = IHS_ThreadCreate(TimerThreadWorker, "IHS.Timer", NULL);
+        state.generation++;
+        state.thread = IHS_ThreadCreate(TimerThreadWorker, "IHS.Timer", (void *) state.generation);
     }
     IHS_MutexUnlock(state.lock);
     return (IHS_Timer *) timer;
@@ -107,11 +180,15 @@ void IHS_TimerDestroy(IHS_Timer *timer) {
     IHS_QueueItemFree((IHS_QueueItem *) matched);
     // All timer are removed
     if (IHS_QueueIsEmpty(state.timers)) {
-        IHS_MutexUnlock(state.lock);
-        IHS_ThreadJoin(state.thread);
-
-        IHS_MutexLock(state.lock);
+        IHS_Thread *thread = state.thread;
         state.thread = NULL;
+        state.generation++;
+        IHS_CondSignal(state.cond);
+        IHS_MutexUnlock(state.lock);
+        if (thread != NULL) {
+            IHS_ThreadJoin(thread);
+        }
+        return;
     }
     IHS_MutexUnlock(state.lock);
 }
@@ -119,42 +196,74 @@ void IHS_TimerDestroy(IHS_Timer *timer) {
 IHS_TimerTask *IHS_TimerTaskStart(IHS_Timer *timer, IHS_TimerRunFunction *run, IHS_TimerEndFunction *end,
                                   uint64_t timeout, void *context) {
     assert(timer != NULL);
-    IHS_MutexLock(timer->mutex);
-    if (timer->tasks == NULL) {
-        IHS_MutexUnlock(timer->mutex);
+    IHS_MutexLock(state.lock);
+    if (timer->destroyed) {
+        IHS_MutexUnlock(state.lock);
         return NULL;
     }
-    IHS_TimerTask *task = (IHS_TimerTask *) IHS_QueueItemObtain(timer->tasks);
+    IHS_TimerTask *task = calloc(1, sizeof(IHS_TimerTask));
     task->timer = timer;
     task->run = run;
     task->end = end;
     task->context = context;
+    task->heapIndex = -1;
     task->nextExecution = IHS_TimerNow() + timeout;
-    IHS_QueueAppend(timer->tasks, (IHS_QueueItem *) task);
-    IHS_MutexUnlock(timer->mutex);
+    task->sequence = state.sequence++;
+    timer->numTasks++;
+    HeapPush(task);
+    // Timer thread only needs to wake up if this task is the new earliest one
+    if (task->heapIndex == 0) {
+        IHS_CondSignal(state.cond);
+    }
+    IHS_MutexUnlock(state.lock);
     return task;
 }
 
 void IHS_TimerTaskStop(IHS_TimerTask *task) {
     assert(task != NULL);
-    IHS_Timer *timer = task->timer;
-    assert(timer != NULL);
-    IHS_MutexLock(timer->mutex);
-    task->nextExecution = 0;
-    IHS_MutexUnlock(timer->mutex);
+    IHS_MutexLock(state.lock);
+    task->stopped = true;
+    if (task->heapIndex >= 0) {
+        // Move it to the top, so timer thread ends it right away
+        task->nextExecution = 0;
+        HeapSiftUp(task->heapIndex);
+        IHS_CondSignal(state.cond);
+    } else {
+        TaskWaitEnded(task);
+    }
+    IHS_MutexUnlock(state.lock);
 }
 
 void IHS_TimerTaskStopImmediate(IHS_TimerTask *task) {
     assert(task != NULL);
-    IHS_Timer *timer = task->timer;
-    assert(timer != NULL);
-    IHS_MutexLock(timer->mutex);
-    IHS_TimerTask *removed = (IHS_TimerTask *) IHS_QueuePollBy(timer->tasks, ItemIdentical, timer);
-    if (removed != NULL) {
-        TaskDestroy(removed, timer);
-        IHS_QueueItemFree((IHS_QueueItem *) removed);
+    IHS_MutexLock(state.lock);
+    task->stopped = true;
+    if (task->heapIndex >= 0) {
+        HeapRemove(task);
+        TaskEnd(task);
+    } else {
+        TaskWaitEnded(task);
+    }
+    IHS_MutexUnlock(state.lock);
+}
+
+void IHS_TimerTaskReschedule(IHS_TimerTask *task, uint64_t timeout) {
+    assert(task != NULL);
+    IHS_MutexLock(state.lock);
+    if (!task->stopped) {
+        task->nextExecution = IHS_TimerNow() + timeout;
+        if (task->heapIndex >= 0) {
+            HeapSiftUp(task->heapIndex);
+            HeapSiftDown(task->heapIndex);
+            if (task->heapIndex == 0) {
+                IHS_CondSignal(state.cond);
+            }
+        } else {
+            // Being run by timer thread, it will be pushed back to the heap once run returns
+            task->rescheduled = true;
+        }
     }
-    IHS_MutexUnlock(timer->mutex);
+    IHS_MutexUnlock(state.lock);
 }
 
 void *IHS_TimerTaskGetContext(IHS_TimerTask *task) {
@@ -173,15 +282,42 @@ uint64_t IHS_TimerNow() {
     return tp.tv_sec * 1000 + tp.tv_nsec / 1000000;
 }
 
-static void TimerThreadWorker() {
-    size_t iterated;
-    do {
-        IHS_MutexLock(state.lock);
-        iterated = IHS_QueuePollEach(state.timers, (IHS_QueuePredicateFunction *) TimerExecute, NULL,
-                                     (IHS_QueueConsumerFunction *) TimerDestroy, NULL);
-        IHS_MutexUnlock(state.lock);
-        usleep(1000);
-    } while (iterated > 0);
+static void TimerThreadWorker(void *context) {
+    uintptr_t generation = (uintptr_t) context;
+    IHS_MutexLock(state.lock);
+    while (state.generation == generation) {
+        if (state.heap.size == 0) {
+            IHS_CondWait(state.cond, state.lock);
+            continue;
+        }
+        IHS_TimerTask *task = state.heap.items[0];
+        uint64_t now = IHS_TimerNow();
+        if (!task->stopped && task->nextExecution > now) {
+            // Sleep until the deadline, or someone added an earlier task
+            IHS_CondWaitTimeout(state.cond, state.lock, (uint32_t) (task->nextExecution - now));
+            continue;
+        }
+        HeapRemove(task);
+        if (!task->stopped) {
+            task->rescheduled = false;
+            IHS_MutexUnlock(state.lock);
+            currentTask = task;
+            uint64_t timeout = task->run(task->runCount, task->context);
+            currentTask = NULL;
+            IHS_MutexLock(state.lock);
+            task->runCount += 1;
+            if ((timeout != 0 || task->rescheduled) && !task->stopped && !task->timer->destroyed) {
+                uint64_t nextExecution = IHS_TimerNow() + timeout;
+                if (!task->rescheduled || (timeout != 0 && nextExecution < task->nextExecution)) {
+                    task->nextExecution = nextExecution;
+                }
+                HeapPush(task);
+                continue;
+            }
+        }
+        TaskEnd(task);
+    }
+    IHS_MutexUnlock(state.lock);
 }
 
 static bool ItemIdentical(IHS_QueueItem *item, void *context) {
@@ -192,51 +328,144 @@ static bool ItemIdentical(IHS_QueueItem *item, void *context) {
  * Timer functions
  */
 
-static bool TimerExecute(IHS_Timer *timer, void *context) {
+static void TimerDestroy(IHS_Timer *timer, void *context) {
     (void) context;
-    if (timer->tasks == NULL) {
-        return true;
+    timer->destroyed = true;
+    IHS_TimerTask *task;
+    // End functions may start or stop other tasks, so look up the heap again after every removal
+    while ((task = HeapFindByTimer(timer)) != NULL) {
+        task->stopped = true;
+        HeapRemove(task);
+        TaskEnd(task);
+    }
+    // Wait for tasks being run or ended by other threads
+    while (timer->numTasks > 0) {
+        IHS_CondWait(state.endCond, state.lock);
     }
-    IHS_MutexLock(timer->mutex);
-    IHS_QueuePollEach(timer->tasks, (IHS_QueuePredicateFunction *) TaskExecute, timer,
-                      (IHS_QueueConsumerFunction *) TaskDestroy, timer);
-    IHS_MutexUnlock(timer->mutex);
-    return false;
 }
 
-static void TimerDestroy(IHS_Timer *timer, void *context) {
-    (void) context;
-    IHS_MutexLock(timer->mutex);
-    IHS_QueueDestroy(timer->tasks, (IHS_QueueConsumerFunction *) TaskDestroy, timer);
-    timer->tasks = NULL;
-    IHS_MutexUnlock(timer->mutex);
-    IHS_MutexDestroy(timer->mutex);
+/*
+ * Task functions
+ */
+
+/**
+ * Call end function and free the task. Must be called with state.lock held, which will be released during the call.
+ */
+static void TaskEnd(IHS_TimerTask *task) {
+    assert(task->heapIndex < 0);
+    if (task->end) {
+        IHS_MutexUnlock(state.lock);
+        IHS_TimerTask *previous = currentTask;
+        currentTask = task;
+        task->end(task->context);
+        currentTask = previous;
+        IHS_MutexLock(state.lock);
+    }
+    task->timer->numTasks--;
+    task->ended = true;
+    if (task->waiters == 0) {
+        free(task);
+    }
+    IHS_CondBroadcast(state.endCond);
+}
+
+/**
+ * Wait until a stopped task being run or ended by another thread is ended, so its context is no longer used after
+ * stop returns. Does nothing when called from the task itself. Must be called with state.lock held.
+ */
+static void TaskWaitEnded(IHS_TimerTask *task) {
+    assert(task->stopped);
+    if (task == currentTask) {
+        return;
+    }
+    task->waiters++;
+    while (!task->ended) {
+        IHS_CondWait(state.endCond, state.lock);
+    }
+    if (--task->waiters == 0) {
+        free(task);
+    }
 }
 
 /*
- * Task functions
+ * Heap functions
  */
 
-static bool TaskExecute(IHS_TimerTask *task, IHS_Timer *timer) {
-    (void) timer;
-    if (task->nextExecution == 0) {
-        return true;
+static inline bool TaskBefore(const IHS_TimerTask *a, const IHS_TimerTask *b) {
+    if (a->nextExecution != b->nextExecution) {
+        return a->nextExecution < b->nextExecution;
     }
-    if (task->nextExecution > IHS_TimerNow()) {
-        return false;
+    return a->sequence < b->sequence;
+}
+
+static void HeapPush(IHS_TimerTask *task) {
+    if (state.heap.size == state.heap.capacity) {
+        int capacity = state.heap.capacity ? state.heap.capacity * 2 : 16;
+        IHS_TimerTask **items = realloc(state.heap.items, capacity * sizeof(IHS_TimerTask *));
+        assert(items != NULL);
+        state.heap.items = items;
+        state.heap.capacity = capacity;
     }
-    uint64_t timeout = task->run(task->runCount, task->context);
-    task->runCount += 1;
-    if (timeout == 0) {
-        return true;
+    HeapSet(state.heap.size++, task);
+    HeapSiftUp(task->heapIndex);
+}
+
+static void HeapRemove(IHS_TimerTask *task) {
+    int index = task->heapIndex;
+    assert(index >= 0 && index < state.heap.size);
+    assert(state.heap.items[index] == task);
+    IHS_TimerTask *last = state.heap.items[--state.heap.size];
+    task->heapIndex = -1;
+    if (last == task) {
+        return;
     }
-    task->nextExecution = IHS_TimerNow() + timeout;
-    return false;
+    HeapSet(index, last);
+    HeapSiftUp(index);
+    HeapSiftDown(last->heapIndex);
 }
 
-static void TaskDestroy(IHS_TimerTask *task, IHS_Timer *timer) {
-    (void) timer;
-    if (task->end) {
-        task->end(task->context);
+static IHS_TimerTask *HeapFindByTimer(const IHS_Timer *timer) {
+    for (int i = 0; i < state.heap.size; i++) {
+        if (state.heap.items[i]->timer == timer) {
+            return state.heap.items[i];
+        }
     }
-}
\ No newline at end of file
+    return NULL;
+}
+
+static void HeapSiftUp(int index) {
+    IHS_TimerTask *task = state.heap.items[index];
+    while (index > 0) {
+        int parent = (index - 1) / 2;
+        if (!TaskBefore(task, state.heap.items[parent])) {
+            break;
+        }
+        HeapSet(index, state.heap.items[parent]);
+        index = parent;
+    }
+    HeapSet(index, task);
+}
+
+static void HeapSiftDown(int index) {
+    IHS_TimerTask *task = state.heap.items[index];
+    while (true) {
+        int child = index * 2 + 1;
+        if (child >= state.heap.size) {
+            break;
+        }
+        if (child + 1 < state.heap.size && TaskBefore(state.heap.items[child + 1], state.heap.items[child])) {
+            child++;
+        }
+        if (!TaskBefore(state.heap.items[child], task)) {
+            break;
+        }
+        HeapSet(index, state.heap.items[child]);
+        index = child;
+    }
+    HeapSet(index, task);
+}
+
+static inline void HeapSet(int index, IHS_TimerTask *task) {
+    state.heap.items[index] = task;
+    task->heapIndex = index;
+}
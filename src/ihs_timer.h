@@ -45,7 +45,8 @@ void IHS_TimerQuit();
 IHS_Timer *IHS_TimerCreate();
 
 /**
- * Destroy tasks instance. If all references are removed, destroy the timer
+ * Destroy tasks instance. If all references are removed, destroy the timer.
+ * All tasks will be ended before return, so this must not be called from a task of the same timer.
  * @param timer
  */
 void IHS_TimerDestroy(IHS_Timer *timer);
@@ -54,17 +55,27 @@ IHS_TimerTask *IHS_TimerTaskStart(IHS_Timer *timer, IHS_TimerRunFunction *run, I
                                   uint64_t timeout, void *context);
 
 /**
- * Ask a timer task to stop. It will be ended and freed in next timer loop.
+ * Ask a timer task to stop. It will be ended and freed in next timer loop. If the task is being run by timer thread,
+ * this waits until it's ended, unless called from the task itself.
  * @param task Timer task to stop
  */
 void IHS_TimerTaskStop(IHS_TimerTask *task);
 
 /**
- * Stop and free the timer task immediately.
+ * Stop and free the timer task immediately. If the task is being run by timer thread, this waits until it's ended,
+ * unless called from the task itself.
  * @param task Timer task to stop
  */
 void IHS_TimerTaskStopImmediate(IHS_TimerTask *task);
 
+/**
+ * Change when the task runs next. If the task is running, the earlier of this and the timeout returned by its run
+ * function will be used, and the task will keep running even if run function returned 0.
+ * @param task Timer task to reschedule
+ * @param timeout Delay from now in milliseconds
+ */
+void IHS_TimerTaskReschedule(IHS_TimerTask *task, uint64_t timeout);
+
 void *IHS_TimerTaskGetContext(IHS_TimerTask *task);
 
 int IHS_TimerTaskGetRunCount(const IHS_TimerTask *task);
@@ -41,6 +41,16 @@ void IHS_UDPSocketClose(IHS_UDPSocket *socket);
 
 int IHS_UDPSocketReceive(IHS_UDPSocket *s, IHS_UDPPacket *packet);
 
+/**
+ * Receive multiple datagrams with as few syscalls as possible. Blocks until at least one datagram arrives,
+ * then returns everything already queued on the socket, up to count.
+ * @param s Socket instance
+ * @param packets Packets to fill. Each buffer will be resized to hold a full datagram.
+ * @param count Number of packets
+ * @return Number of packets received, 0 on timeout, or -1 on error
+ */
+int IHS_UDPSocketReceiveBatch(IHS_UDPSocket *s, IHS_UDPPacket *packets, int count);
+
 /**
  *
  * @param s
@@ -49,6 +59,16 @@ int IHS_UDPSocketReceive(IHS_UDPSocket *s, IHS_UDPPacket *packet);
  */
 bool IHS_UDPSocketSend(IHS_UDPSocket *s, const IHS_UDPPacket *packet);
 
+/**
+ * Send multiple datagrams with as few syscalls as possible. Packets are sent in order, and a packet that fails is
+ * skipped, so it doesn't hold back the ones after it.
+ * @param s Socket instance
+ * @param packets Packets to send
+ * @param count Number of packets
+ * @return Number of packets sent
+ */
+int IHS_UDPSocketSendBatch(IHS_UDPSocket *s, const IHS_UDPPacket *packets, int count);
+
 bool IHS_UDPSocketSetBlocking(IHS_UDPSocket *s, bool blocking);
 
 bool IHS_UDPSocketSetRecvTimeout(IHS_UDPSocket *s, uint32_t timeoutUs);
\ No newline at end of file
@@ -68,8 +68,19 @@ void IHS_CondSignal(IHS_Cond *cond) {
     SDL_CondSignal((SDL_cond *) cond);
 }
 
+void IHS_CondBroadcast(IHS_Cond *cond) {
+    SDL_assert(cond != NULL);
+    SDL_CondBroadcast((SDL_cond *) cond);
+}
+
 bool IHS_CondWait(IHS_Cond *cond, IHS_Mutex *mutex) {
     SDL_assert(cond != NULL);
     SDL_assert(mutex != NULL);
     return SDL_CondWait((SDL_cond *) cond, (SDL_mutex *) mutex) == 0;
 }
+
+bool IHS_CondWaitTimeout(IHS_Cond *cond, IHS_Mutex *mutex, uint32_t timeoutMs) {
+    SDL_assert(cond != NULL);
+    SDL_assert(mutex != NULL);
+    return SDL_CondWaitTimeout((SDL_cond *) cond, (SDL_mutex *) mutex, timeoutMs) == 0;
+}
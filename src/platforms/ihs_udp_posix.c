@@ -22,6 +22,10 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  *
  */
+#if (defined(IHSLIB_HAVE_RECVMMSG) || defined(IHSLIB_HAVE_SENDMMSG)) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "ihs_udp.h"
 #include "ihs_buffer.h"
 #include "ihs_thread.h"
@@ -37,6 +41,10 @@
 
 #include <assert.h>
 
+#define RECV_BUFFER_SIZE 2048
+#define RECV_BATCH_MAX 32
+#define SEND_BATCH_MAX 32
+
 struct IHS_UDPSocket {
     int fd;
     IHS_Mutex *mutex;
@@ -69,7 +77,7 @@ int IHS_UDPSocketReceive(IHS_UDPSocket *s, IHS_UDPPacket *packet) {
     struct sockaddr_storage sender;
     socklen_t senderlen = sizeof(sender);
     ssize_t len;
-    IHS_BufferEnsureMaxSize(&packet->buffer, 2048);
+    IHS_BufferEnsureMaxSize(&packet->buffer, RECV_BUFFER_SIZE);
     if ((len = recvfrom(s->fd, IHS_BufferPointer(&packet->buffer), IHS_BufferMaxSize(&packet->buffer),
                         0, (struct sockaddr *) &sender, &senderlen)) <= 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ETIMEDOUT) {
@@ -82,6 +90,44 @@ int IHS_UDPSocketReceive(IHS_UDPSocket *s, IHS_UDPPacket *packet) {
     return 1;
 }
 
+int IHS_UDPSocketReceiveBatch(IHS_UDPSocket *s, IHS_UDPPacket *packets, int count) {
+    assert(count > 0);
+#ifdef IHSLIB_HAVE_RECVMMSG
+    struct mmsghdr msgs[RECV_BATCH_MAX];
+    struct iovec iovs[RECV_BATCH_MAX];
+    struct sockaddr_storage senders[RECV_BATCH_MAX];
+    if (count > RECV_BATCH_MAX) {
+        count = RECV_BATCH_MAX;
+    }
+    memset(msgs, 0, sizeof(struct mmsghdr) * count);
+    for (int i = 0; i < count; i++) {
+        IHS_Buffer *buffer = &packets[i].buffer;
+        IHS_BufferEnsureMaxSize(buffer, RECV_BUFFER_SIZE);
+        iovs[i].iov_base = IHS_BufferPointer(buffer);
+        iovs[i].iov_len = IHS_BufferMaxSize(buffer);
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &senders[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+    // Block (honoring SO_RCVTIMEO) for the first datagram only, then take whatever is already queued
+    int received = recvmmsg(s->fd, msgs, count, MSG_WAITFORONE, NULL);
+    if (received <= 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ETIMEDOUT) {
+            return 0;
+        }
+        return -1;
+    }
+    for (int i = 0; i < received; i++) {
+        packets[i].buffer.size = msgs[i].msg_len;
+        AddressFromSys(&packets[i].address, &senders[i]);
+    }
+    return received;
+#else
+    return IHS_UDPSocketReceive(s, packets);
+#endif
+}
+
 bool IHS_UDPSocketSend(IHS_UDPSocket *s, const IHS_UDPPacket *packet) {
     struct sockaddr_storage addr;
     size_t addr_len = AddressToSys(&packet->address, &addr);
@@ -92,6 +138,53 @@ bool IHS_UDPSocketSend(IHS_UDPSocket *s, const IHS_UDPPacket *packet) {
     return ret;
 }
 
+int IHS_UDPSocketSendBatch(IHS_UDPSocket *s, const IHS_UDPPacket *packets, int count) {
+    int sent = 0;
+#ifdef IHSLIB_HAVE_SENDMMSG
+    struct mmsghdr msgs[SEND_BATCH_MAX];
+    struct iovec iovs[SEND_BATCH_MAX];
+    struct sockaddr_storage addrs[SEND_BATCH_MAX];
+    int done = 0;
+    IHS_MutexLock(s->mutex);
+    while (done < count) {
+        int chunk = count - done > SEND_BATCH_MAX ? SEND_BATCH_MAX : count - done;
+        memset(msgs, 0, sizeof(struct mmsghdr) * chunk);
+        for (int i = 0; i < chunk; i++) {
+            const IHS_UDPPacket *packet = &packets[done + i];
+            iovs[i].iov_base = IHS_BufferPointer(&packet->buffer);
+            iovs[i].iov_len = packet->buffer.size;
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = AddressToSys(&packet->address, &addrs[i]);
+        }
+        // sendmmsg stops at the first message that fails, skip it and keep going with the rest of the chunk
+        int chunkDone = 0;
+        while (chunkDone < chunk) {
+            int ret = sendmmsg(s->fd, msgs + chunkDone, chunk - chunkDone, 0);
+            if (ret <= 0) {
+                if (ret < 0 && errno == EINTR) {
+                    continue;
+                }
+                chunkDone++;
+                continue;
+            }
+            chunkDone += ret;
+            sent += ret;
+        }
+        done += chunk;
+    }
+    IHS_MutexUnlock(s->mutex);
+#else
+    for (int i = 0; i < count; i++) {
+        if (IHS_UDPSocketSend(s, &packets[i])) {
+            sent++;
+        }
+    }
+#endif
+    return sent;
+}
+
 bool IHS_UDPSocketSetBlocking(IHS_UDPSocket *s, bool blocking) {
     return fcntl(s->fd, F_SETFL, blocking ? 0 : O_NONBLOCK) == 0;
 }
@@ -96,6 +96,11 @@ int IHS_UDPSocketReceive(IHS_UDPSocket *socket, IHS_UDPPacket *packet) {
     return ret;
 }
 
+int IHS_UDPSocketReceiveBatch(IHS_UDPSocket *socket, IHS_UDPPacket *packets, int count) {
+    SDL_assert_always(count > 0);
+    return IHS_UDPSocketReceive(socket, packets);
+}
+
 int IHS_UDPSocketSend(IHS_UDPSocket *socket, IHS_UDPPacket *packet) {
     UDPpacket sdlPacket;
     SDL_memset(&sdlPacket, 0, sizeof(UDPpacket));
@@ -105,6 +110,16 @@ int IHS_UDPSocketSend(IHS_UDPSocket *socket, IHS_UDPPacket *packet) {
     return SDLNet_UDP_Send(socket->socket, -1, &sdlPacket);
 }
 
+int IHS_UDPSocketSendBatch(IHS_UDPSocket *socket, const IHS_UDPPacket *packets, int count) {
+    int sent = 0;
+    for (int i = 0; i < count; i++) {
+        if (IHS_UDPSocketSend(socket, (IHS_UDPPacket *) &packets[i]) > 0) {
+            sent++;
+        }
+    }
+    return sent;
+}
+
 int IHS_UDPSocketUnblock(IHS_UDPSocket *socket) {
     SDL_assert_always(socket != NULL);
     UDPpacket sdlPacket;
@@ -96,24 +96,22 @@ bool IHS_SessionChannelControlSend(IHS_SessionChannel *channel, EStreamControlMe
                    frame.header.packetId);
     IHS_BufferAppendUInt8(&frame.body, type);
     if (IsMessageEncrypted(type)) {
-        size_t cipherSize = EncryptedMessageCapacity(messageCapacity);
-        uint8_t *serialized = calloc(1, messageCapacity);
-        size_t serializedLen = protobuf_c_message_pack(message, serialized);
-        uint8_t *cipher = IHS_BufferPointerForAppend(&frame.body, cipherSize);
-        if (IHS_SessionFrameEncrypt(channel->session, serialized, serializedLen, cipher, &cipherSize,
-                                    control->sendEncryptSequence++) != 0) {
-            free(serialized);
+        size_t cipherCapacity = EncryptedMessageCapacity(messageCapacity);
+        uint8_t *cipher = IHS_BufferPointerForAppend(&frame.body, cipherCapacity);
+        // Pack the message right after HMAC and sequence number, and encrypt it there
+        size_t cipherSize = protobuf_c_message_pack(message, &cipher[IHS_SESSION_FRAME_ENCRYPT_HEADER_SIZE]);
+        if (IHS_SessionFrameEncryptInPlace(channel->session, cipher, &cipherSize, cipherCapacity,
+                                           control->sendEncryptSequence++) != 0) {
             IHS_SessionFrameClear(&frame, true);
             IHS_SessionLog(channel->session, IHS_LogLevelError, "Control", "Failed to encrypt payload\n");
             IHS_SessionDisconnect(channel->session);
             return false;
         }
-        free(serialized);
         frame.body.size += cipherSize;
     } else {
         IHS_BufferAppendMessage(&frame.body, message);
     }
-    ret = IHS_SessionChannelQueueFrame(channel, &frame, true);
+    ret = IHS_SessionChannelQueueFrame(channel, &frame, true, IHS_SessionSendClassInteractive);
     IHS_SessionFrameClear(&frame, true);
     return ret;
 }
@@ -132,7 +130,7 @@ void IHS_SessionChannelControlHandshake(IHS_SessionChannel *channel, bool networ
 static void OnControlInit(IHS_SessionChannel *channel, const void *data) {
     IHS_UNUSED(data);
     IHS_SessionChannelControl *control = (IHS_SessionChannelControl *) channel;
-    control->framePacketWindow = IHS_SessionPacketsWindowCreate(128);
+    control->framePacketWindow = IHS_SessionPacketsWindowCreate(128, channel->session->packetPool);
 }
 
 static void OnControlDeinit(IHS_SessionChannel *channel) {
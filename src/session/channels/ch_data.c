@@ -30,17 +30,39 @@
 #include "session/session_pri.h"
 
 #include "ihs_buffer_ext.h"
+#include "ihs_timer.h"
 
 #define DISCARD_DIFF IHS_SESSION_PACKET_TIMESTAMP_FROM_MILLIS(200)
 
+/* Packets this far behind the newest one are considered lost instead of reordered */
+#define LOSS_REORDER_DISTANCE 3
+#define LOSS_REPORT_MAX_PACKETS 64
+
 static void DataThreadWorker(IHS_SessionChannelData *channel);
 
 static void DataThreadInterrupt(IHS_SessionChannelData *channel);
 
+/**
+ * Wait until the frame at head should be released, and drop frames missed their deadlines.
+ * Must be called with window locked.
+ * @return false if interrupted
+ */
+static bool WaitScheduledFrame(IHS_SessionChannelData *channel);
+
 static void ReceivedFrame(IHS_SessionChannelData *channel, IHS_SessionFrame *frame);
 
+static void ReceivedSegmentedFrame(IHS_SessionChannelData *channel, IHS_SessionSegmentedFrame *frame);
+
 static const char *DataChannelName(IHS_SessionChannelType type);
 
+static void SendDataLost(IHS_SessionChannel *channel, uint32_t *packets, size_t numPackets);
+
+/**
+ * Collect missing packets if a report is due. Must be called with window locked.
+ * @return Number of packets to report
+ */
+static size_t CollectLostPackets(IHS_SessionChannelData *channel, uint32_t *packets);
+
 IHS_SessionChannel *IHS_SessionChannelDataCreate(const IHS_SessionChannelDataClass *cls, IHS_Session *session,
                                                  IHS_SessionChannelType type, IHS_SessionChannelId id,
                                                  const void *config) {
@@ -53,7 +75,7 @@ void IHS_SessionChannelDataInit(IHS_SessionChannel *channel, uint16_t windowCapa
     dataCh->lock = IHS_MutexCreate();
     dataCh->windowLock = IHS_MutexCreate();
     dataCh->windowCond = IHS_CondCreate();
-    dataCh->window = IHS_SessionPacketsWindowCreate(windowCapacity);
+    dataCh->window = IHS_SessionPacketsWindowCreate(windowCapacity, channel->session->packetPool);
     dataCh->interrupted = false;
     char threadName[16];
     snprintf(threadName, 16, "IHS%s", DataChannelName(channel->type));
@@ -78,26 +100,32 @@ void IHS_SessionChannelDataReceived(IHS_SessionChannel *channel, IHS_SessionPack
     assert(dataCh->window != NULL);
     IHS_SessionPacketType type = packet->header.type;
     assert(type == IHS_SessionPacketTypeUnreliable || type == IHS_SessionPacketTypeUnreliableFrag);
+    if (dataCh->playout != NULL) {
+        IHS_SessionPlayoutPacketArrived(dataCh->playout, packet->header.sendTimestamp, IHS_TimerNow());
+    }
+    uint32_t lostPackets[LOSS_REPORT_MAX_PACKETS];
+    size_t numLostPackets = 0;
     IHS_MutexLock(dataCh->windowLock);
     if (!IHS_SessionPacketsWindowAdd(dataCh->window, packet)) {
         IHS_SessionLog(channel->session, IHS_LogLevelWarn, "Data", "%s channel items overflow! Available: %u",
                        DataChannelName(channel->type), IHS_SessionPacketsWindowAvailable(dataCh->window));
         IHS_SessionPacketsWindowDiscard(dataCh->window, 0);
         IHS_SessionChannelDataLost(channel);
+    } else {
+        numLostPackets = CollectLostPackets(dataCh, lostPackets);
     }
     IHS_CondSignal(dataCh->windowCond);
     IHS_MutexUnlock(dataCh->windowLock);
     dataCh->lastPacketTimestamp = packet->header.sendTimestamp;
+    if (numLostPackets > 0) {
+        IHS_SessionLog(channel->session, IHS_LogLevelDebug, "Data", "%s channel reporting %zu lost packets",
+                       DataChannelName(channel->type), numLostPackets);
+        SendDataLost(channel, lostPackets, numLostPackets);
+    }
 }
 
 void IHS_SessionChannelDataLost(IHS_SessionChannel *channel) {
-    CStreamDataLostMsg message = CSTREAM_DATA_LOST_MSG__INIT;
-    IHS_SessionPacket packet;
-    IHS_SessionChannelInitializePacket(channel, &packet, IHS_SessionPacketTypeUnreliable, true, IHS_PACKET_ID_NEXT);
-    IHS_BufferAppendUInt8(&packet.body, k_EStreamDataLost);
-    IHS_BufferAppendMessage(&packet.body, (const ProtobufCMessage *) &message);
-    IHS_SessionChannelQueuePacket(channel, &packet, false);
-    IHS_SessionPacketClear(&packet, true);
+    SendDataLost(channel, NULL, 0);
 }
 
 void IHS_SessionChannelDataStopped(IHS_SessionChannel *channel) {
@@ -117,6 +145,9 @@ static void DataThreadWorker(IHS_SessionChannelData *channel) {
     const IHS_SessionChannelDataClass *cls = (const IHS_SessionChannelDataClass *) channel->base.cls;
     IHS_SessionFrame frame;
     IHS_BufferInit(&frame.body, 1024, 1024 * 1024);
+    IHS_SessionSegmentedFrame segmented;
+    IHS_SessionSegmentedFrameInit(&segmented, NULL);
+    bool useSegments = cls->dataFrameSegments != NULL;
     const char *channelName = DataChannelName(channel->base.type);
     IHS_SessionLog(channel->base.session, IHS_LogLevelInfo, "Data", "Starting %s channel", channelName);
     if (!cls->start((IHS_SessionChannel *) channel)) {
@@ -127,25 +158,40 @@ static void DataThreadWorker(IHS_SessionChannelData *channel) {
     IHS_SessionLog(channel->base.session, IHS_LogLevelInfo, "Data", "%s channel started", channelName);
     while (!channel->interrupted) {
         IHS_MutexLock(channel->windowLock);
-        uint16_t discarded = IHS_SessionPacketsWindowDiscard(channel->window, DISCARD_DIFF);
-        if (discarded > 0) {
-            IHS_SessionLog(channel->base.session, IHS_LogLevelDebug, channelName, "Discarded %u packets", discarded);
-        }
         bool hasFrame;
-        while (!(hasFrame = IHS_SessionPacketsWindowPoll(channel->window, &frame))) {
-            IHS_CondWait(channel->windowCond, channel->windowLock);
-            if (channel->interrupted) {
-                break;
+        if (channel->playout != NULL && IHS_SessionPlayoutEnabled(channel->playout)) {
+            hasFrame = WaitScheduledFrame(channel) &&
+                       (useSegments ? IHS_SessionPacketsWindowPollSegments(channel->window, &segmented)
+                                    : IHS_SessionPacketsWindowPoll(channel->window, &frame));
+        } else {
+            uint16_t discarded = IHS_SessionPacketsWindowDiscard(channel->window, DISCARD_DIFF);
+            if (discarded > 0) {
+                IHS_SessionLog(channel->base.session, IHS_LogLevelDebug, channelName, "Discarded %u packets",
+                               discarded);
+            }
+            while (!(hasFrame = useSegments ? IHS_SessionPacketsWindowPollSegments(channel->window, &segmented)
+                                            : IHS_SessionPacketsWindowPoll(channel->window, &frame))) {
+                IHS_CondWait(channel->windowCond, channel->windowLock);
+                if (channel->interrupted) {
+                    break;
+                }
             }
         }
         IHS_MutexUnlock(channel->windowLock);
-        if (hasFrame) {
+        if (!hasFrame) {
+            continue;
+        }
+        if (useSegments) {
+            ReceivedSegmentedFrame(channel, &segmented);
+            IHS_SessionSegmentedFrameRelease(&segmented);
+        } else {
             ReceivedFrame(channel, &frame);
             IHS_SessionPacketsWindowReleaseFrame(&frame);
         }
     }
     IHS_SessionLog(channel->base.session, IHS_LogLevelInfo, "Data", "Stopping %s channel", channelName);
     IHS_BufferClear(&frame.body, true);
+    IHS_SessionSegmentedFrameClear(&segmented);
     cls->stop((IHS_SessionChannel *) channel);
 }
 
@@ -162,6 +208,38 @@ static void DataThreadInterrupt(IHS_SessionChannelData *channel) {
     IHS_MutexUnlock(channel->windowLock);
 }
 
+static bool WaitScheduledFrame(IHS_SessionChannelData *channel) {
+    while (!channel->interrupted) {
+        uint32_t timestamp;
+        if (!IHS_SessionPacketsWindowHeadTimestamp(channel->window, &timestamp)) {
+            IHS_CondWait(channel->windowCond, channel->windowLock);
+            continue;
+        }
+        bool complete = IHS_SessionPacketsWindowHasFrame(channel->window);
+        uint32_t waitMs = 0;
+        switch (IHS_SessionPlayoutSchedule(channel->playout, timestamp, complete, IHS_TimerNow(), &waitMs)) {
+            case IHS_SessionPlayoutRelease: {
+                return true;
+            }
+            case IHS_SessionPlayoutDrop: {
+                uint16_t discarded = IHS_SessionPacketsWindowDiscardHead(channel->window);
+                IHS_SessionLog(channel->base.session, IHS_LogLevelDebug, DataChannelName(channel->base.type),
+                               "Dropped %s frame (%u packets)", complete ? "late" : "incomplete", discarded);
+                break;
+            }
+            case IHS_SessionPlayoutWait: {
+                if (waitMs > 0) {
+                    IHS_CondWaitTimeout(channel->windowCond, channel->windowLock, waitMs);
+                } else {
+                    IHS_CondWait(channel->windowCond, channel->windowLock);
+                }
+                break;
+            }
+        }
+    }
+    return false;
+}
+
 static void ReceivedFrame(IHS_SessionChannelData *channel, IHS_SessionFrame *frame) {
     assert(frame->header.type == IHS_SessionPacketTypeUnreliable);
     EStreamDataMessage type = *IHS_BufferPointer(&frame->body);
@@ -180,6 +258,60 @@ static void ReceivedFrame(IHS_SessionChannelData *channel, IHS_SessionFrame *fra
     cls->dataFrame((IHS_SessionChannel *) channel, hasHeader ? &header : NULL, &frame->body);
 }
 
+static void ReceivedSegmentedFrame(IHS_SessionChannelData *channel, IHS_SessionSegmentedFrame *frame) {
+    assert(frame->header.type == IHS_SessionPacketTypeUnreliable);
+    /* Message type and data header are small enough to be copied out, even if they span multiple fragments */
+    uint8_t head[1 + IHS_SESSION_DATA_FRAME_HEADER_SIZE];
+    if (IHS_SessionSegmentedFrameCopy(frame, 0, head, 1) < 1) {
+        return;
+    }
+    EStreamDataMessage type = head[0];
+    IHS_SessionSegmentedFrameOffsetBy(frame, 1);
+    if (type != k_EStreamDataPacket) {
+        return;
+    }
+    IHS_SessionDataFrameHeader header;
+    bool hasHeader = false;
+    if (frame->size > IHS_SESSION_DATA_FRAME_HEADER_SIZE) {
+        hasHeader = true;
+        IHS_SessionSegmentedFrameCopy(frame, 0, &head[1], IHS_SESSION_DATA_FRAME_HEADER_SIZE);
+        IHS_Buffer headerBuf = IHS_BUFFER_WRAP(&head[1], IHS_SESSION_DATA_FRAME_HEADER_SIZE);
+        size_t offset = IHS_SessionChannelDataFrameHeaderParse(&header, &headerBuf);
+        IHS_SessionSegmentedFrameOffsetBy(frame, offset);
+    }
+    const IHS_SessionChannelDataClass *cls = (const IHS_SessionChannelDataClass *) channel->base.cls;
+    cls->dataFrameSegments((IHS_SessionChannel *) channel, hasHeader ? &header : NULL, frame);
+}
+
+static void SendDataLost(IHS_SessionChannel *channel, uint32_t *packets, size_t numPackets) {
+    CStreamDataLostMsg message = CSTREAM_DATA_LOST_MSG__INIT;
+    message.n_packets = numPackets;
+    message.packets = packets;
+    IHS_SessionPacket packet;
+    IHS_SessionChannelInitializePacket(channel, &packet, IHS_SessionPacketTypeUnreliable, true, IHS_PACKET_ID_NEXT);
+    IHS_BufferAppendUInt8(&packet.body, k_EStreamDataLost);
+    IHS_BufferAppendMessage(&packet.body, (const ProtobufCMessage *) &message);
+    IHS_SessionChannelQueuePacket(channel, &packet, false, IHS_SessionSendClassInteractive);
+    IHS_SessionPacketClear(&packet, true);
+}
+
+static size_t CollectLostPackets(IHS_SessionChannelData *channel, uint32_t *packets) {
+    if (IHS_SessionPacketsWindowMissingCount(channel->window) == 0) {
+        return 0;
+    }
+    uint64_t now = IHS_TimerNow();
+    /* Give retransmission of previous report a chance to arrive */
+    if (now - channel->lastLossReport < channel->base.session->state.roundTripTime) {
+        return 0;
+    }
+    size_t count = IHS_SessionPacketsWindowCollectMissing(channel->window, LOSS_REORDER_DISTANCE, packets,
+                                                          LOSS_REPORT_MAX_PACKETS);
+    if (count > 0) {
+        channel->lastLossReport = now;
+    }
+    return count;
+}
+
 static const char *DataChannelName(IHS_SessionChannelType type) {
     switch (type) {
         case IHS_SessionChannelTypeDataAudio:
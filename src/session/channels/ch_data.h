@@ -29,6 +29,7 @@
 #include "protobuf/remoteplay.pb-c.h"
 #include "session/frame.h"
 #include "session/window.h"
+#include "session/playout.h"
 #include "ihs_thread.h"
 
 typedef struct IHS_SessionDataFrameHeader {
@@ -43,12 +44,20 @@ typedef struct IHS_SessionChannelData {
     IHS_SessionPacketsWindow *window;
     IHS_Mutex *windowLock;
     IHS_Cond *windowCond;
+    /**
+     * Optional, set before IHS_SessionChannelDataInit to schedule frames with it
+     */
+    IHS_SessionPlayout *playout;
 
     IHS_Thread *worker;
     bool interrupted;
     IHS_Mutex *lock;
 
     uint32_t lastPacketTimestamp;
+    /**
+     * Time of last lost packets report, reports are sent at most once per round trip time
+     */
+    uint64_t lastLossReport;
 } IHS_SessionChannelData;
 
 typedef struct IHS_SessionChannelDataClass {
@@ -58,6 +67,14 @@ typedef struct IHS_SessionChannelDataClass {
 
     void (*dataFrame)(struct IHS_SessionChannel *channel, const IHS_SessionDataFrameHeader *header, IHS_Buffer *body);
 
+    /**
+     * Optional. If set, frames will be delivered as fragment segments instead of one copied buffer, and `dataFrame`
+     * will not be called.
+     * Segments not taken by `IHS_SessionSegmentedFrameMove` will be released after this call.
+     */
+    void (*dataFrameSegments)(struct IHS_SessionChannel *channel, const IHS_SessionDataFrameHeader *header,
+                              IHS_SessionSegmentedFrame *body);
+
     void (*stop)(struct IHS_SessionChannel *channel);
 } IHS_SessionChannelDataClass;
 
@@ -74,6 +91,9 @@ void IHS_SessionChannelDataDeinit(IHS_SessionChannel *channel);
 
 void IHS_SessionChannelDataReceived(IHS_SessionChannel *channel, IHS_SessionPacket *packet);
 
+/**
+ * Report data loss to the host, without telling which packets were lost
+ */
 void IHS_SessionChannelDataLost(IHS_SessionChannel *channel);
 
 void IHS_SessionChannelDataStopped(IHS_SessionChannel *channel);
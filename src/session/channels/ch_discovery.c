@@ -156,7 +156,7 @@ static void OnPingRequest(IHS_SessionChannel *channel, const IHS_SessionPacket *
     IHS_BufferAppendMessage(&outPacket.body, (const ProtobufCMessage *) &response);
 
     IHS_SessionPacketPadTo(&outPacket, request->packet_size_requested);
-    IHS_SessionQueuePacket(channel->session, &outPacket, false);
+    IHS_SessionQueuePacket(channel->session, &outPacket, false, IHS_SessionSendClassInteractive);
     IHS_SessionPacketClear(&outPacket, true);
 }
 
@@ -168,7 +168,7 @@ static uint64_t DisconnectTimerRun(int runCount, void *context) {
     IHS_SessionPacket packet;
     IHS_SessionChannelInitializePacket(channel, &packet, IHS_SessionPacketTypeDisconnect, true, 0);
     packet.header.retransmitCount = runCount;
-    IHS_SessionChannelQueuePacket(channel, &packet, false);
+    IHS_SessionChannelQueuePacket(channel, &packet, false, IHS_SessionSendClassInteractive);
     IHS_SessionPacketClear(&packet, true);
     return 100;
 }
@@ -36,7 +36,7 @@
 #include "session/frame.h"
 
 static bool SessionChannelQueueFramePackets(IHS_SessionChannel *channel, IHS_SessionFrame *frame, size_t bodyLimit,
-                                            bool enableRetransmit);
+                                            bool enableRetransmit, IHS_SessionSendClass sendClass);
 
 static IHS_SessionPacketType FragmentedPacketType(IHS_SessionPacketType type);
 
@@ -171,11 +171,13 @@ bool IHS_SessionChannelInitializeFrame(IHS_SessionChannel *channel, IHS_SessionF
     return true;
 }
 
-bool IHS_SessionChannelQueuePacket(IHS_SessionChannel *channel, IHS_SessionPacket *packet, bool enableRetransmit) {
-    return IHS_SessionQueuePacket(channel->session, packet, enableRetransmit);
+bool IHS_SessionChannelQueuePacket(IHS_SessionChannel *channel, IHS_SessionPacket *packet, bool enableRetransmit,
+                                   IHS_SessionSendClass sendClass) {
+    return IHS_SessionQueuePacket(channel->session, packet, enableRetransmit, sendClass);
 }
 
-bool IHS_SessionChannelQueueFrame(IHS_SessionChannel *channel, IHS_SessionFrame *frame, bool enableRetransmit) {
+bool IHS_SessionChannelQueueFrame(IHS_SessionChannel *channel, IHS_SessionFrame *frame, bool enableRetransmit,
+                                  IHS_SessionSendClass sendClass) {
     size_t mtu = channel->session->state.mtu > 0 ? channel->session->state.mtu : 1024;
     int packetBodySizeLimit = (int) mtu - IHS_PACKET_HEADER_SIZE;
     if (frame->header.hasCrc) {
@@ -189,10 +191,10 @@ bool IHS_SessionChannelQueueFrame(IHS_SessionChannel *channel, IHS_SessionFrame
         IHS_SessionPacket packet;
         packet.header = frame->header;
         IHS_BufferTransferOwnership(&frame->body, &packet.body);
-        ret = IHS_SessionQueuePacket(channel->session, &packet, enableRetransmit);
+        ret = IHS_SessionQueuePacket(channel->session, &packet, enableRetransmit, sendClass);
         IHS_SessionPacketClear(&packet, true);
     } else {
-        ret = SessionChannelQueueFramePackets(channel, frame, packetBodySizeLimit, enableRetransmit);
+        ret = SessionChannelQueueFramePackets(channel, frame, packetBodySizeLimit, enableRetransmit, sendClass);
     }
     return ret;
 }
@@ -202,12 +204,12 @@ void IHS_SessionChannelPacketAck(IHS_SessionChannel *channel, int32_t packetId,
     IHS_SessionPacketType type = ok ? IHS_SessionPacketTypeACK : IHS_SessionPacketTypeNACK;
     IHS_SessionChannelInitializePacket(channel, &packet, type, true, packetId);
     IHS_BufferAppendUInt32LE(&packet.body, IHS_SessionPacketTimestamp());
-    IHS_SessionChannelQueuePacket(channel, &packet, false);
+    IHS_SessionChannelQueuePacket(channel, &packet, false, IHS_SessionSendClassInteractive);
     IHS_SessionPacketClear(&packet, true);
 }
 
 static bool SessionChannelQueueFramePackets(IHS_SessionChannel *channel, IHS_SessionFrame *frame, size_t bodyLimit,
-                                            bool enableRetransmit) {
+                                            bool enableRetransmit, IHS_SessionSendClass sendClass) {
     int fragmentSize = (int) (frame->body.size / bodyLimit + 1);
     assert(fragmentSize <= INT16_MAX);
     int16_t fragmentId = -1;
@@ -223,7 +225,7 @@ static bool SessionChannelQueueFramePackets(IHS_SessionChannel *channel, IHS_Ses
         }
         IHS_SessionPacketBodyInitialize(&packet.body, packet.header.hasCrc);
         IHS_BufferAppendMem(&packet.body, IHS_BufferPointer(&frame->body), packetBodySize);
-        bool ret = IHS_SessionQueuePacket(channel->session, &packet, enableRetransmit);
+        bool ret = IHS_SessionQueuePacket(channel->session, &packet, enableRetransmit, sendClass);
         IHS_SessionPacketClear(&packet, true);
         if (!ret) {
             return false;
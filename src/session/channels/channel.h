@@ -109,8 +109,14 @@ bool IHS_SessionChannelInitializeFrame(IHS_SessionChannel *channel, IHS_SessionF
                                        IHS_SessionPacketType type, bool hasCrc, int32_t packetId);
 
 
-bool IHS_SessionChannelQueuePacket(IHS_SessionChannel *channel, IHS_SessionPacket *packet, bool enableRetransmit);
+bool IHS_SessionChannelQueuePacket(IHS_SessionChannel *channel, IHS_SessionPacket *packet, bool enableRetransmit,
+                                   IHS_SessionSendClass sendClass);
 
-bool IHS_SessionChannelQueueFrame(IHS_SessionChannel *channel, IHS_SessionFrame *frame, bool enableRetransmit);
+/**
+ * Queue the frame, fragmented if needed
+ * @param sendClass Class of all packets of the frame
+ */
+bool IHS_SessionChannelQueueFrame(IHS_SessionChannel *channel, IHS_SessionFrame *frame, bool enableRetransmit,
+                                  IHS_SessionSendClass sendClass);
 
 void IHS_SessionChannelPacketAck(IHS_SessionChannel *channel, int32_t packetId, bool ok);
@@ -0,0 +1,77 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2024 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "session/channels/ch_control.h"
+#include "session/session_pri.h"
+#include "protobuf/pb_utils.h"
+
+static bool InputMotionSend(IHS_Session *session, const IHS_InputMotion *motion);
+
+bool IHS_SessionSendInputMotion(IHS_Session *session, const IHS_InputMotion *motion) {
+    if (IHS_InputCoalescerAdd(session->inputCoalescer, motion)) {
+        return true;
+    }
+    return InputMotionSend(session, motion);
+}
+
+bool IHS_SessionSendInputEvent(IHS_Session *session, EStreamControlMessage type, const ProtobufCMessage *message) {
+    IHS_InputCoalescerFlushAndHold(session->inputCoalescer);
+    bool ret = IHS_SessionSendControlMessage(session, type, message);
+    IHS_InputCoalescerRelease(session->inputCoalescer);
+    return ret;
+}
+
+void IHS_SessionInputMotionFlushed(const IHS_InputMotion *motion, void *context) {
+    InputMotionSend(context, motion);
+}
+
+static bool InputMotionSend(IHS_Session *session, const IHS_InputMotion *motion) {
+    switch (motion->type) {
+        case IHS_InputMotionRelative: {
+            CInputMouseMotionMsg message = CINPUT_MOUSE_MOTION_MSG__INIT;
+            PROTOBUF_C_SET_VALUE(message, dx, motion->dx);
+            PROTOBUF_C_SET_VALUE(message, dy, motion->dy);
+            return IHS_SessionSendControlMessage(session, k_EStreamControlInputMouseMotion,
+                                                 (const ProtobufCMessage *) &message);
+        }
+        case IHS_InputMotionAbsolute: {
+            CInputMouseMotionMsg message = CINPUT_MOUSE_MOTION_MSG__INIT;
+            PROTOBUF_C_SET_VALUE(message, x_normalized, motion->x);
+            PROTOBUF_C_SET_VALUE(message, y_normalized, motion->y);
+            return IHS_SessionSendControlMessage(session, k_EStreamControlInputMouseMotion,
+                                                 (const ProtobufCMessage *) &message);
+        }
+        case IHS_InputMotionTouch: {
+            CInputTouchFingerMotionMsg message = CINPUT_TOUCH_FINGER_MOTION_MSG__INIT;
+            PROTOBUF_C_SET_VALUE(message, fingerid, motion->fingerId);
+            PROTOBUF_C_SET_VALUE(message, x_normalized, motion->x);
+            PROTOBUF_C_SET_VALUE(message, y_normalized, motion->y);
+            return IHS_SessionSendControlMessage(session, k_EStreamControlInputTouchFingerMotion,
+                                                 (const ProtobufCMessage *) &message);
+        }
+        default:
+            return false;
+    }
+}
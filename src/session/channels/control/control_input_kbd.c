@@ -31,14 +31,14 @@ bool IHS_SessionSendKeyDown(IHS_Session *session, uint32_t scancode) {
     CInputKeyDownMsg message = CINPUT_KEY_DOWN_MSG__INIT;
     message.scancode = scancode;
     // TODO: is inputMark needed?
-    return IHS_SessionSendControlMessage(session, k_EStreamControlInputKeyDown,
-                                         (const ProtobufCMessage *) &message);
+    return IHS_SessionSendInputEvent(session, k_EStreamControlInputKeyDown,
+                                     (const ProtobufCMessage *) &message);
 }
 
 bool IHS_SessionSendKeyUp(IHS_Session *session, uint32_t scancode) {
     CInputKeyUpMsg message = CINPUT_KEY_UP_MSG__INIT;
     message.scancode = scancode;
     // TODO: is inputMark needed?
-    return IHS_SessionSendControlMessage(session, k_EStreamControlInputKeyUp,
-                                         (const ProtobufCMessage *) &message);
+    return IHS_SessionSendInputEvent(session, k_EStreamControlInputKeyUp,
+                                     (const ProtobufCMessage *) &message);
 }
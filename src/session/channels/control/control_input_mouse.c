@@ -28,33 +28,27 @@
 #include "protobuf/pb_utils.h"
 
 bool IHS_SessionSendMousePosition(IHS_Session *session, float x, float y) {
-    CInputMouseMotionMsg message = CINPUT_MOUSE_MOTION_MSG__INIT;
-    PROTOBUF_C_SET_VALUE(message, x_normalized, x);
-    PROTOBUF_C_SET_VALUE(message, y_normalized, y);
-    return IHS_SessionSendControlMessage(session, k_EStreamControlInputMouseMotion,
-                                         (const ProtobufCMessage *) &message);
+    IHS_InputMotion motion = {.type = IHS_InputMotionAbsolute, .x = x, .y = y};
+    return IHS_SessionSendInputMotion(session, &motion);
 }
 
 bool IHS_SessionSendMouseMovement(IHS_Session *session, int dx, int dy) {
-    CInputMouseMotionMsg message = CINPUT_MOUSE_MOTION_MSG__INIT;
-    PROTOBUF_C_SET_VALUE(message, dx, dx);
-    PROTOBUF_C_SET_VALUE(message, dy, dy);
-    return IHS_SessionSendControlMessage(session, k_EStreamControlInputMouseMotion,
-                                         (const ProtobufCMessage *) &message);
+    IHS_InputMotion motion = {.type = IHS_InputMotionRelative, .dx = dx, .dy = dy};
+    return IHS_SessionSendInputMotion(session, &motion);
 }
 
 bool IHS_SessionSendMouseDown(IHS_Session *session, IHS_StreamInputMouseButton button) {
     CInputMouseDownMsg message = CINPUT_MOUSE_DOWN_MSG__INIT;
     message.button = (EStreamMouseButton) button;
-    return IHS_SessionSendControlMessage(session, k_EStreamControlInputMouseDown,
-                                         (const ProtobufCMessage *) &message);
+    return IHS_SessionSendInputEvent(session, k_EStreamControlInputMouseDown,
+                                     (const ProtobufCMessage *) &message);
 }
 
 bool IHS_SessionSendMouseUp(IHS_Session *session, IHS_StreamInputMouseButton button) {
     CInputMouseUpMsg message = CINPUT_MOUSE_UP_MSG__INIT;
     message.button = (EStreamMouseButton) button;
-    return IHS_SessionSendControlMessage(session, k_EStreamControlInputMouseUp,
-                                         (const ProtobufCMessage *) &message);
+    return IHS_SessionSendInputEvent(session, k_EStreamControlInputMouseUp,
+                                     (const ProtobufCMessage *) &message);
 }
 
 bool IHS_SessionSendMouseWheel(IHS_Session *session, IHS_StreamInputMouseWheelDirection direction) {
@@ -75,6 +69,6 @@ bool IHS_SessionSendMouseWheel(IHS_Session *session, IHS_StreamInputMouseWheelDi
         default:
             return false;
     }
-    return IHS_SessionSendControlMessage(session, k_EStreamControlInputMouseWheel,
-                                         (const ProtobufCMessage *) &message);
+    return IHS_SessionSendInputEvent(session, k_EStreamControlInputMouseWheel,
+                                     (const ProtobufCMessage *) &message);
 }
\ No newline at end of file
@@ -32,8 +32,8 @@ bool IHS_SessionSendTouchDown(IHS_Session *session, uint64_t fingerId, float x,
     PROTOBUF_C_SET_VALUE(message, fingerid, fingerId);
     PROTOBUF_C_SET_VALUE(message, x_normalized, x);
     PROTOBUF_C_SET_VALUE(message, y_normalized, y);
-    return IHS_SessionSendControlMessage(session, k_EStreamControlInputTouchFingerDown,
-                                         (const ProtobufCMessage *) &message);
+    return IHS_SessionSendInputEvent(session, k_EStreamControlInputTouchFingerDown,
+                                     (const ProtobufCMessage *) &message);
 }
 
 bool IHS_SessionSendTouchUp(IHS_Session *session, uint64_t fingerId, float x, float y) {
@@ -41,15 +41,11 @@ bool IHS_SessionSendTouchUp(IHS_Session *session, uint64_t fingerId, float x, fl
     PROTOBUF_C_SET_VALUE(message, fingerid, fingerId);
     PROTOBUF_C_SET_VALUE(message, x_normalized, x);
     PROTOBUF_C_SET_VALUE(message, y_normalized, y);
-    return IHS_SessionSendControlMessage(session, k_EStreamControlInputTouchFingerUp,
-                                         (const ProtobufCMessage *) &message);
+    return IHS_SessionSendInputEvent(session, k_EStreamControlInputTouchFingerUp,
+                                     (const ProtobufCMessage *) &message);
 }
 
 bool IHS_SessionSendTouchMotion(IHS_Session *session, uint64_t fingerId, float x, float y) {
-    CInputTouchFingerMotionMsg message = CINPUT_TOUCH_FINGER_MOTION_MSG__INIT;
-    PROTOBUF_C_SET_VALUE(message, fingerid, fingerId);
-    PROTOBUF_C_SET_VALUE(message, x_normalized, x);
-    PROTOBUF_C_SET_VALUE(message, y_normalized, y);
-    return IHS_SessionSendControlMessage(session, k_EStreamControlInputTouchFingerMotion,
-                                         (const ProtobufCMessage *) &message);
+    IHS_InputMotion motion = {.type = IHS_InputMotionTouch, .x = x, .y = y, .fingerId = fingerId};
+    return IHS_SessionSendInputMotion(session, &motion);
 }
\ No newline at end of file
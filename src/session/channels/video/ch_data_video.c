@@ -28,6 +28,8 @@
 #include "session/channels/ch_data.h"
 #include "ch_data_video.h"
 #include "partial_frames.h"
+#include "frame_pool.h"
+#include "param_sets.h"
 
 #include "ihs_timer.h"
 
@@ -40,6 +42,10 @@
 #include "frame_h264.h"
 #include "frame_hevc.h"
 
+#define VIDEO_FRAME_HEADER_SIZE 7
+/* Decoders usually hold very few frames at once */
+#define VIDEO_FRAME_POOL_CAPACITY 4
+
 typedef struct IHS_SessionChannelVideo {
     IHS_SessionChannelData base;
     IHS_StreamVideoConfig config;
@@ -52,11 +58,37 @@ typedef struct IHS_SessionChannelVideo {
         bool frameFinished;
     } states;
     struct {
+        /**
+         * ID of the first data frame in this video frame
+         */
+        uint16_t id;
         uint16_t reserved1;
         IHS_VideoPartialFrames partial;
         IHS_Buffer buffer;
+        IHS_VideoNALIndex nals;
         IHS_StreamVideoFrameFlag flags;
     } frame;
+    /**
+     * States of the frame being submitted in slices
+     */
+    struct {
+        uint32_t begin;
+        size_t size;
+        IHS_StreamVideoSubmitResult result;
+    } slice;
+    IHS_VideoFramePool *framePool;
+    /**
+     * Only accessed from the thread submitting frames
+     */
+    IHS_VideoParamSets paramSets;
+    /**
+     * Frames are submitted from the session video queue
+     */
+    bool queued;
+    /**
+     * Frames are submitted in slices
+     */
+    bool sliced;
     IHS_TimerTask *statsTimer;
     IHS_Mutex *stateMutex;
 } IHS_SessionChannelVideo;
@@ -68,7 +100,8 @@ static void ChannelVideoDeinit(IHS_SessionChannel *channel);
 
 static bool DataStart(IHS_SessionChannel *channel);
 
-static void DataReceived(IHS_SessionChannel *channel, const IHS_SessionDataFrameHeader *header, IHS_Buffer *body);
+static void DataReceived(IHS_SessionChannel *channel, const IHS_SessionDataFrameHeader *header,
+                         IHS_SessionSegmentedFrame *body);
 
 static void DataStop(IHS_SessionChannel *channel);
 
@@ -81,21 +114,43 @@ static size_t VideoFrameHeaderParse(IHS_VideoFrameHeader *header, const uint8_t
  */
 static bool AssembleFrame(IHS_SessionChannel *channel);
 
-static void AppendToFrameBuffer(IHS_SessionChannelVideo *channel, const IHS_Buffer *data,
+static void AppendToFrameBuffer(IHS_SessionChannelVideo *channel, const IHS_SessionSegmentedFrame *data,
                                 const IHS_VideoFrameHeader *header);
 
-static void SubmitFrame(IHS_SessionChannel *channel, IHS_Buffer *data, IHS_StreamVideoFrameFlag flags);
+static void SubmitFrame(IHS_SessionChannel *channel, uint16_t frameId, IHS_Buffer *data,
+                        IHS_StreamVideoFrameFlag flags);
+
+/**
+ * Submit frame data appended so far to decoder, and clear the frame buffer
+ * @param endOfFrame Whether this is the last slice of the frame
+ */
+static void SubmitSlice(IHS_SessionChannel *channel, bool endOfFrame);
+
+/**
+ * Hand the frame to decoder, and release it if decoder doesn't take it
+ */
+static void DeliverFrame(IHS_StreamVideoFrame *frame, void *context);
+
+/**
+ * Record decoding outcome of the frame, and request keyframe or disconnect on error
+ */
+static void HandleSubmitResult(IHS_SessionChannel *channel, uint16_t frameId, IHS_StreamVideoSubmitResult result);
+
+/**
+ * Notify decoder if parameter sets in the keyframe have changed
+ */
+static void UpdateParamSets(IHS_SessionChannel *channel, const IHS_Buffer *data, IHS_StreamVideoFrameFlag flags);
 
 static uint64_t ReportVideoStats(int runCount, void *data);
 
 /**
  * Append one data frame into partial video frames list
  * @param channel Channel instance
- * @param data Data frame body
+ * @param data Data frame body. Segments will be moved to the partial frame
  * @param header Data frame header
  */
 static void AddPartialFrame(IHS_SessionChannelVideo *channel, uint16_t frameId, const IHS_VideoFrameHeader *header,
-                            IHS_Buffer *data);
+                            IHS_SessionSegmentedFrame *data);
 
 /**
  * Clear partial video frames and not yet assembled frame data
@@ -112,7 +167,7 @@ static const IHS_SessionChannelDataClass ChannelClass = {
                 .instanceSize = sizeof(IHS_SessionChannelVideo)
         },
         .start = DataStart,
-        .dataFrame = DataReceived,
+        .dataFrameSegments = DataReceived,
         .stop = DataStop,
 };
 
@@ -140,6 +195,16 @@ static void ChannelVideoInit(IHS_SessionChannel *channel, const void *config) {
     videoCh->stateMutex = IHS_MutexCreate();
     IHS_BufferInit(&videoCh->frame.buffer, 128 * 1024/*128KB*/, 2048 * 1024/*2MB*/);
     IHS_VideoPartialFramesInit(&videoCh->frame.partial);
+    IHS_VideoNALIndexInit(&videoCh->frame.nals);
+    videoCh->framePool = IHS_VideoFramePoolCreate(VIDEO_FRAME_POOL_CAPACITY);
+    IHS_VideoParamSetsInit(&videoCh->paramSets, videoCh->config.codec);
+    if (videoCh->config.codecData != NULL) {
+        /* Decoder gets these in start callback */
+        IHS_VideoParamSetsUpdate(&videoCh->paramSets, videoCh->config.codecData, videoCh->config.codecDataLen);
+    }
+    videoCh->base.playout = channel->session->videoPlayout;
+    IHS_SessionPlayoutReset(videoCh->base.playout);
+    IHS_VideoFrameStatsReset(channel->session->videoFrameStats);
     IHS_SessionChannelDataInit(channel, 2048);
 }
 
@@ -151,7 +216,10 @@ static void ChannelVideoDeinit(IHS_SessionChannel *channel) {
         free(videoCh->config.codecData);
     }
     IHS_BufferClear(&videoCh->frame.buffer, true);
-    IHS_VideoPartialFramesClear(&videoCh->frame.partial);
+    IHS_VideoPartialFramesDeinit(&videoCh->frame.partial);
+    IHS_VideoNALIndexDeinit(&videoCh->frame.nals);
+    IHS_VideoFramePoolDestroy(videoCh->framePool);
+    IHS_VideoParamSetsDeinit(&videoCh->paramSets);
 }
 
 static bool DataStart(IHS_SessionChannel *channel) {
@@ -168,14 +236,26 @@ static bool DataStart(IHS_SessionChannel *channel) {
 
     videoCh->statsTimer = IHS_TimerTaskStart(session->timers, ReportVideoStats, NULL, 1000, videoCh);
 
-    return IHS_SessionSendControlMessage(session, k_EStreamControlVideoDecoderInfo,
-                                         (const ProtobufCMessage *) &message);
+    if (!IHS_SessionSendControlMessage(session, k_EStreamControlVideoDecoderInfo,
+                                       (const ProtobufCMessage *) &message)) {
+        return false;
+    }
+    videoCh->sliced = callbacks->submitSlice != NULL;
+    if (!videoCh->sliced) {
+        videoCh->queued = IHS_SessionVideoQueueStart(session->videoQueue, DeliverFrame, channel);
+    }
+    return true;
 }
 
-static void DataReceived(IHS_SessionChannel *channel, const IHS_SessionDataFrameHeader *header, IHS_Buffer *body) {
+static void DataReceived(IHS_SessionChannel *channel, const IHS_SessionDataFrameHeader *header,
+                         IHS_SessionSegmentedFrame *body) {
     IHS_SessionChannelVideo *videoCh = (IHS_SessionChannelVideo *) channel;
+    uint8_t vheadData[VIDEO_FRAME_HEADER_SIZE];
+    if (IHS_SessionSegmentedFrameCopy(body, 0, vheadData, VIDEO_FRAME_HEADER_SIZE) < VIDEO_FRAME_HEADER_SIZE) {
+        return;
+    }
     IHS_VideoFrameHeader vhead;
-    IHS_BufferOffsetBy(body, (int) VideoFrameHeaderParse(&vhead, IHS_BufferPointer(body)));
+    IHS_SessionSegmentedFrameOffsetBy(body, VideoFrameHeaderParse(&vhead, vheadData));
 
     IHS_MutexLock(videoCh->stateMutex);
 
@@ -208,24 +288,33 @@ static void DataReceived(IHS_SessionChannel *channel, const IHS_SessionDataFrame
         goto unlock;
     }
     if (vhead.flags & VideoFrameFlagEncrypted) {
-        const IHS_SessionInfo *config = &channel->session->info;
-        IHS_Buffer plain;
-        IHS_BufferInit(&plain, 0, 0);
-        IHS_BufferEnsureMaxSizeExact(&plain, body->size);
-        size_t outLen = body->size;
-        IHS_CryptoSymmetricDecryptWithIV(IHS_BufferPointer(body), body->size, EmptyIV, sizeof(EmptyIV),
-                                         config->sessionKey, config->sessionKeyLen, IHS_BufferPointer(&plain),
-                                         &outLen);
-        plain.size = outLen;
-        AddPartialFrame(videoCh, header->id, &vhead, &plain);
-        IHS_BufferClear(&plain, true);
+        /* Decryption needs contiguous input, so only frames with multiple segments will be gathered */
+        IHS_CryptoCipher *cipher = channel->session->crypto.cipher;
+        IHS_Buffer *segment = IHS_SessionSegmentedFrameFlatten(body);
+        size_t plainLen = 0;
+        if (segment != NULL && cipher != NULL) {
+            plainLen = segment->size;
+            if (IHS_CryptoCipherDecryptInPlace(cipher, IHS_BufferPointer(segment), &plainLen, EmptyIV,
+                                               sizeof(EmptyIV)) != 0) {
+                plainLen = 0;
+            }
+            segment->size = plainLen;
+        }
+        body->size = plainLen;
+        AddPartialFrame(videoCh, header->id, &vhead, body);
     } else {
         AddPartialFrame(videoCh, header->id, &vhead, body);
     }
 
     if (AssembleFrame(channel)) {
-        SubmitFrame(channel, &videoCh->frame.buffer, videoCh->frame.flags);
+        if (videoCh->sliced) {
+            SubmitSlice(channel, true);
+        } else {
+            IHS_VideoNALIndexFinish(&videoCh->frame.nals, videoCh->frame.buffer.size);
+            SubmitFrame(channel, videoCh->frame.id, &videoCh->frame.buffer, videoCh->frame.flags);
+        }
         IHS_BufferClear(&videoCh->frame.buffer, false);
+        IHS_VideoNALIndexClear(&videoCh->frame.nals);
         videoCh->frame.flags = 0;
         videoCh->states.frameFinished = false;
         videoCh->states.frameStarted = false;
@@ -242,6 +331,10 @@ static void DataStop(IHS_SessionChannel *channel) {
         IHS_TimerTaskStop(videoCh->statsTimer);
         videoCh->statsTimer = NULL;
     }
+    if (videoCh->queued) {
+        IHS_SessionVideoQueueStop(session->videoQueue);
+        videoCh->queued = false;
+    }
     const IHS_StreamVideoCallbacks *callbacks = session->callbacks.video;
     if (!callbacks || !callbacks->stop) return;
     callbacks->stop(session, session->callbackContexts.video);
@@ -259,9 +352,8 @@ static size_t VideoFrameHeaderParse(IHS_VideoFrameHeader *header, const uint8_t
 static bool AssembleFrame(IHS_SessionChannel *channel) {
     IHS_SessionChannelVideo *videoCh = (IHS_SessionChannelVideo *) channel;
 
-    IHS_VideoPartialFrame *partial = videoCh->frame.partial.head;
-    while (partial != NULL && !videoCh->states.frameFinished) {
-        IHS_VideoPartialFrame *next = partial->next;
+    IHS_VideoPartialFrame *partial;
+    while (!videoCh->states.frameFinished && (partial = IHS_VideoPartialFramesAt(&videoCh->frame.partial, 0)) != NULL) {
         if (partial->header.reserved2 != 0) {
             if (partial->header.reserved1 != videoCh->frame.reserved1) {
                 break;
@@ -274,73 +366,187 @@ static bool AssembleFrame(IHS_SessionChannel *channel) {
                 }
             }
         }
+        if (!videoCh->states.frameStarted) {
+            videoCh->frame.id = partial->frameId;
+            videoCh->states.frameStarted = true;
+        }
         // append buffer
         AppendToFrameBuffer(videoCh, &partial->data, &partial->header);
         if (partial->header.flags & VideoFrameFlagFrameFinish) {
             videoCh->states.frameFinished = true;
+        } else if (videoCh->sliced) {
+            /* Last slice is submitted with end of frame marker */
+            SubmitSlice(channel, false);
         }
-        IHS_BufferClear(&partial->data, true);
-        IHS_VideoPartialFramesRemove(&videoCh->frame.partial, partial);
-        partial = next;
+        IHS_VideoPartialFramesRemoveHead(&videoCh->frame.partial);
     }
     return videoCh->states.frameFinished;
 }
 
 static void AddPartialFrame(IHS_SessionChannelVideo *channel, uint16_t frameId, const IHS_VideoFrameHeader *header,
-                            IHS_Buffer *data) {
-    // Find reset matching cur frame
-    IHS_VideoPartialFrame *cur = NULL;
-    IHS_VideoPartialFramesForEach (cur, &channel->frame.partial) {
-        if (frameId == cur->frameId && header->reserved2 < cur->header.reserved1) {
-            break;
-        }
-    }
-    if (cur != NULL) {
-        IHS_VideoPartialFramesInsertBefore(&channel->frame.partial, cur, frameId, header, data);
-    } else {
-        IHS_VideoPartialFramesAppend(&channel->frame.partial, frameId, header, data);
-    }
+                            IHS_SessionSegmentedFrame *data) {
+    IHS_VideoPartialFramesAdd(&channel->frame.partial, frameId, header, data);
 }
 
 static void DiscardPending(IHS_SessionChannelVideo *channel) {
     IHS_BufferClear(&channel->frame.buffer, 0);
+    IHS_VideoNALIndexClear(&channel->frame.nals);
     size_t clearedCount = IHS_VideoPartialFramesClear(&channel->frame.partial);
     if (clearedCount > 0) {
         IHS_SessionLog(((IHS_SessionChannel *) channel)->session, IHS_LogLevelWarn, "Video",
                        "%u partial frames was cleared", clearedCount);
     }
+    /* Decoder may have failed on slices of the frame that won't end */
+    IHS_StreamVideoSubmitResult sliceResult = channel->slice.result;
+    uint16_t frameId = channel->frame.id;
     channel->frame.flags = 0;
     channel->frame.reserved1 = 0;
+    channel->states.frameStarted = false;
+    channel->slice.size = 0;
+    channel->slice.result = IHS_StreamVideoSubmitOK;
+    if (sliceResult != IHS_StreamVideoSubmitOK) {
+        HandleSubmitResult((IHS_SessionChannel *) channel, frameId, sliceResult);
+    }
 }
 
-static void AppendToFrameBuffer(IHS_SessionChannelVideo *channel, const IHS_Buffer *data,
+static void AppendToFrameBuffer(IHS_SessionChannelVideo *channel, const IHS_SessionSegmentedFrame *data,
                                 const IHS_VideoFrameHeader *header) {
-    switch (channel->config.codec) {
-        case IHS_StreamVideoCodecH264:
-            IHS_SessionVideoFrameAppendH264(&channel->frame.buffer, IHS_BufferPointer(data), data->size, header);
-            break;
-        case IHS_StreamVideoCodecHEVC:
-            IHS_SessionVideoFrameAppendHEVC(&channel->frame.buffer, IHS_BufferPointer(data), data->size, header);
-            break;
-        default: {
-            IHS_SessionLog(((IHS_SessionChannel *) channel)->session, IHS_LogLevelFatal, "Video",
-                           "Unsupported codec %u", channel->config.codec);
-            abort();
+    size_t offset = 0;
+    for (size_t i = 0; i < data->count; i++) {
+        const IHS_Buffer *segment = &data->segments[i];
+        if (segment->size == 0) {
+            continue;
         }
+        switch (channel->config.codec) {
+            case IHS_StreamVideoCodecH264:
+                IHS_SessionVideoFrameAppendH264(&channel->frame.buffer, &channel->frame.nals,
+                                                IHS_BufferPointer(segment), segment->size, offset, header);
+                break;
+            case IHS_StreamVideoCodecHEVC:
+                IHS_SessionVideoFrameAppendHEVC(&channel->frame.buffer, &channel->frame.nals,
+                                                IHS_BufferPointer(segment), segment->size, offset, header);
+                break;
+            default: {
+                IHS_SessionLog(((IHS_SessionChannel *) channel)->session, IHS_LogLevelFatal, "Video",
+                               "Unsupported codec %u", channel->config.codec);
+                abort();
+            }
+        }
+        offset += segment->size;
     }
     if (header->flags & VideoFrameFlagKeyFrame) {
         channel->frame.flags |= IHS_StreamVideoFrameKeyFrame;
     }
 }
 
-static void SubmitFrame(IHS_SessionChannel *channel, IHS_Buffer *data, IHS_StreamVideoFrameFlag flags) {
+static void SubmitFrame(IHS_SessionChannel *channel, uint16_t frameId, IHS_Buffer *data,
+                        IHS_StreamVideoFrameFlag flags) {
+    IHS_Session *session = channel->session;
+    const IHS_StreamVideoCallbacks *callbacks = session->callbacks.video;
+    if (callbacks == NULL || (callbacks->submit == NULL && callbacks->submitFrame == NULL)) {
+        return;
+    }
+    IHS_SessionChannelVideo *videoCh = (IHS_SessionChannelVideo *) channel;
+    IHS_VideoFrameStatsReceived(session->videoFrameStats, frameId, data->size, IHS_SessionPacketTimestamp());
+    if (videoCh->queued || callbacks->submitFrame != NULL) {
+        /* Data goes to the frame without copying, and the buffer gets storage of a recycled frame */
+        IHS_StreamVideoFrame *frame = IHS_VideoFramePoolWrap(videoCh->framePool, data, &videoCh->frame.nals, frameId,
+                                                             flags);
+        if (!videoCh->queued) {
+            DeliverFrame(frame, channel);
+        } else if (IHS_SessionVideoQueuePush(session->videoQueue, frame) == IHS_SessionVideoQueueRequestKeyFrame) {
+            IHS_SessionLog(session, IHS_LogLevelInfo, "Video", "Decoder queue is full, skip to next keyframe.");
+            IHS_SessionChannelDataLost(channel);
+        }
+        return;
+    }
+    UpdateParamSets(channel, data, flags);
+    IHS_VideoFrameStatsEvent(session->videoFrameStats, frameId, k_EStreamFrameEventDecodeBegin,
+                             IHS_SessionPacketTimestamp());
+    HandleSubmitResult(channel, frameId, callbacks->submit(session, data, flags, session->callbackContexts.video));
+}
+
+static void SubmitSlice(IHS_SessionChannel *channel, bool endOfFrame) {
+    IHS_SessionChannelVideo *videoCh = (IHS_SessionChannelVideo *) channel;
+    IHS_Session *session = channel->session;
+    const IHS_StreamVideoCallbacks *callbacks = session->callbacks.video;
+    IHS_Buffer *buffer = &videoCh->frame.buffer;
+    if (callbacks == NULL || callbacks->submitSlice == NULL || (buffer->size == 0 && !endOfFrame)) {
+        return;
+    }
+    if (videoCh->slice.size == 0) {
+        videoCh->slice.begin = IHS_SessionPacketTimestamp();
+        /* Parameter sets come first in a keyframe */
+        UpdateParamSets(channel, buffer, videoCh->frame.flags);
+    }
+    IHS_StreamVideoSlice slice = {
+            .data = IHS_BufferPointer(buffer),
+            .size = buffer->size,
+            .frameId = videoCh->frame.id,
+            .flags = videoCh->frame.flags,
+            .endOfFrame = endOfFrame,
+    };
+    IHS_StreamVideoSubmitResult result = callbacks->submitSlice(session, &slice, session->callbackContexts.video);
+    if (videoCh->slice.result == IHS_StreamVideoSubmitOK) {
+        videoCh->slice.result = result;
+    }
+    videoCh->slice.size += buffer->size;
+    IHS_BufferClear(buffer, false);
+    IHS_VideoNALIndexClear(&videoCh->frame.nals);
+    if (!endOfFrame) {
+        return;
+    }
+    /* Frame is considered received when the first slice is submitted */
+    uint16_t frameId = videoCh->frame.id;
+    IHS_VideoFrameStatsReceived(session->videoFrameStats, frameId, videoCh->slice.size, videoCh->slice.begin);
+    IHS_VideoFrameStatsEvent(session->videoFrameStats, frameId, k_EStreamFrameEventDecodeBegin,
+                             videoCh->slice.begin);
+    result = videoCh->slice.result;
+    videoCh->slice.size = 0;
+    videoCh->slice.result = IHS_StreamVideoSubmitOK;
+    HandleSubmitResult(channel, frameId, result);
+}
+
+static void DeliverFrame(IHS_StreamVideoFrame *frame, void *context) {
+    IHS_SessionChannel *channel = context;
     IHS_Session *session = channel->session;
     const IHS_StreamVideoCallbacks *callbacks = session->callbacks.video;
-    if (callbacks == NULL || callbacks->submit == NULL) {
+    void *cbContext = session->callbackContexts.video;
+    if (callbacks == NULL || (callbacks->submit == NULL && callbacks->submitFrame == NULL)) {
+        IHS_StreamVideoFrameRelease(frame);
         return;
     }
-    void *context = session->callbackContexts.video;
-    IHS_StreamVideoSubmitResult result = callbacks->submit(session, data, flags, context);
+    /* Frame may be released by decoder before returning */
+    uint16_t frameId = IHS_StreamVideoFrameGetId(frame);
+    UpdateParamSets(channel, IHS_StreamVideoFrameGetData(frame), IHS_StreamVideoFrameGetFlags(frame));
+    IHS_VideoFrameStatsEvent(session->videoFrameStats, frameId, k_EStreamFrameEventDecodeBegin,
+                             IHS_SessionPacketTimestamp());
+    IHS_StreamVideoSubmitResult result;
+    if (callbacks->submitFrame != NULL) {
+        result = callbacks->submitFrame(session, frame, cbContext);
+    } else {
+        result = callbacks->submit(session, IHS_StreamVideoFrameGetData(frame), IHS_StreamVideoFrameGetFlags(frame),
+                                   cbContext);
+        IHS_StreamVideoFrameRelease(frame);
+    }
+    HandleSubmitResult(channel, frameId, result);
+}
+
+static void HandleSubmitResult(IHS_SessionChannel *channel, uint16_t frameId, IHS_StreamVideoSubmitResult result) {
+    IHS_Session *session = channel->session;
+    IHS_VideoFrameStats *stats = session->videoFrameStats;
+    uint32_t now = IHS_SessionPacketTimestamp();
+    if (result == IHS_StreamVideoSubmitOK) {
+        /* Application reports when the frame is actually decoded and displayed */
+        if (!IHS_VideoFrameStatsHasExternalEvents(stats)) {
+            IHS_VideoFrameStatsEvent(stats, frameId, k_EStreamFrameEventDecodeEnd, now);
+            IHS_VideoFrameStatsEvent(stats, frameId, k_EStreamFrameEventComplete, now);
+            IHS_VideoFrameStatsResult(stats, frameId, k_EStreamFrameResultDisplayed);
+        }
+    } else {
+        IHS_VideoFrameStatsEvent(stats, frameId, k_EStreamFrameEventDecodeEnd, now);
+        IHS_VideoFrameStatsResult(stats, frameId, k_EStreamFrameResultDroppedDecodeCorrupt);
+    }
     if (result == IHS_StreamVideoSubmitReportLost) {
         IHS_SessionLog(session, IHS_LogLevelInfo, "Video", "Decoder reported frame lost.");
         IHS_SessionChannelDataLost(channel);
@@ -350,6 +556,23 @@ static void SubmitFrame(IHS_SessionChannel *channel, IHS_Buffer *data, IHS_Strea
     }
 }
 
+static void UpdateParamSets(IHS_SessionChannel *channel, const IHS_Buffer *data, IHS_StreamVideoFrameFlag flags) {
+    if (!(flags & IHS_StreamVideoFrameKeyFrame)) {
+        return;
+    }
+    IHS_SessionChannelVideo *videoCh = (IHS_SessionChannelVideo *) channel;
+    IHS_Session *session = channel->session;
+    if (!IHS_VideoParamSetsUpdate(&videoCh->paramSets, IHS_BufferPointer(data), data->size)) {
+        return;
+    }
+    IHS_SessionLog(session, IHS_LogLevelDebug, "Video", "Codec parameter sets changed");
+    const IHS_StreamVideoCallbacks *callbacks = session->callbacks.video;
+    if (callbacks->parameterSetsChanged != NULL) {
+        callbacks->parameterSetsChanged(session, IHS_VideoParamSetsGetData(&videoCh->paramSets),
+                                        session->callbackContexts.video);
+    }
+}
+
 static uint64_t ReportVideoStats(int runCount, void *data) {
     (void) runCount;
     IHS_SessionChannel *channel = data;
@@ -363,5 +586,12 @@ static uint64_t ReportVideoStats(int runCount, void *data) {
     IHS_SessionLog(channel->session, IHS_LogLevelVerbose, "Video", "%.2f FPS", videoCh->states.frameCounter / 1.0);
     videoCh->states.frameCounter = 0;
     IHS_MutexUnlock(videoCh->stateMutex);
+
+    IHS_VideoFrameStatsCollect(channel->session->videoFrameStats, IHS_SessionPacketTimestamp(), &message);
+    IHS_SessionChannel *statsCh = IHS_SessionChannelFor(channel->session, IHS_SessionChannelIdStats);
+    if (statsCh != NULL) {
+        IHS_SessionChannelStatsSend(statsCh, k_EStreamStatsFrameEvents, (const ProtobufCMessage *) &message,
+                                    IHS_PACKET_ID_NEXT);
+    }
     return 1000;
 }
\ No newline at end of file
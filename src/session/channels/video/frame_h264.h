@@ -28,6 +28,16 @@
 
 #include "session/channels/channel.h"
 #include "ch_data_video.h"
+#include "nal_index.h"
 
-void IHS_SessionVideoFrameAppendH264(IHS_Buffer *buffer, const uint8_t *data, size_t len,
-                                     const IHS_VideoFrameHeader *header);
\ No newline at end of file
+/**
+ * Append part of a video data frame to the frame buffer
+ * @param buffer Frame buffer
+ * @param nals NAL units index of the frame, can be NULL
+ * @param data Data to append
+ * @param len Length of data
+ * @param offset Position of data in the video data frame, so one data frame can be appended in multiple segments
+ * @param header Video data frame header
+ */
+void IHS_SessionVideoFrameAppendH264(IHS_Buffer *buffer, IHS_VideoNALIndex *nals, const uint8_t *data, size_t len,
+                                     size_t offset, const IHS_VideoFrameHeader *header);
\ No newline at end of file
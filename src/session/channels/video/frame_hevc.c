@@ -25,35 +25,28 @@
 
 #include "frame_hevc.h"
 #include "ch_data_video.h"
+#include "nal_escape.h"
 
 const static uint8_t startSeq[] = {0x00, 0x00, 0x00, 0x01};
 
-static size_t EscapeNAL(uint8_t *out, const uint8_t *src, size_t inLen);
-
-void IHS_SessionVideoFrameAppendHEVC(IHS_Buffer *buffer, const uint8_t *data, size_t len,
-                                     const IHS_VideoFrameHeader *header) {
+void IHS_SessionVideoFrameAppendHEVC(IHS_Buffer *buffer, IHS_VideoNALIndex *nals, const uint8_t *data, size_t len,
+                                     size_t offset, const IHS_VideoFrameHeader *header) {
     if (header->flags & VideoFrameFlagNeedEscape) {
-        size_t escapedCap = (len * 3) / 2 + 1;
-        if (header->flags & VideoFrameFlagNeedStartSequence) {
+        if (offset == 0 && header->flags & VideoFrameFlagNeedStartSequence) {
             assert(len >= 1);
+            size_t startCode = buffer->size;
             IHS_BufferAppendMem(buffer, startSeq, sizeof(startSeq));
+            if (nals != NULL) {
+                uint8_t type = IHS_VideoNALType(IHS_StreamVideoCodecHEVC, data[0]);
+                IHS_VideoNALIndexAdd(nals, startCode, buffer->size, type);
+            }
         }
-        size_t escapedLen = EscapeNAL(IHS_BufferPointerForAppend(buffer, escapedCap), data, len);
-        buffer->size += escapedLen;
+        IHS_SessionVideoNALAppendEscaped(buffer, data, len, offset);
     } else {
         IHS_BufferAppendMem(buffer, data, len);
+        if (nals != NULL) {
+            IHS_VideoNALIndexScan(nals, IHS_StreamVideoCodecHEVC, buffer);
+        }
     }
 }
 
-static size_t EscapeNAL(uint8_t *out, const uint8_t *src, size_t inLen) {
-    uint8_t *dst = out;
-    const uint8_t *end = src + inLen;
-    if (src < end) *dst++ = *src++;
-    if (src < end) *dst++ = *src++;
-    while (src < end) {
-        if (src[0] <= 0x03 && !dst[-2] && !dst[-1])
-            *dst++ = 0x03;
-        *dst++ = *src++;
-    }
-    return dst - out;
-}
@@ -0,0 +1,186 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "frame_pool.h"
+#include "ihs_buffer.h"
+#include "ihs_thread.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+struct IHS_StreamVideoFrame {
+    atomic_int refCount;
+    IHS_Buffer data;
+    IHS_VideoNALIndex nals;
+    uint16_t id;
+    IHS_StreamVideoFrameFlag flags;
+    IHS_VideoFramePool *pool;
+    /**
+     * Next idle frame in the pool
+     */
+    IHS_StreamVideoFrame *next;
+};
+
+struct IHS_VideoFramePool {
+    size_t capacity;
+    /**
+     * Stack of idle frames
+     */
+    IHS_StreamVideoFrame *idle;
+    size_t numIdle;
+    /**
+     * Frames still referenced by decoder
+     */
+    size_t numOutstanding;
+    bool destroyed;
+    IHS_Mutex *lock;
+};
+
+static void FrameFree(IHS_StreamVideoFrame *frame);
+
+static void PoolFree(IHS_VideoFramePool *pool);
+
+IHS_VideoFramePool *IHS_VideoFramePoolCreate(size_t capacity) {
+    IHS_VideoFramePool *pool = calloc(1, sizeof(IHS_VideoFramePool));
+    pool->capacity = capacity;
+    pool->lock = IHS_MutexCreate();
+    return pool;
+}
+
+void IHS_VideoFramePoolDestroy(IHS_VideoFramePool *pool) {
+    IHS_MutexLock(pool->lock);
+    assert(!pool->destroyed);
+    pool->destroyed = true;
+    while (pool->idle != NULL) {
+        IHS_StreamVideoFrame *frame = pool->idle;
+        pool->idle = frame->next;
+        FrameFree(frame);
+    }
+    pool->numIdle = 0;
+    bool canFree = pool->numOutstanding == 0;
+    IHS_MutexUnlock(pool->lock);
+    if (canFree) {
+        PoolFree(pool);
+    }
+}
+
+IHS_StreamVideoFrame *IHS_VideoFramePoolWrap(IHS_VideoFramePool *pool, IHS_Buffer *buffer, IHS_VideoNALIndex *nals,
+                                             uint16_t frameId, IHS_StreamVideoFrameFlag flags) {
+    IHS_MutexLock(pool->lock);
+    assert(!pool->destroyed);
+    IHS_StreamVideoFrame *frame = pool->idle;
+    if (frame != NULL) {
+        pool->idle = frame->next;
+        pool->numIdle--;
+    }
+    pool->numOutstanding++;
+    IHS_MutexUnlock(pool->lock);
+
+    if (frame == NULL) {
+        frame = calloc(1, sizeof(IHS_StreamVideoFrame));
+        frame->pool = pool;
+        IHS_BufferInit(&frame->data, buffer->initialCapacity, buffer->maxCapacity);
+        IHS_VideoNALIndexInit(&frame->nals);
+    }
+    frame->next = NULL;
+    frame->id = frameId;
+    frame->flags = flags;
+    atomic_init(&frame->refCount, 1);
+
+    IHS_Buffer recycled = frame->data;
+    frame->data = *buffer;
+    *buffer = recycled;
+    if (nals != NULL) {
+        IHS_VideoNALIndex recycledNals = frame->nals;
+        frame->nals = *nals;
+        *nals = recycledNals;
+    }
+    return frame;
+}
+
+IHS_Buffer *IHS_StreamVideoFrameGetData(IHS_StreamVideoFrame *frame) {
+    return &frame->data;
+}
+
+IHS_StreamVideoFrameFlag IHS_StreamVideoFrameGetFlags(const IHS_StreamVideoFrame *frame) {
+    return frame->flags;
+}
+
+uint16_t IHS_StreamVideoFrameGetId(const IHS_StreamVideoFrame *frame) {
+    return frame->id;
+}
+
+const IHS_StreamVideoNALUnit *IHS_StreamVideoFrameGetNALUnits(const IHS_StreamVideoFrame *frame, size_t *count) {
+    *count = frame->nals.count;
+    return frame->nals.units;
+}
+
+IHS_StreamVideoFrame *IHS_StreamVideoFrameRetain(IHS_StreamVideoFrame *frame) {
+    int prev = atomic_fetch_add(&frame->refCount, 1);
+    assert(prev > 0);
+    (void) prev;
+    return frame;
+}
+
+void IHS_StreamVideoFrameRelease(IHS_StreamVideoFrame *frame) {
+    int prev = atomic_fetch_sub(&frame->refCount, 1);
+    assert(prev > 0);
+    if (prev != 1) {
+        return;
+    }
+    IHS_VideoFramePool *pool = frame->pool;
+    IHS_BufferClear(&frame->data, false);
+    IHS_VideoNALIndexClear(&frame->nals);
+    IHS_MutexLock(pool->lock);
+    assert(pool->numOutstanding > 0);
+    pool->numOutstanding--;
+    bool keep = !pool->destroyed && pool->numIdle < pool->capacity;
+    if (keep) {
+        frame->next = pool->idle;
+        pool->idle = frame;
+        pool->numIdle++;
+    }
+    bool canFreePool = pool->destroyed && pool->numOutstanding == 0;
+    IHS_MutexUnlock(pool->lock);
+    if (!keep) {
+        FrameFree(frame);
+    }
+    if (canFreePool) {
+        PoolFree(pool);
+    }
+}
+
+static void FrameFree(IHS_StreamVideoFrame *frame) {
+    IHS_BufferClear(&frame->data, true);
+    IHS_VideoNALIndexDeinit(&frame->nals);
+    free(frame);
+}
+
+static void PoolFree(IHS_VideoFramePool *pool) {
+    IHS_MutexDestroy(pool->lock);
+    free(pool);
+}
@@ -0,0 +1,60 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ihslib/video.h"
+#include "nal_index.h"
+
+/**
+ * @file frame_pool.h
+ * @brief Pool of reference counted video frames handed to decoders
+ * @note This pool is thread safe. It stays alive until all frames are released, even after destroyed.
+ */
+
+typedef struct IHS_VideoFramePool IHS_VideoFramePool;
+
+/**
+ * @param capacity Maximum number of idle frames kept by the pool
+ */
+IHS_VideoFramePool *IHS_VideoFramePoolCreate(size_t capacity);
+
+/**
+ * Free idle frames. Frames still referenced will be freed when released.
+ */
+void IHS_VideoFramePoolDestroy(IHS_VideoFramePool *pool);
+
+/**
+ * Move data of the buffer into a frame from the pool, with one reference.
+ * The buffer will get storage of the recycled frame instead, so it can be used for next frame without allocation.
+ * @param buffer Buffer to take data from. It will be empty afterwards.
+ * @param nals NAL units of the frame data, moved the same way as buffer. Can be NULL.
+ * @param frameId ID of the first data frame of this video frame
+ */
+IHS_StreamVideoFrame *IHS_VideoFramePoolWrap(IHS_VideoFramePool *pool, IHS_Buffer *buffer, IHS_VideoNALIndex *nals,
+                                             uint16_t frameId, IHS_StreamVideoFrameFlag flags);
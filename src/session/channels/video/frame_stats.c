@@ -0,0 +1,402 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "frame_stats.h"
+#include "ihs_thread.h"
+#include "session/packet.h"
+#include "protobuf/pb_utils.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FRAME_STATS_MAX_EVENTS 6
+#define FRAME_STATS_NUM_ACCUMULATED 5
+/* Frames without outcome after 1 second are considered dropped */
+#define FRAME_STATS_PENDING_TIMEOUT IHS_SESSION_PACKET_TIMESTAMP_FROM_MILLIS(1000)
+
+typedef struct FrameRecord {
+    uint16_t id;
+    uint32_t size;
+    uint32_t received;
+    EStreamFrameResult result;
+    size_t numEvents;
+    struct {
+        EStreamFrameEvent id;
+        uint32_t timestamp;
+    } events[FRAME_STATS_MAX_EVENTS];
+} FrameRecord;
+
+typedef struct Accumulator {
+    int32_t count;
+    double sum;
+    double sumSq;
+} Accumulator;
+
+struct IHS_VideoFrameStats {
+    FrameRecord *records;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    struct {
+        uint32_t received;
+        uint64_t receivedBytes;
+        uint32_t displayed;
+        Accumulator decodeDuration;
+        Accumulator clientDuration;
+        Accumulator frameDuration;
+        uint32_t lastCollect;
+        uint32_t lastComplete;
+        bool hasLastComplete;
+    } accumulated;
+    IHS_VideoFrameLatencyStats latency;
+    atomic_bool externalEvents;
+    struct {
+        CFrameStats *stats;
+        CFrameStats **statsPtrs;
+        CFrameEvent *events;
+        CFrameEvent **eventPtrs;
+        CFrameStatAccumulatedValue values[FRAME_STATS_NUM_ACCUMULATED];
+        CFrameStatAccumulatedValue *valuePtrs[FRAME_STATS_NUM_ACCUMULATED];
+    } report;
+    IHS_Mutex *lock;
+};
+
+static FrameRecord *RecordAt(IHS_VideoFrameStats *stats, size_t index);
+
+/**
+ * Find tracked frame, searching from the newest one
+ * @param index Position of the frame, from the oldest one
+ */
+static FrameRecord *RecordFind(IHS_VideoFrameStats *stats, uint16_t frameId, size_t *index);
+
+static bool RecordGetEvent(const FrameRecord *record, EStreamFrameEvent event, uint32_t *timestamp);
+
+static void RecordAccumulate(IHS_VideoFrameStats *stats, const FrameRecord *record);
+
+static void RecordFillStats(const FrameRecord *record, CFrameStats *message, CFrameEvent *events,
+                            CFrameEvent **eventPtrs);
+
+static void AccumulatorAdd(Accumulator *accumulator, double value);
+
+static size_t LatencyBucket(double millis);
+
+static void AccumulatorFill(const Accumulator *accumulator, EFrameAccumulatedStat type,
+                            CFrameStatAccumulatedValue *value);
+
+static double TimestampDiffMillis(uint32_t from, uint32_t to);
+
+IHS_VideoFrameStats *IHS_VideoFrameStatsCreate(size_t capacity) {
+    assert(capacity > 0);
+    IHS_VideoFrameStats *stats = calloc(1, sizeof(IHS_VideoFrameStats));
+    stats->records = calloc(capacity, sizeof(FrameRecord));
+    stats->capacity = capacity;
+    stats->report.stats = calloc(capacity, sizeof(CFrameStats));
+    stats->report.statsPtrs = calloc(capacity, sizeof(CFrameStats *));
+    stats->report.events = calloc(capacity * FRAME_STATS_MAX_EVENTS, sizeof(CFrameEvent));
+    stats->report.eventPtrs = calloc(capacity * FRAME_STATS_MAX_EVENTS, sizeof(CFrameEvent *));
+    stats->accumulated.lastCollect = IHS_SessionPacketTimestamp();
+    atomic_init(&stats->externalEvents, false);
+    stats->lock = IHS_MutexCreate();
+    return stats;
+}
+
+void IHS_VideoFrameStatsDestroy(IHS_VideoFrameStats *stats) {
+    IHS_MutexDestroy(stats->lock);
+    free(stats->report.eventPtrs);
+    free(stats->report.events);
+    free(stats->report.statsPtrs);
+    free(stats->report.stats);
+    free(stats->records);
+    free(stats);
+}
+
+void IHS_VideoFrameStatsReset(IHS_VideoFrameStats *stats) {
+    IHS_MutexLock(stats->lock);
+    stats->head = 0;
+    stats->count = 0;
+    memset(&stats->accumulated, 0, sizeof(stats->accumulated));
+    stats->accumulated.lastCollect = IHS_SessionPacketTimestamp();
+    IHS_MutexUnlock(stats->lock);
+}
+
+void IHS_VideoFrameStatsReceived(IHS_VideoFrameStats *stats, uint16_t frameId, uint32_t size, uint32_t timestamp) {
+    IHS_MutexLock(stats->lock);
+    if (stats->count == stats->capacity) {
+        stats->head = (stats->head + 1) % stats->capacity;
+        stats->count--;
+    }
+    FrameRecord *record = RecordAt(stats, stats->count++);
+    record->id = frameId;
+    record->size = size;
+    record->received = timestamp;
+    record->result = k_EStreamFrameResultPending;
+    record->numEvents = 1;
+    record->events[0].id = k_EStreamFrameEventRecv;
+    record->events[0].timestamp = timestamp;
+    IHS_MutexUnlock(stats->lock);
+}
+
+void IHS_VideoFrameStatsEvent(IHS_VideoFrameStats *stats, uint16_t frameId, EStreamFrameEvent event,
+                              uint32_t timestamp) {
+    IHS_MutexLock(stats->lock);
+    FrameRecord *record = RecordFind(stats, frameId, NULL);
+    if (record == NULL) {
+        goto unlock;
+    }
+    for (size_t i = 0; i < record->numEvents; i++) {
+        if (record->events[i].id == event) {
+            record->events[i].timestamp = timestamp;
+            goto unlock;
+        }
+    }
+    if (record->numEvents < FRAME_STATS_MAX_EVENTS) {
+        record->events[record->numEvents].id = event;
+        record->events[record->numEvents].timestamp = timestamp;
+        record->numEvents++;
+    }
+    unlock:
+    IHS_MutexUnlock(stats->lock);
+}
+
+void IHS_VideoFrameStatsExternalEvent(IHS_VideoFrameStats *stats, uint16_t frameId, EStreamFrameEvent event,
+                                      uint32_t timestamp) {
+    atomic_store(&stats->externalEvents, true);
+    IHS_VideoFrameStatsEvent(stats, frameId, event, timestamp);
+    if (event == k_EStreamFrameEventComplete) {
+        IHS_VideoFrameStatsResult(stats, frameId, k_EStreamFrameResultDisplayed);
+    }
+}
+
+bool IHS_VideoFrameStatsHasExternalEvents(IHS_VideoFrameStats *stats) {
+    return atomic_load(&stats->externalEvents);
+}
+
+void IHS_VideoFrameStatsResult(IHS_VideoFrameStats *stats, uint16_t frameId, EStreamFrameResult result) {
+    IHS_MutexLock(stats->lock);
+    size_t index;
+    FrameRecord *record = RecordFind(stats, frameId, &index);
+    if (record == NULL) {
+        goto unlock;
+    }
+    record->result = result;
+    for (size_t i = 0; i < index; i++) {
+        FrameRecord *earlier = RecordAt(stats, i);
+        if (earlier->result == k_EStreamFrameResultPending &&
+            !RecordGetEvent(earlier, k_EStreamFrameEventDecodeBegin, NULL)) {
+            earlier->result = k_EStreamFrameResultDroppedDecodeSlow;
+        }
+    }
+    unlock:
+    IHS_MutexUnlock(stats->lock);
+}
+
+void IHS_VideoFrameStatsCollect(IHS_VideoFrameStats *stats, uint32_t now, CFrameStatsListMsg *message) {
+    IHS_MutexLock(stats->lock);
+    size_t numStats = 0;
+    while (stats->count > 0) {
+        FrameRecord *record = RecordAt(stats, 0);
+        if (record->result == k_EStreamFrameResultPending) {
+            if ((uint32_t) (now - record->received) < FRAME_STATS_PENDING_TIMEOUT) {
+                break;
+            }
+            record->result = k_EStreamFrameResultDroppedDecodeSlow;
+        }
+        RecordAccumulate(stats, record);
+        CFrameStats *item = &stats->report.stats[numStats];
+        RecordFillStats(record, item, &stats->report.events[numStats * FRAME_STATS_MAX_EVENTS],
+                        &stats->report.eventPtrs[numStats * FRAME_STATS_MAX_EVENTS]);
+        stats->report.statsPtrs[numStats++] = item;
+        stats->head = (stats->head + 1) % stats->capacity;
+        stats->count--;
+    }
+    message->n_stats = numStats;
+    message->stats = stats->report.statsPtrs;
+
+    double elapsedSeconds = TimestampDiffMillis(stats->accumulated.lastCollect, now) / 1000.0;
+    if (elapsedSeconds <= 0) {
+        elapsedSeconds = 1;
+    }
+    size_t numValues = 0;
+    CFrameStatAccumulatedValue *value;
+
+    value = &stats->report.values[numValues++];
+    cframe_stat_accumulated_value__init(value);
+    value->stat_type = k_EFrameStatFPS;
+    value->count = (int32_t) stats->accumulated.displayed;
+    value->average = (float) (stats->accumulated.displayed / elapsedSeconds);
+
+    value = &stats->report.values[numValues++];
+    cframe_stat_accumulated_value__init(value);
+    value->stat_type = k_EFrameStatClientBitrateKbitPerSec;
+    value->count = (int32_t) stats->accumulated.received;
+    value->average = (float) (stats->accumulated.receivedBytes * 8 / 1000.0 / elapsedSeconds);
+
+    const struct {
+        const Accumulator *accumulator;
+        EFrameAccumulatedStat type;
+    } durations[] = {
+            {&stats->accumulated.decodeDuration, k_EFrameStatDecodeDurationMS},
+            {&stats->accumulated.clientDuration, k_EFrameStatClientDurationMS},
+            {&stats->accumulated.frameDuration,  k_EFrameStatFrameDurationMS},
+    };
+    for (size_t i = 0; i < sizeof(durations) / sizeof(durations[0]); i++) {
+        if (durations[i].accumulator->count == 0) {
+            continue;
+        }
+        value = &stats->report.values[numValues++];
+        AccumulatorFill(durations[i].accumulator, durations[i].type, value);
+    }
+    assert(numValues <= FRAME_STATS_NUM_ACCUMULATED);
+    for (size_t i = 0; i < numValues; i++) {
+        stats->report.valuePtrs[i] = &stats->report.values[i];
+    }
+    message->n_accumulated_stats = numValues;
+    message->accumulated_stats = stats->report.valuePtrs;
+
+    stats->accumulated.received = 0;
+    stats->accumulated.receivedBytes = 0;
+    stats->accumulated.displayed = 0;
+    stats->accumulated.decodeDuration = (Accumulator) {0};
+    stats->accumulated.clientDuration = (Accumulator) {0};
+    stats->accumulated.frameDuration = (Accumulator) {0};
+    stats->accumulated.lastCollect = now;
+    IHS_MutexUnlock(stats->lock);
+}
+
+void IHS_VideoFrameStatsGetLatency(IHS_VideoFrameStats *stats, IHS_VideoFrameLatencyStats *latency) {
+    IHS_MutexLock(stats->lock);
+    *latency = stats->latency;
+    IHS_MutexUnlock(stats->lock);
+}
+
+static FrameRecord *RecordAt(IHS_VideoFrameStats *stats, size_t index) {
+    assert(index < stats->capacity);
+    return &stats->records[(stats->head + index) % stats->capacity];
+}
+
+static FrameRecord *RecordFind(IHS_VideoFrameStats *stats, uint16_t frameId, size_t *index) {
+    for (size_t i = stats->count; i > 0; i--) {
+        FrameRecord *record = RecordAt(stats, i - 1);
+        if (record->id == frameId) {
+            if (index != NULL) {
+                *index = i - 1;
+            }
+            return record;
+        }
+    }
+    return NULL;
+}
+
+static bool RecordGetEvent(const FrameRecord *record, EStreamFrameEvent event, uint32_t *timestamp) {
+    for (size_t i = 0; i < record->numEvents; i++) {
+        if (record->events[i].id == event) {
+            if (timestamp != NULL) {
+                *timestamp = record->events[i].timestamp;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static void RecordAccumulate(IHS_VideoFrameStats *stats, const FrameRecord *record) {
+    stats->accumulated.received++;
+    stats->accumulated.receivedBytes += record->size;
+    if (record->result != k_EStreamFrameResultDisplayed) {
+        return;
+    }
+    stats->accumulated.displayed++;
+    uint32_t begin, end;
+    if (RecordGetEvent(record, k_EStreamFrameEventDecodeBegin, &begin) &&
+        RecordGetEvent(record, k_EStreamFrameEventDecodeEnd, &end)) {
+        double decodeDuration = TimestampDiffMillis(begin, end);
+        AccumulatorAdd(&stats->accumulated.decodeDuration, decodeDuration);
+        stats->latency.decode[LatencyBucket(decodeDuration)]++;
+    }
+    uint32_t complete;
+    if (!RecordGetEvent(record, k_EStreamFrameEventComplete, &complete)) {
+        return;
+    }
+    double clientDuration = TimestampDiffMillis(record->received, complete);
+    AccumulatorAdd(&stats->accumulated.clientDuration, clientDuration);
+    stats->latency.display[LatencyBucket(clientDuration)]++;
+    if (stats->accumulated.hasLastComplete) {
+        AccumulatorAdd(&stats->accumulated.frameDuration,
+                       TimestampDiffMillis(stats->accumulated.lastComplete, complete));
+    }
+    stats->accumulated.lastComplete = complete;
+    stats->accumulated.hasLastComplete = true;
+}
+
+static void RecordFillStats(const FrameRecord *record, CFrameStats *message, CFrameEvent *events,
+                            CFrameEvent **eventPtrs) {
+    cframe_stats__init(message);
+    message->frame_id = record->id;
+    message->result = record->result;
+    PROTOBUF_C_P_SET_VALUE(message, frame_size, record->size);
+    for (size_t i = 0; i < record->numEvents; i++) {
+        cframe_event__init(&events[i]);
+        events[i].event_id = record->events[i].id;
+        events[i].timestamp = record->events[i].timestamp;
+        eventPtrs[i] = &events[i];
+    }
+    message->n_events = record->numEvents;
+    message->events = eventPtrs;
+}
+
+static void AccumulatorAdd(Accumulator *accumulator, double value) {
+    accumulator->count++;
+    accumulator->sum += value;
+    accumulator->sumSq += value * value;
+}
+
+static size_t LatencyBucket(double millis) {
+    size_t bucket = 0;
+    double upper = 1;
+    while (bucket < IHS_SESSION_LATENCY_HISTOGRAM_SIZE - 1 && millis >= upper) {
+        bucket++;
+        upper *= 2;
+    }
+    return bucket;
+}
+
+static void AccumulatorFill(const Accumulator *accumulator, EFrameAccumulatedStat type,
+                            CFrameStatAccumulatedValue *value) {
+    assert(accumulator->count > 0);
+    cframe_stat_accumulated_value__init(value);
+    double average = accumulator->sum / accumulator->count;
+    double variance = accumulator->sumSq / accumulator->count - average * average;
+    value->stat_type = type;
+    value->count = accumulator->count;
+    value->average = (float) average;
+    PROTOBUF_C_P_SET_VALUE(value, stddev, (float) sqrt(variance > 0 ? variance : 0));
+}
+
+static double TimestampDiffMillis(uint32_t from, uint32_t to) {
+    return (uint32_t) (to - from) * 1000.0 / 65536;
+}
@@ -0,0 +1,101 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ihslib/session.h"
+#include "protobuf/remoteplay.pb-c.h"
+
+/**
+ * @file frame_stats.h
+ * @brief Per-frame events and outcomes, reported to host as CFrameStatsListMsg
+ * @note This object is thread safe. Timestamps are in packet timestamp units.
+ */
+
+typedef struct IHS_VideoFrameStats IHS_VideoFrameStats;
+
+/**
+ * Latency of displayed frames since creation, see IHS_SESSION_LATENCY_HISTOGRAM_SIZE for buckets
+ */
+typedef struct IHS_VideoFrameLatencyStats {
+    uint64_t decode[IHS_SESSION_LATENCY_HISTOGRAM_SIZE];
+    uint64_t display[IHS_SESSION_LATENCY_HISTOGRAM_SIZE];
+} IHS_VideoFrameLatencyStats;
+
+/**
+ * @param capacity Maximum number of frames kept before reporting. Oldest frames will be forgotten when it's full.
+ */
+IHS_VideoFrameStats *IHS_VideoFrameStatsCreate(size_t capacity);
+
+void IHS_VideoFrameStatsDestroy(IHS_VideoFrameStats *stats);
+
+/**
+ * Forget all tracked frames and stats accumulated for next collection. Latency histograms are kept.
+ */
+void IHS_VideoFrameStatsReset(IHS_VideoFrameStats *stats);
+
+/**
+ * Start tracking a frame that has been fully received, with a k_EStreamFrameEventRecv event
+ * @param size Assembled frame size in bytes
+ */
+void IHS_VideoFrameStatsReceived(IHS_VideoFrameStats *stats, uint16_t frameId, uint32_t size, uint32_t timestamp);
+
+/**
+ * Record an event for a tracked frame. Unknown frames are ignored.
+ */
+void IHS_VideoFrameStatsEvent(IHS_VideoFrameStats *stats, uint16_t frameId, EStreamFrameEvent event,
+                              uint32_t timestamp);
+
+/**
+ * Record an event reported by application. After this, application is responsible for reporting
+ * k_EStreamFrameEventComplete, which marks the frame as displayed.
+ */
+void IHS_VideoFrameStatsExternalEvent(IHS_VideoFrameStats *stats, uint16_t frameId, EStreamFrameEvent event,
+                                      uint32_t timestamp);
+
+/**
+ * @return true if application has ever reported events
+ */
+bool IHS_VideoFrameStatsHasExternalEvents(IHS_VideoFrameStats *stats);
+
+/**
+ * Record outcome of a tracked frame. Frames are decoded in order, so earlier frames still pending and never started
+ * decoding are considered dropped for slow decoding.
+ */
+void IHS_VideoFrameStatsResult(IHS_VideoFrameStats *stats, uint16_t frameId, EStreamFrameResult result);
+
+/**
+ * Move frames with outcome into the message, and accumulate stats since last collection.
+ * Frames pending for too long will be reported as dropped.
+ * @param message Message to fill stats and accumulated_stats in. Arrays are owned by this object,
+ *                and only valid until next collection, so it should be called from one thread only.
+ */
+void IHS_VideoFrameStatsCollect(IHS_VideoFrameStats *stats, uint32_t now, CFrameStatsListMsg *message);
+
+void IHS_VideoFrameStatsGetLatency(IHS_VideoFrameStats *stats, IHS_VideoFrameLatencyStats *latency);
@@ -0,0 +1,151 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nal_escape.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define NAL_ESCAPE_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define NAL_ESCAPE_NEON
+#endif
+
+#define NAL_ESCAPE_CHUNK 16
+
+/**
+ * @param out Output, or NULL to count escaped length only
+ */
+static size_t Escape(uint8_t *out, const uint8_t *src, size_t len, int *zeros);
+
+/**
+ * Check if a chunk of 16 bytes has two consecutive zero bytes
+ * @param lastZero Set to true if last byte of the chunk is zero
+ */
+static bool ChunkHasZeroPair(const uint8_t *src, bool *lastZero);
+
+size_t IHS_SessionVideoNALEscapedSize(const uint8_t *src, size_t len, int zeros) {
+    return Escape(NULL, src, len, &zeros);
+}
+
+size_t IHS_SessionVideoNALEscape(uint8_t *out, const uint8_t *src, size_t len, int *zeros) {
+    return Escape(out, src, len, zeros);
+}
+
+void IHS_SessionVideoNALAppendEscaped(IHS_Buffer *buffer, const uint8_t *data, size_t len, size_t offset) {
+    if (offset < 2) {
+        size_t raw = 2 - offset < len ? 2 - offset : len;
+        IHS_BufferAppendMem(buffer, data, raw);
+        data += raw;
+        len -= raw;
+    }
+    if (len == 0) {
+        return;
+    }
+    assert(buffer->size >= 2);
+    const uint8_t *tail = IHS_BufferPointerAt(buffer, buffer->size - 2);
+    int zeros = tail[1] != 0 ? 0 : tail[0] != 0 ? 1 : 2;
+    size_t escapedLen = IHS_SessionVideoNALEscapedSize(data, len, zeros);
+    buffer->size += IHS_SessionVideoNALEscape(IHS_BufferPointerForAppend(buffer, escapedLen), data, len, &zeros);
+}
+
+static size_t Escape(uint8_t *out, const uint8_t *src, size_t len, int *zeros) {
+    size_t written = 0, i = 0;
+    int z = *zeros;
+    while (i < len) {
+        bool lastZero;
+        /* Nothing to escape in a chunk without zero pair, as long as no zeros are pending before it */
+        if (z == 0 && len - i >= NAL_ESCAPE_CHUNK && !ChunkHasZeroPair(&src[i], &lastZero)) {
+            if (out != NULL) {
+                memcpy(&out[written], &src[i], NAL_ESCAPE_CHUNK);
+            }
+            written += NAL_ESCAPE_CHUNK;
+            i += NAL_ESCAPE_CHUNK;
+            z = lastZero ? 1 : 0;
+            continue;
+        }
+        /* Candidate nearby, go through the chunk byte by byte */
+        size_t end = len - i > NAL_ESCAPE_CHUNK ? i + NAL_ESCAPE_CHUNK : len;
+        for (; i < end; i++) {
+            uint8_t b = src[i];
+            if (z >= 2 && b <= 0x03) {
+                if (out != NULL) {
+                    out[written] = 0x03;
+                }
+                written++;
+                z = 0;
+            }
+            if (out != NULL) {
+                out[written] = b;
+            }
+            written++;
+            z = b == 0 ? z + 1 : 0;
+        }
+    }
+    *zeros = z > 2 ? 2 : z;
+    return written;
+}
+
+#if defined(NAL_ESCAPE_SSE2)
+
+static bool ChunkHasZeroPair(const uint8_t *src, bool *lastZero) {
+    __m128i v = _mm_loadu_si128((const __m128i *) src);
+    unsigned int mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()));
+    *lastZero = (mask & 0x8000) != 0;
+    return (mask & (mask >> 1)) != 0;
+}
+
+#elif defined(NAL_ESCAPE_NEON)
+
+static bool ChunkHasZeroPair(const uint8_t *src, bool *lastZero) {
+    uint8x16_t zero = vdupq_n_u8(0);
+    uint8x16_t eq = vceqq_u8(vld1q_u8(src), zero);
+    /* Lane i is set when both byte i and byte i + 1 are zero */
+    uint8x16_t pair = vandq_u8(eq, vextq_u8(eq, zero, 1));
+    uint64x2_t lanes = vreinterpretq_u64_u8(pair);
+    *lastZero = vgetq_lane_u8(eq, 15) != 0;
+    return (vgetq_lane_u64(lanes, 0) | vgetq_lane_u64(lanes, 1)) != 0;
+}
+
+#else
+
+static bool ChunkHasZeroPair(const uint8_t *src, bool *lastZero) {
+    bool prevZero = false;
+    for (int i = 0; i < NAL_ESCAPE_CHUNK; i++) {
+        bool isZero = src[i] == 0;
+        if (prevZero && isZero) {
+            return true;
+        }
+        prevZero = isZero;
+    }
+    *lastZero = prevZero;
+    return false;
+}
+
+#endif
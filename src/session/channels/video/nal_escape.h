@@ -0,0 +1,53 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ihs_buffer.h"
+
+/**
+ * Exact size of escaped data, with emulation prevention bytes (0x03) inserted
+ * @param src Data to escape
+ * @param len Length of data
+ * @param zeros Number of trailing zero bytes already written, at most 2
+ */
+size_t IHS_SessionVideoNALEscapedSize(const uint8_t *src, size_t len, int zeros);
+
+/**
+ * Insert emulation prevention bytes (0x03) after every two zero bytes followed by byte no greater than 0x03
+ * @param out Output with at least IHS_SessionVideoNALEscapedSize bytes
+ * @param zeros Number of trailing zero bytes already written. Will be updated so escaping can be continued.
+ * @return Number of bytes written
+ */
+size_t IHS_SessionVideoNALEscape(uint8_t *out, const uint8_t *src, size_t len, int *zeros);
+
+/**
+ * Escape part of a NAL unit and append it to the buffer
+ * @param offset Bytes of the same data frame already appended. First 2 bytes of a data frame are never escaped.
+ */
+void IHS_SessionVideoNALAppendEscaped(IHS_Buffer *buffer, const uint8_t *data, size_t len, size_t offset);
@@ -0,0 +1,97 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nal_index.h"
+
+#include <stdlib.h>
+
+#define NAL_INDEX_INITIAL_CAPACITY 16
+
+void IHS_VideoNALIndexInit(IHS_VideoNALIndex *index) {
+    index->units = NULL;
+    index->count = 0;
+    index->capacity = 0;
+    index->scanned = 0;
+}
+
+void IHS_VideoNALIndexDeinit(IHS_VideoNALIndex *index) {
+    free(index->units);
+    IHS_VideoNALIndexInit(index);
+}
+
+void IHS_VideoNALIndexClear(IHS_VideoNALIndex *index) {
+    index->count = 0;
+    index->scanned = 0;
+}
+
+void IHS_VideoNALIndexAdd(IHS_VideoNALIndex *index, size_t startCode, size_t offset, uint8_t type) {
+    if (index->count > 0) {
+        IHS_StreamVideoNALUnit *prev = &index->units[index->count - 1];
+        prev->length = startCode > prev->offset ? (uint32_t) (startCode - prev->offset) : 0;
+    }
+    if (index->count == index->capacity) {
+        size_t capacity = index->capacity > 0 ? index->capacity * 2 : NAL_INDEX_INITIAL_CAPACITY;
+        index->units = realloc(index->units, capacity * sizeof(IHS_StreamVideoNALUnit));
+        index->capacity = capacity;
+    }
+    IHS_StreamVideoNALUnit *unit = &index->units[index->count++];
+    unit->offset = (uint32_t) offset;
+    unit->length = 0;
+    unit->type = type;
+    index->scanned = offset;
+}
+
+void IHS_VideoNALIndexScan(IHS_VideoNALIndex *index, IHS_StreamVideoCodec codec, const IHS_Buffer *frame) {
+    const uint8_t *data = IHS_BufferPointer(frame);
+    size_t i = index->scanned;
+    /* Start code is only recognized with NAL header byte after it */
+    while (i + 3 < frame->size) {
+        if (data[i + 2] > 1) {
+            i += 3;
+        } else if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            size_t startCode = i > 0 && data[i - 1] == 0 ? i - 1 : i;
+            IHS_VideoNALIndexAdd(index, startCode, i + 3, IHS_VideoNALType(codec, data[i + 3]));
+            i += 3;
+        } else {
+            i++;
+        }
+    }
+    index->scanned = i;
+}
+
+void IHS_VideoNALIndexFinish(IHS_VideoNALIndex *index, size_t frameSize) {
+    if (index->count == 0) {
+        return;
+    }
+    IHS_StreamVideoNALUnit *last = &index->units[index->count - 1];
+    last->length = frameSize > last->offset ? (uint32_t) (frameSize - last->offset) : 0;
+}
+
+uint8_t IHS_VideoNALType(IHS_StreamVideoCodec codec, uint8_t header) {
+    if (codec == IHS_StreamVideoCodecHEVC) {
+        return (header >> 1) & 0x3F;
+    }
+    return header & 0x1F;
+}
@@ -0,0 +1,79 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ihslib/video.h"
+
+/**
+ * @file nal_index.h
+ * @brief Positions of NAL units in an assembled access unit, collected while the frame is being assembled
+ */
+
+typedef struct IHS_VideoNALIndex {
+    IHS_StreamVideoNALUnit *units;
+    size_t count;
+    size_t capacity;
+    /**
+     * Frame data before this position won't be scanned for start codes again
+     */
+    size_t scanned;
+} IHS_VideoNALIndex;
+
+void IHS_VideoNALIndexInit(IHS_VideoNALIndex *index);
+
+void IHS_VideoNALIndexDeinit(IHS_VideoNALIndex *index);
+
+/**
+ * Remove all units for next frame, storage is kept
+ */
+void IHS_VideoNALIndexClear(IHS_VideoNALIndex *index);
+
+/**
+ * Add a NAL unit, and end the previous one before its start code
+ * @param startCode Position of the start code in frame data
+ * @param offset Position of the NAL unit header in frame data
+ * @param type NAL unit type
+ */
+void IHS_VideoNALIndexAdd(IHS_VideoNALIndex *index, size_t startCode, size_t offset, uint8_t type);
+
+/**
+ * Find start codes in frame data not scanned yet. Used when data already contains start codes.
+ * Start codes split between appends will be found in the next scan.
+ */
+void IHS_VideoNALIndexScan(IHS_VideoNALIndex *index, IHS_StreamVideoCodec codec, const IHS_Buffer *frame);
+
+/**
+ * End the last NAL unit at the end of frame data
+ */
+void IHS_VideoNALIndexFinish(IHS_VideoNALIndex *index, size_t frameSize);
+
+/**
+ * Get NAL unit type from the first byte of NAL unit header
+ */
+uint8_t IHS_VideoNALType(IHS_StreamVideoCodec codec, uint8_t header);
@@ -0,0 +1,150 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "param_sets.h"
+#include "ihs_buffer.h"
+
+#include <string.h>
+
+/* Parameter sets are usually less than 100 bytes */
+#define PARAM_SET_MAX_SIZE 4096
+
+static const uint8_t StartCode[] = {0x00, 0x00, 0x00, 0x01};
+
+/**
+ * Find next 3 bytes start code
+ * @return Position of the start code, or len if not found
+ */
+static size_t FindStartCode(const uint8_t *data, size_t len, size_t from);
+
+/**
+ * @return Parameter set type, IHS_VideoParamSetCount for other non-VCL units, or -1 for slices
+ */
+static int NALParamSetType(IHS_StreamVideoCodec codec, const uint8_t *nal, size_t len);
+
+void IHS_VideoParamSetsInit(IHS_VideoParamSets *sets, IHS_StreamVideoCodec codec) {
+    sets->codec = codec;
+    for (int i = 0; i < IHS_VideoParamSetCount; i++) {
+        IHS_BufferInit(&sets->sets[i], 64, PARAM_SET_MAX_SIZE);
+    }
+    IHS_BufferInit(&sets->data, 256, (PARAM_SET_MAX_SIZE + sizeof(StartCode)) * IHS_VideoParamSetCount);
+}
+
+void IHS_VideoParamSetsDeinit(IHS_VideoParamSets *sets) {
+    for (int i = 0; i < IHS_VideoParamSetCount; i++) {
+        IHS_BufferClear(&sets->sets[i], true);
+    }
+    IHS_BufferClear(&sets->data, true);
+}
+
+bool IHS_VideoParamSetsUpdate(IHS_VideoParamSets *sets, const uint8_t *data, size_t len) {
+    if (sets->codec != IHS_StreamVideoCodecH264 && sets->codec != IHS_StreamVideoCodecHEVC) {
+        return false;
+    }
+    bool changed = false;
+    size_t start = FindStartCode(data, len, 0);
+    while (start < len) {
+        size_t nalStart = start + 3;
+        size_t next = FindStartCode(data, len, nalStart);
+        size_t nalEnd = next;
+        /* Zero bytes before next start code belong to it, or are trailing zeros */
+        while (nalEnd > nalStart && data[nalEnd - 1] == 0) {
+            nalEnd--;
+        }
+        int type = NALParamSetType(sets->codec, &data[nalStart], nalEnd - nalStart);
+        if (type < 0) {
+            break;
+        }
+        if (type < IHS_VideoParamSetCount) {
+            IHS_Buffer *cached = &sets->sets[type];
+            size_t nalLen = nalEnd - nalStart;
+            if (nalLen > PARAM_SET_MAX_SIZE) {
+                /* Malformed, not worth caching */
+            } else if (cached->size != nalLen || memcmp(IHS_BufferPointer(cached), &data[nalStart], nalLen) != 0) {
+                IHS_BufferClear(cached, false);
+                IHS_BufferAppendMem(cached, &data[nalStart], nalLen);
+                changed = true;
+            }
+        }
+        start = next;
+    }
+    if (!changed) {
+        return false;
+    }
+    IHS_BufferClear(&sets->data, false);
+    for (int i = 0; i < IHS_VideoParamSetCount; i++) {
+        if (sets->sets[i].size == 0) {
+            continue;
+        }
+        IHS_BufferAppendMem(&sets->data, StartCode, sizeof(StartCode));
+        IHS_BufferAppend(&sets->data, &sets->sets[i]);
+    }
+    return true;
+}
+
+const IHS_Buffer *IHS_VideoParamSetsGetData(const IHS_VideoParamSets *sets) {
+    return &sets->data;
+}
+
+static size_t FindStartCode(const uint8_t *data, size_t len, size_t from) {
+    for (size_t i = from; i + 3 <= len; i++) {
+        if (data[i + 2] > 1) {
+            /* Can't be a start code ending here or at next 2 bytes */
+            i += 2;
+        } else if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            return i;
+        }
+    }
+    return len;
+}
+
+static int NALParamSetType(IHS_StreamVideoCodec codec, const uint8_t *nal, size_t len) {
+    if (len == 0) {
+        return IHS_VideoParamSetCount;
+    }
+    if (codec == IHS_StreamVideoCodecH264) {
+        uint8_t type = nal[0] & 0x1F;
+        switch (type) {
+            case 7:
+                return IHS_VideoParamSetSPS;
+            case 8:
+                return IHS_VideoParamSetPPS;
+            default:
+                return type >= 1 && type <= 5 ? -1 : IHS_VideoParamSetCount;
+        }
+    } else {
+        uint8_t type = (nal[0] >> 1) & 0x3F;
+        switch (type) {
+            case 32:
+                return IHS_VideoParamSetVPS;
+            case 33:
+                return IHS_VideoParamSetSPS;
+            case 34:
+                return IHS_VideoParamSetPPS;
+            default:
+                return type < 32 ? -1 : IHS_VideoParamSetCount;
+        }
+    }
+}
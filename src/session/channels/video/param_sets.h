@@ -0,0 +1,76 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ihslib/video.h"
+
+/**
+ * @file param_sets.h
+ * @brief Cache of codec parameter sets (VPS, SPS and PPS) seen in the video stream
+ */
+
+typedef enum IHS_VideoParamSetType {
+    IHS_VideoParamSetVPS,
+    IHS_VideoParamSetSPS,
+    IHS_VideoParamSetPPS,
+    IHS_VideoParamSetCount,
+} IHS_VideoParamSetType;
+
+typedef struct IHS_VideoParamSets {
+    IHS_StreamVideoCodec codec;
+    /**
+     * Latest NAL unit of each type, without start code
+     */
+    IHS_Buffer sets[IHS_VideoParamSetCount];
+    /**
+     * All cached parameter sets with start codes, in VPS, SPS, PPS order
+     */
+    IHS_Buffer data;
+} IHS_VideoParamSets;
+
+/**
+ * @param codec Only H264 and HEVC have parameter sets, other codecs will never change
+ */
+void IHS_VideoParamSetsInit(IHS_VideoParamSets *sets, IHS_StreamVideoCodec codec);
+
+void IHS_VideoParamSetsDeinit(IHS_VideoParamSets *sets);
+
+/**
+ * Parse parameter sets in front of an access unit, and update the cache.
+ * Scanning stops at the first slice, as parameter sets always precede it.
+ * @param data Access unit in Annex B format
+ * @return true if any parameter set has changed
+ */
+bool IHS_VideoParamSetsUpdate(IHS_VideoParamSets *sets, const uint8_t *data, size_t len);
+
+/**
+ * @return All cached parameter sets in Annex B format
+ */
+const IHS_Buffer *IHS_VideoParamSetsGetData(const IHS_VideoParamSets *sets);
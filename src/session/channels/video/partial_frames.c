@@ -25,107 +25,111 @@
 
 #include "partial_frames.h"
 
+#include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
-static IHS_VideoPartialFrame *NewNode(uint16_t frameId, const IHS_VideoFrameHeader *header, IHS_Buffer *data);
+#define PARTIAL_FRAMES_INITIAL_CAPACITY 32
 
-static void FreeNode(IHS_VideoPartialFrame *node);
+static IHS_VideoPartialFrame *Slot(const IHS_VideoPartialFrames *frames, size_t index);
+
+static void EnsureCapacity(IHS_VideoPartialFrames *frames);
 
 void IHS_VideoPartialFramesInit(IHS_VideoPartialFrames *frames) {
     memset(frames, 0, sizeof(IHS_VideoPartialFrames));
+    frames->capacity = PARTIAL_FRAMES_INITIAL_CAPACITY;
+    frames->items = calloc(frames->capacity, sizeof(IHS_VideoPartialFrame));
+}
+
+void IHS_VideoPartialFramesDeinit(IHS_VideoPartialFrames *frames) {
+    IHS_VideoPartialFramesClear(frames);
+    free(frames->items);
+    frames->items = NULL;
+    frames->capacity = 0;
 }
 
-IHS_VideoPartialFrame *IHS_VideoPartialFramesInsertBefore(IHS_VideoPartialFrames *frames, IHS_VideoPartialFrame *before,
-                                                          uint16_t frameId, const IHS_VideoFrameHeader *header,
-                                                          IHS_Buffer *data) {
-    assert (frames != NULL);
-    assert (before != NULL);
-    IHS_VideoPartialFrame *inserted = NewNode(frameId, header, data);
-
-    IHS_VideoPartialFrame *prev = before->prev;
-    if (prev == NULL) {
-        // Inserting to the start of the linked list
-        assert(frames->head == before);
-        frames->head = inserted;
-    } else {
-        prev->next = inserted;
+IHS_VideoPartialFrame *IHS_VideoPartialFramesAdd(IHS_VideoPartialFrames *frames, uint16_t frameId,
+                                                 const IHS_VideoFrameHeader *header, IHS_SessionSegmentedFrame *data) {
+    IHS_VideoPartialFrame *tail = IHS_VideoPartialFramesAt(frames, frames->count - 1);
+    if (tail == NULL || (int16_t) (frameId - tail->frameId) > 0) {
+        return IHS_VideoPartialFramesAppend(frames, frameId, header, data);
     }
-    before->prev = inserted;
+    for (size_t i = 0; i < frames->count; i++) {
+        const IHS_VideoPartialFrame *cur = Slot(frames, i);
+        if (frameId == cur->frameId && header->reserved2 < cur->header.reserved1) {
+            return IHS_VideoPartialFramesInsert(frames, i, frameId, header, data);
+        }
+    }
+    return IHS_VideoPartialFramesAppend(frames, frameId, header, data);
+}
 
-    inserted->prev = prev;
-    inserted->next = before;
+IHS_VideoPartialFrame *IHS_VideoPartialFramesInsert(IHS_VideoPartialFrames *frames, size_t index, uint16_t frameId,
+                                                    const IHS_VideoFrameHeader *header,
+                                                    IHS_SessionSegmentedFrame *data) {
+    assert(frames != NULL);
+    assert(index <= frames->count);
+    assert(header != NULL);
+    assert(data != NULL && data->count > 0);
+    EnsureCapacity(frames);
+    for (size_t i = frames->count; i > index; i--) {
+        *Slot(frames, i) = *Slot(frames, i - 1);
+    }
+    frames->count++;
+    IHS_VideoPartialFrame *inserted = Slot(frames, index);
+    inserted->frameId = frameId;
+    inserted->header = *header;
+    IHS_SessionSegmentedFrameMove(data, &inserted->data);
     return inserted;
 }
 
 IHS_VideoPartialFrame *IHS_VideoPartialFramesAppend(IHS_VideoPartialFrames *frames, uint16_t frameId,
-                                                    const IHS_VideoFrameHeader *header, IHS_Buffer *data) {
-    assert (frames != NULL);
-    IHS_VideoPartialFrame *inserted = NewNode(frameId, header, data);
-
-    IHS_VideoPartialFrame *oldHead = frames->head, *oldTail = frames->tail;
-    if (oldHead == NULL) {
-        // The frames must be empty
-        assert(oldTail == NULL);
-        frames->head = inserted;
-    }
-    if (oldTail != NULL) {
-        oldTail->next = inserted;
-        inserted->prev = oldTail;
-    }
-    frames->tail = inserted;
-    return inserted;
+                                                    const IHS_VideoFrameHeader *header,
+                                                    IHS_SessionSegmentedFrame *data) {
+    return IHS_VideoPartialFramesInsert(frames, frames->count, frameId, header, data);
 }
 
-void IHS_VideoPartialFramesRemove(IHS_VideoPartialFrames *frames, IHS_VideoPartialFrame *node) {
-    IHS_VideoPartialFrame *prev = node->prev;
-    IHS_VideoPartialFrame *next = node->next;
-    if (prev != NULL) {
-        prev->next = next;
-    } else {
-        frames->head = next;
+IHS_VideoPartialFrame *IHS_VideoPartialFramesAt(const IHS_VideoPartialFrames *frames, size_t index) {
+    if (index >= frames->count) {
+        return NULL;
     }
-    if (next != NULL) {
-        next->prev = prev;
-    } else {
-        frames->tail = prev;
-    }
-    free(node);
+    return Slot(frames, index);
+}
+
+void IHS_VideoPartialFramesRemoveHead(IHS_VideoPartialFrames *frames) {
+    assert(frames->count > 0);
+    IHS_SessionSegmentedFrameClear(&Slot(frames, 0)->data);
+    frames->head = (frames->head + 1) & (frames->capacity - 1);
+    frames->count--;
 }
 
 size_t IHS_VideoPartialFramesCount(const IHS_VideoPartialFrames *frames) {
-    size_t count = 0;
-    IHS_VideoPartialFrame *cur;
-    IHS_VideoPartialFramesForEach(cur, frames) {
-        count++;
-    }
-    return count;
+    return frames->count;
 }
 
 size_t IHS_VideoPartialFramesClear(IHS_VideoPartialFrames *frames) {
-    size_t count = 0;
-    for (IHS_VideoPartialFrame *cur = frames->head; cur != NULL;) {
-        IHS_VideoPartialFrame *next = cur->next;
-        FreeNode(cur);
-        cur = next;
-        count += 1;
+    size_t count = frames->count;
+    while (frames->count > 0) {
+        IHS_VideoPartialFramesRemoveHead(frames);
     }
-    frames->head = NULL;
-    frames->tail = NULL;
+    frames->head = 0;
     return count;
 }
 
-static IHS_VideoPartialFrame *NewNode(uint16_t frameId, const IHS_VideoFrameHeader *header, IHS_Buffer *data) {
-    assert(header != NULL);
-    assert(data != NULL && data->data != NULL);
-    IHS_VideoPartialFrame *node = calloc(1, sizeof(IHS_VideoPartialFrame));
-    node->frameId = frameId;
-    node->header = *header;
-    IHS_BufferTransferOwnership(data, &node->data);
-    return node;
+static IHS_VideoPartialFrame *Slot(const IHS_VideoPartialFrames *frames, size_t index) {
+    return &frames->items[(frames->head + index) & (frames->capacity - 1)];
 }
 
-static void FreeNode(IHS_VideoPartialFrame *node) {
-    assert(node != NULL);
-    IHS_BufferClear(&node->data, true);
-    free(node);
-}
\ No newline at end of file
+static void EnsureCapacity(IHS_VideoPartialFrames *frames) {
+    if (frames->count < frames->capacity) {
+        return;
+    }
+    size_t capacity = frames->capacity ? frames->capacity * 2 : PARTIAL_FRAMES_INITIAL_CAPACITY;
+    IHS_VideoPartialFrame *items = calloc(capacity, sizeof(IHS_VideoPartialFrame));
+    for (size_t i = 0; i < frames->count; i++) {
+        items[i] = *Slot(frames, i);
+    }
+    free(frames->items);
+    frames->items = items;
+    frames->capacity = capacity;
+    frames->head = 0;
+}
@@ -26,6 +26,7 @@
 #pragma once
 
 #include "ch_data_video.h"
+#include "session/frame.h"
 
 #include <stddef.h>
 #include <stdint.h>
@@ -33,29 +34,66 @@
 typedef struct IHS_VideoPartialFrame {
     uint16_t frameId;
     IHS_VideoFrameHeader header;
-    IHS_Buffer data;
-    struct IHS_VideoPartialFrame *prev;
-    struct IHS_VideoPartialFrame *next;
+    IHS_SessionSegmentedFrame data;
 } IHS_VideoPartialFrame;
 
+/**
+ * Ring of partial frames in assembling order. Storage is preallocated and only grows when the ring is full,
+ * so no allocation happens per data frame.
+ */
 typedef struct IHS_SessionVideoPartialFrames {
-    IHS_VideoPartialFrame *head;
-    IHS_VideoPartialFrame *tail;
+    IHS_VideoPartialFrame *items;
+    /**
+     * Always power of 2
+     */
+    size_t capacity;
+    size_t head;
+    size_t count;
 } IHS_VideoPartialFrames;
 
 void IHS_VideoPartialFramesInit(IHS_VideoPartialFrames *frames);
 
-IHS_VideoPartialFrame *IHS_VideoPartialFramesInsertBefore(IHS_VideoPartialFrames *frames, IHS_VideoPartialFrame *before,
-                                                          uint16_t frameId, const IHS_VideoFrameHeader *header,
-                                                          IHS_Buffer *data);
+/**
+ * Clear all partial frames, and free the storage
+ */
+void IHS_VideoPartialFramesDeinit(IHS_VideoPartialFrames *frames);
+
+/**
+ * Add data frame in assembling order. Data frames usually come with increasing frame ID, and will be appended
+ * directly. Otherwise, it will be placed before the first frame with same ID and greater reserved1.
+ * @param data Data frame body. Segments will be moved to the partial frame
+ * @return Added partial frame. It's only valid until next modification.
+ */
+IHS_VideoPartialFrame *IHS_VideoPartialFramesAdd(IHS_VideoPartialFrames *frames, uint16_t frameId,
+                                                 const IHS_VideoFrameHeader *header, IHS_SessionSegmentedFrame *data);
+
+/**
+ * Insert partial frame at given position
+ * @param index Position in the ring, 0 for head, and count for tail
+ * @return Inserted partial frame. It's only valid until next modification.
+ */
+IHS_VideoPartialFrame *IHS_VideoPartialFramesInsert(IHS_VideoPartialFrames *frames, size_t index, uint16_t frameId,
+                                                    const IHS_VideoFrameHeader *header,
+                                                    IHS_SessionSegmentedFrame *data);
 
 IHS_VideoPartialFrame *IHS_VideoPartialFramesAppend(IHS_VideoPartialFrames *frames, uint16_t frameId,
-                                                    const IHS_VideoFrameHeader *header, IHS_Buffer *data);
+                                                    const IHS_VideoFrameHeader *header,
+                                                    IHS_SessionSegmentedFrame *data);
 
-void IHS_VideoPartialFramesRemove(IHS_VideoPartialFrames *frames, IHS_VideoPartialFrame *node);
+/**
+ * @return Partial frame at position, or NULL if out of range
+ */
+IHS_VideoPartialFrame *IHS_VideoPartialFramesAt(const IHS_VideoPartialFrames *frames, size_t index);
+
+/**
+ * Remove the head partial frame, and release its data
+ */
+void IHS_VideoPartialFramesRemoveHead(IHS_VideoPartialFrames *frames);
 
 size_t IHS_VideoPartialFramesCount(const IHS_VideoPartialFrames *frames);
 
+/**
+ * Clear all partial frames. Storage will be kept for reuse.
+ * @return Number of cleared frames
+ */
 size_t IHS_VideoPartialFramesClear(IHS_VideoPartialFrames *frames);
-
-#define IHS_VideoPartialFramesForEach(a, b) for((a) = (b)->head; (a) != NULL; (a) = (a)->next)
\ No newline at end of file
@@ -26,6 +26,8 @@
 #include "frame.h"
 
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 void IHS_SessionFrameBodyInitialize(IHS_Buffer *body, bool hasCrc) {
     IHS_BufferInit(body, 2048, 2048);
@@ -42,4 +44,95 @@ void IHS_SessionFrameBodyInitialize(IHS_Buffer *body, bool hasCrc) {
 
 void IHS_SessionFrameClear(IHS_SessionFrame *frame, bool freeData) {
     IHS_BufferClear(&frame->body, freeData);
-}
\ No newline at end of file
+}
+
+void IHS_SessionSegmentedFrameInit(IHS_SessionSegmentedFrame *frame, IHS_BufferPool *pool) {
+    memset(frame, 0, sizeof(IHS_SessionSegmentedFrame));
+    frame->pool = pool;
+}
+
+void IHS_SessionSegmentedFrameAppend(IHS_SessionSegmentedFrame *frame, IHS_Buffer *segment) {
+    if (frame->count == frame->capacity) {
+        frame->capacity = frame->capacity ? frame->capacity * 2 : 16;
+        frame->segments = realloc(frame->segments, frame->capacity * sizeof(IHS_Buffer));
+    }
+    IHS_Buffer *dest = &frame->segments[frame->count++];
+    IHS_BufferTransferOwnership(segment, dest);
+    frame->size += dest->size;
+}
+
+void IHS_SessionSegmentedFrameMove(IHS_SessionSegmentedFrame *frame, IHS_SessionSegmentedFrame *to) {
+    assert(frame != to);
+    *to = *frame;
+    IHS_SessionSegmentedFrameInit(frame, to->pool);
+}
+
+size_t IHS_SessionSegmentedFrameCopy(const IHS_SessionSegmentedFrame *frame, size_t offset, uint8_t *out,
+                                     size_t len) {
+    size_t copied = 0;
+    for (size_t i = 0; i < frame->count && copied < len; i++) {
+        const IHS_Buffer *segment = &frame->segments[i];
+        if (offset >= segment->size) {
+            offset -= segment->size;
+            continue;
+        }
+        size_t copyLen = segment->size - offset;
+        if (copyLen > len - copied) {
+            copyLen = len - copied;
+        }
+        memcpy(out + copied, IHS_BufferPointerAt(segment, offset), copyLen);
+        copied += copyLen;
+        offset = 0;
+    }
+    return copied;
+}
+
+void IHS_SessionSegmentedFrameOffsetBy(IHS_SessionSegmentedFrame *frame, size_t len) {
+    assert(len <= frame->size);
+    frame->size -= len;
+    for (size_t i = 0; i < frame->count && len > 0; i++) {
+        IHS_Buffer *segment = &frame->segments[i];
+        size_t skip = segment->size < len ? segment->size : len;
+        IHS_BufferOffsetBy(segment, (int) skip);
+        len -= skip;
+    }
+}
+
+IHS_Buffer *IHS_SessionSegmentedFrameFlatten(IHS_SessionSegmentedFrame *frame) {
+    if (frame->count == 0) {
+        return NULL;
+    }
+    if (frame->count > 1) {
+        IHS_Buffer merged;
+        // Merged buffer will be recycled with the frame, so take it from the pool as well if it fits
+        if (frame->pool != NULL && frame->size <= IHS_BufferPoolGetBufferSize(frame->pool)) {
+            IHS_BufferPoolObtain(frame->pool, &merged);
+        } else {
+            IHS_BufferInit(&merged, 0, 0);
+            IHS_BufferEnsureMaxSizeExact(&merged, frame->size);
+        }
+        merged.size = IHS_SessionSegmentedFrameCopy(frame, 0, IHS_BufferPointer(&merged), frame->size);
+        IHS_SessionSegmentedFrameRelease(frame);
+        IHS_SessionSegmentedFrameAppend(frame, &merged);
+    }
+    return &frame->segments[0];
+}
+
+void IHS_SessionSegmentedFrameRelease(IHS_SessionSegmentedFrame *frame) {
+    for (size_t i = 0; i < frame->count; i++) {
+        if (frame->pool != NULL) {
+            IHS_BufferPoolRecycle(frame->pool, &frame->segments[i]);
+        } else {
+            IHS_BufferClear(&frame->segments[i], true);
+        }
+    }
+    frame->count = 0;
+    frame->size = 0;
+}
+
+void IHS_SessionSegmentedFrameClear(IHS_SessionSegmentedFrame *frame) {
+    IHS_SessionSegmentedFrameRelease(frame);
+    free(frame->segments);
+    frame->segments = NULL;
+    frame->capacity = 0;
+}
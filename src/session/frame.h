@@ -30,6 +30,7 @@
 
 #include "packet.h"
 #include "ihs_buffer.h"
+#include "ihs_buffer_pool.h"
 
 typedef struct IHS_Session IHS_Session;
 
@@ -41,6 +42,25 @@ typedef struct IHS_SessionFrame {
 #endif
 } IHS_SessionFrame, IHS_SessionWindowItem;
 
+/**
+ * Frame that references fragment bodies instead of copying them into one buffer.
+ * Every segment owns its data, and will be returned to the pool on release.
+ */
+typedef struct IHS_SessionSegmentedFrame {
+    IHS_SessionPacketHeader header;
+    IHS_Buffer *segments;
+    size_t count;
+    size_t capacity;
+    /**
+     * Total bytes of all segments
+     */
+    size_t size;
+    /**
+     * Pool to return segment buffers to. If NULL, buffers will be freed.
+     */
+    IHS_BufferPool *pool;
+} IHS_SessionSegmentedFrame;
+
 typedef enum IHS_SessionFrameDecryptResult {
     IHS_SessionFrameDecryptOK = 0,
     /* Not normal state but can be ignored */
@@ -60,12 +80,71 @@ void IHS_SessionFrameBodyInitialize(IHS_Buffer *body, bool hasCrc);
 
 void IHS_SessionFrameClear(IHS_SessionFrame *frame, bool freeData);
 
+void IHS_SessionSegmentedFrameInit(IHS_SessionSegmentedFrame *frame, IHS_BufferPool *pool);
+
+/**
+ * Append a segment to the frame
+ * @param frame Frame instance
+ * @param segment Buffer to take ownership of. It will be released after this call.
+ */
+void IHS_SessionSegmentedFrameAppend(IHS_SessionSegmentedFrame *frame, IHS_Buffer *segment);
+
+/**
+ * Move all segments to another frame. The source frame will be empty afterwards.
+ */
+void IHS_SessionSegmentedFrameMove(IHS_SessionSegmentedFrame *frame, IHS_SessionSegmentedFrame *to);
+
+/**
+ * Copy bytes across segments into contiguous memory
+ * @param offset Offset from the start of the frame
+ * @return Number of bytes copied
+ */
+size_t IHS_SessionSegmentedFrameCopy(const IHS_SessionSegmentedFrame *frame, size_t offset, uint8_t *out,
+                                     size_t len);
+
+/**
+ * Skip leading bytes, like IHS_BufferOffsetBy
+ */
+void IHS_SessionSegmentedFrameOffsetBy(IHS_SessionSegmentedFrame *frame, size_t len);
+
+/**
+ * Merge all segments into one, so the frame data can be accessed as contiguous memory.
+ * Nothing will be copied if the frame has only one segment.
+ * @return The only segment of the frame, or NULL if the frame is empty
+ */
+IHS_Buffer *IHS_SessionSegmentedFrameFlatten(IHS_SessionSegmentedFrame *frame);
+
+/**
+ * Return all segments to the pool. The frame can be reused afterwards.
+ */
+void IHS_SessionSegmentedFrameRelease(IHS_SessionSegmentedFrame *frame);
+
+/**
+ * Release all segments, and free the segments array
+ */
+void IHS_SessionSegmentedFrameClear(IHS_SessionSegmentedFrame *frame);
+
 /*
  * Encrypt/decrypt functions
  */
 
-int IHS_SessionFrameEncrypt(IHS_Session *session, const uint8_t *in, size_t inLen, uint8_t *out, size_t *outLen,
-                            uint64_t sequence);
+bool IHS_SessionFrameCryptoInit(IHS_Session *session);
+
+void IHS_SessionFrameCryptoDeinit(IHS_Session *session);
+
+/**
+ * HMAC and sequence number in front of the message in an encrypted frame
+ */
+#define IHS_SESSION_FRAME_ENCRYPT_HEADER_SIZE (16 + sizeof(uint64_t))
+
+/**
+ * Encrypt a message where it is, so it doesn't need to be copied.
+ * @param data Encrypted payload. Message must be placed at data + IHS_SESSION_FRAME_ENCRYPT_HEADER_SIZE.
+ * @param len Length of the message, will be set to length of the encrypted payload
+ * @param capacity Size of memory at data, must have room for padding
+ */
+int IHS_SessionFrameEncryptInPlace(IHS_Session *session, uint8_t *data, size_t *len, size_t capacity,
+                                   uint64_t sequence);
 
 IHS_SessionFrameDecryptResult IHS_SessionFrameDecrypt(IHS_Session *session, const IHS_Buffer *in, IHS_Buffer *out,
                                                       uint64_t expectSequence, uint64_t *actualSequence);
@@ -24,7 +24,6 @@
  */
 
 #include <stdlib.h>
-#include <mbedtls/md.h>
 
 #include "frame.h"
 #include "endianness.h"
@@ -32,60 +31,88 @@
 
 #include "session_pri.h"
 
-int IHS_SessionFrameEncrypt(IHS_Session *session, const uint8_t *in, size_t inLen, uint8_t *out, size_t *outLen,
-                            uint64_t sequence) {
-    int ret;
-
-    size_t plainLen = sizeof(uint64_t) + inLen;
-    uint8_t *plain = malloc(plainLen);
-    IHS_WriteUInt64LE(plain, sequence);
-    memcpy(&plain[sizeof(uint64_t)], in, inLen);
-
-    const mbedtls_md_info_t *md = mbedtls_md_info_from_type(MBEDTLS_MD_MD5);
-    uint8_t *iv = out;
-    unsigned char ivLen = mbedtls_md_get_size(md);
+#define FRAME_HMAC_SIZE 16
 
+bool IHS_SessionFrameCryptoInit(IHS_Session *session) {
     const uint8_t *key = session->info.sessionKey;
     const size_t keyLen = session->info.sessionKeyLen;
+    session->crypto.cipher = IHS_CryptoCipherCreate(key, keyLen);
+    session->crypto.hmac = IHS_CryptoHMACCreate(IHS_CryptoHMACMD5, key, keyLen);
+    session->crypto.hmacLock = IHS_MutexCreate();
+    return session->crypto.cipher != NULL && session->crypto.hmac != NULL;
+}
 
-    if ((ret = mbedtls_md_hmac(md, key, keyLen, plain, plainLen, iv)) != 0) {
-        goto exit;
+void IHS_SessionFrameCryptoDeinit(IHS_Session *session) {
+    if (session->crypto.cipher != NULL) {
+        IHS_CryptoCipherDestroy(session->crypto.cipher);
+        session->crypto.cipher = NULL;
+    }
+    if (session->crypto.hmac != NULL) {
+        IHS_CryptoHMACDestroy(session->crypto.hmac);
+        session->crypto.hmac = NULL;
     }
+    if (session->crypto.hmacLock != NULL) {
+        IHS_MutexDestroy(session->crypto.hmacLock);
+        session->crypto.hmacLock = NULL;
+    }
+}
 
-    size_t encLen = *outLen - ivLen;
-    if ((ret = IHS_CryptoSymmetricEncryptWithIV(plain, plainLen, iv, ivLen, key, keyLen, false,
-                                                &out[ivLen], &encLen)) != 0) {
-        goto exit;
+int IHS_SessionFrameEncryptInPlace(IHS_Session *session, uint8_t *data, size_t *len, size_t capacity,
+                                   uint64_t sequence) {
+    int ret;
+    assert(capacity >= IHS_SESSION_FRAME_ENCRYPT_HEADER_SIZE + *len);
+    if (session->crypto.cipher == NULL || session->crypto.hmac == NULL) {
+        return -1;
     }
-    *outLen = ivLen + encLen;
-    exit:
-    free(plain);
-    return ret;
+
+    /* HMAC is used as IV, and covers sequence number followed by the message */
+    uint8_t *iv = data;
+    const size_t ivLen = FRAME_HMAC_SIZE;
+    uint8_t *plain = &data[ivLen];
+    size_t plainLen = sizeof(uint64_t) + *len;
+    IHS_WriteUInt64LE(plain, sequence);
+
+    IHS_MutexLock(session->crypto.hmacLock);
+    ret = IHS_CryptoHMACCompute(session->crypto.hmac, plain, plainLen, iv);
+    IHS_MutexUnlock(session->crypto.hmacLock);
+    if (ret != 0) {
+        return ret;
+    }
+
+    size_t encLen = plainLen;
+    if ((ret = IHS_CryptoCipherEncryptInPlace(session->crypto.cipher, plain, &encLen, capacity - ivLen, iv,
+                                              ivLen)) != 0) {
+        return ret;
+    }
+    *len = ivLen + encLen;
+    return 0;
 }
 
 IHS_SessionFrameDecryptResult IHS_SessionFrameDecrypt(IHS_Session *session, const IHS_Buffer *in, IHS_Buffer *out,
                                                       uint64_t expectSequence, uint64_t *actualSequence) {
-    const uint8_t *key = session->info.sessionKey;
-    const size_t keyLen = session->info.sessionKeyLen;
     IHS_SessionFrameDecryptResult result = IHS_SessionFrameDecryptFailed;
+    if (session->crypto.cipher == NULL || session->crypto.hmac == NULL) {
+        return result;
+    }
     IHS_BufferEnsureMaxSizeExact(out, in->size);
     size_t outLen = IHS_BufferMaxSize(out);
-    if (IHS_CryptoSymmetricDecryptWithIV(IHS_BufferPointerAt(in, 16), in->size - 16,
-                                         IHS_BufferPointerAt(in, 0), 16, key, keyLen,
-                                         IHS_BufferPointerAt(out, 0), &outLen) != 0) {
+    if (IHS_CryptoCipherDecryptWithIV(session->crypto.cipher, IHS_BufferPointerAt(in, 16), in->size - 16,
+                                      IHS_BufferPointerAt(in, 0), 16, IHS_BufferPointerAt(out, 0), &outLen) != 0) {
         goto exit;
     }
     out->size = outLen;
 
-    const mbedtls_md_info_t *md = mbedtls_md_info_from_type(MBEDTLS_MD_MD5);
-    uint8_t hash[16];
+    uint8_t hash[FRAME_HMAC_SIZE];
     int hmacRet;
-    if ((hmacRet = mbedtls_md_hmac(md, key, keyLen, IHS_BufferPointerAt(out, 0), out->size, hash)) != 0) {
+    IHS_MutexLock(session->crypto.hmacLock);
+    hmacRet = IHS_CryptoHMACCompute(session->crypto.hmac, IHS_BufferPointerAt(out, 0), out->size, hash);
+    IHS_MutexUnlock(session->crypto.hmacLock);
+    if (hmacRet != 0) {
         result = IHS_SessionFrameDecryptFailed;
         IHS_SessionLog(session, IHS_LogLevelWarn, "Crypto", "HMAC failed: %x\n", -hmacRet);
         goto exit;
     }
-    if (memcmp(hash, IHS_BufferPointerAt(in, 0), 16) != 0) {
+    if (memcmp(hash, IHS_BufferPointerAt(in, 0), FRAME_HMAC_SIZE) != 0) {
         result = IHS_SessionFrameDecryptHashMismatch;
         IHS_SessionLog(session, IHS_LogLevelWarn, "Crypto", "HMAC mismatch\n");
         goto exit;
@@ -109,17 +136,22 @@ IHS_SessionFrameDecryptResult IHS_SessionFrameDecrypt(IHS_Session *session, cons
 }
 
 int IHS_SessionFrameHMACSHA256(IHS_Session *session, const uint8_t *in, size_t inLen, uint8_t *out, size_t *outLen) {
-    const mbedtls_md_info_t *md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
-    unsigned char mdSize = mbedtls_md_get_size(md);
+    /* Only used once for authentication, so no need to keep the context */
+    IHS_CryptoHMAC *hmac = IHS_CryptoHMACCreate(IHS_CryptoHMACSHA256, session->info.sessionKey,
+                                                session->info.sessionKeyLen);
+    if (hmac == NULL) {
+        return -1;
+    }
+    int ret = -1;
+    size_t mdSize = IHS_CryptoHMACSize(hmac);
     if (*outLen < mdSize) {
-        return MBEDTLS_ERR_MD_BAD_INPUT_DATA;
+        goto exit;
     }
-    const uint8_t *key = session->info.sessionKey;
-    const size_t keyLen = session->info.sessionKeyLen;
-    int ret;
-    if ((ret = mbedtls_md_hmac(md, key, keyLen, in, inLen, out)) != 0) {
-        return ret;
+    if ((ret = IHS_CryptoHMACCompute(hmac, in, inLen, out)) != 0) {
+        goto exit;
     }
     *outLen = mdSize;
+    exit:
+    IHS_CryptoHMACDestroy(hmac);
     return ret;
-}
\ No newline at end of file
+}
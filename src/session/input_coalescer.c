@@ -0,0 +1,158 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "input_coalescer.h"
+#include "ihs_thread.h"
+
+/* Mouse motion, and one motion for each finger on screen */
+#define COALESCER_MAX_PENDING 16
+
+struct IHS_InputCoalescer {
+    IHS_Mutex *lock;
+    IHS_Timer *timer;
+    IHS_InputCoalescerFlushFunction *flush;
+    void *context;
+    uint32_t interval;
+    /**
+     * Pending motion in the order they first appeared
+     */
+    IHS_InputMotion pending[COALESCER_MAX_PENDING];
+    int numPending;
+    /**
+     * Set while there is pending motion, cleared by the task once it flushed them
+     */
+    IHS_TimerTask *task;
+};
+
+static bool CoalescerMerge(IHS_InputCoalescer *coalescer, const IHS_InputMotion *motion);
+
+static void CoalescerFlush(IHS_InputCoalescer *coalescer);
+
+static uint64_t CoalescerTimerRun(int runCount, void *context);
+
+IHS_InputCoalescer *IHS_InputCoalescerCreate(IHS_Timer *timer, IHS_InputCoalescerFlushFunction *flush,
+                                             void *context) {
+    IHS_InputCoalescer *coalescer = calloc(1, sizeof(IHS_InputCoalescer));
+    coalescer->lock = IHS_MutexCreate();
+    coalescer->timer = timer;
+    coalescer->flush = flush;
+    coalescer->context = context;
+    return coalescer;
+}
+
+void IHS_InputCoalescerDestroy(IHS_InputCoalescer *coalescer) {
+    IHS_MutexDestroy(coalescer->lock);
+    free(coalescer);
+}
+
+void IHS_InputCoalescerSetInterval(IHS_InputCoalescer *coalescer, uint32_t interval) {
+    IHS_MutexLock(coalescer->lock);
+    coalescer->interval = interval;
+    if (interval == 0) {
+        CoalescerFlush(coalescer);
+    }
+    IHS_MutexUnlock(coalescer->lock);
+}
+
+bool IHS_InputCoalescerAdd(IHS_InputCoalescer *coalescer, const IHS_InputMotion *motion) {
+    IHS_MutexLock(coalescer->lock);
+    if (coalescer->interval == 0) {
+        IHS_MutexUnlock(coalescer->lock);
+        return false;
+    }
+    if (!CoalescerMerge(coalescer, motion)) {
+        if (coalescer->numPending == COALESCER_MAX_PENDING) {
+            CoalescerFlush(coalescer);
+        }
+        coalescer->pending[coalescer->numPending++] = *motion;
+    }
+    if (coalescer->task == NULL) {
+        coalescer->task = IHS_TimerTaskStart(coalescer->timer, CoalescerTimerRun, NULL, coalescer->interval,
+                                             coalescer);
+    }
+    IHS_MutexUnlock(coalescer->lock);
+    return true;
+}
+
+void IHS_InputCoalescerFlushAndHold(IHS_InputCoalescer *coalescer) {
+    IHS_MutexLock(coalescer->lock);
+    CoalescerFlush(coalescer);
+}
+
+void IHS_InputCoalescerRelease(IHS_InputCoalescer *coalescer) {
+    IHS_MutexUnlock(coalescer->lock);
+}
+
+/**
+ * Relative and absolute mouse motion are only merged into the latest mouse motion of the same type, so their order
+ * is kept. Touch positions are merged per finger.
+ */
+static bool CoalescerMerge(IHS_InputCoalescer *coalescer, const IHS_InputMotion *motion) {
+    for (int i = coalescer->numPending - 1; i >= 0; i--) {
+        IHS_InputMotion *pending = &coalescer->pending[i];
+        if (motion->type == IHS_InputMotionTouch) {
+            if (pending->type == IHS_InputMotionTouch && pending->fingerId == motion->fingerId) {
+                pending->x = motion->x;
+                pending->y = motion->y;
+                return true;
+            }
+            continue;
+        } else if (pending->type == IHS_InputMotionTouch) {
+            continue;
+        }
+        if (pending->type != motion->type) {
+            return false;
+        }
+        if (motion->type == IHS_InputMotionRelative) {
+            pending->dx += motion->dx;
+            pending->dy += motion->dy;
+        } else {
+            pending->x = motion->x;
+            pending->y = motion->y;
+        }
+        return true;
+    }
+    return false;
+}
+
+static void CoalescerFlush(IHS_InputCoalescer *coalescer) {
+    for (int i = 0; i < coalescer->numPending; i++) {
+        coalescer->flush(&coalescer->pending[i], coalescer->context);
+    }
+    coalescer->numPending = 0;
+}
+
+static uint64_t CoalescerTimerRun(int runCount, void *context) {
+    (void) runCount;
+    IHS_InputCoalescer *coalescer = context;
+    IHS_MutexLock(coalescer->lock);
+    CoalescerFlush(coalescer);
+    coalescer->task = NULL;
+    IHS_MutexUnlock(coalescer->lock);
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ihs_timer.h"
+
+/**
+ * @file input_coalescer.h
+ * @brief Merge mouse and touch motion between ticks, so fewer control messages are sent
+ * @note This object is thread safe
+ */
+
+typedef struct IHS_InputCoalescer IHS_InputCoalescer;
+
+typedef enum IHS_InputMotionType {
+    IHS_InputMotionRelative,
+    IHS_InputMotionAbsolute,
+    IHS_InputMotionTouch,
+} IHS_InputMotionType;
+
+typedef struct IHS_InputMotion {
+    IHS_InputMotionType type;
+    /**
+     * Mouse movement, for relative motion
+     */
+    int dx, dy;
+    /**
+     * Normalized position, for absolute and touch motion
+     */
+    float x, y;
+    uint64_t fingerId;
+} IHS_InputMotion;
+
+/**
+ * Called with the coalescer locked, for every pending motion in order
+ */
+typedef void (IHS_InputCoalescerFlushFunction)(const IHS_InputMotion *motion, void *context);
+
+IHS_InputCoalescer *IHS_InputCoalescerCreate(IHS_Timer *timer, IHS_InputCoalescerFlushFunction *flush,
+                                             void *context);
+
+/**
+ * Pending motion will be discarded. Timer tasks must have been ended before calling this.
+ */
+void IHS_InputCoalescerDestroy(IHS_InputCoalescer *coalescer);
+
+/**
+ * @param interval Milliseconds between flushes. 0 disables coalescing, and flushes pending motion.
+ */
+void IHS_InputCoalescerSetInterval(IHS_InputCoalescer *coalescer, uint32_t interval);
+
+/**
+ * @return true if the motion is held for next flush, false if coalescing is disabled and it should be sent now
+ */
+bool IHS_InputCoalescerAdd(IHS_InputCoalescer *coalescer, const IHS_InputMotion *motion);
+
+/**
+ * Flush pending motion, and keep the coalescer locked until IHS_InputCoalescerRelease.
+ * Events sent in between are guaranteed to go after motion that happened before them.
+ */
+void IHS_InputCoalescerFlushAndHold(IHS_InputCoalescer *coalescer);
+
+void IHS_InputCoalescerRelease(IHS_InputCoalescer *coalescer);
@@ -133,4 +133,10 @@ uint32_t IHS_SessionPacketTimestamp() {
     uint64_t nsec = tp.tv_nsec * 65536 / 1000000000;
     uint32_t sec = tp.tv_sec * 65536;
     return sec + nsec;
+}
+
+uint32_t IHS_SessionPacketTimestampFromMicros(uint64_t micros) {
+    uint64_t usec = (micros % 1000000) * 65536 / 1000000;
+    uint32_t sec = (micros / 1000000) * 65536;
+    return sec + usec;
 }
\ No newline at end of file
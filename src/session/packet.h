@@ -92,6 +92,8 @@ typedef struct IHS_SessionPacket {
 
 #define IHS_SESSION_PACKET_TIMESTAMP_TO_MILLIS(diff) ((uint32_t) (((uint64_t) (diff)) * 1000 / 65536))
 
+#define IHS_SESSION_PACKET_TIMESTAMP_TO_MICROS(diff) ((uint32_t) (((uint64_t) (diff)) * 1000000 / 65536))
+
 /**
  * Parse packet from source buffer
  * @param header Packet header
@@ -136,4 +138,10 @@ size_t IHS_SessionPacketSize(const IHS_SessionPacket *packet);
 
 void IHS_SessionPacketClear(IHS_SessionPacket *packet, bool freeData);
 
-uint32_t IHS_SessionPacketTimestamp();
\ No newline at end of file
+uint32_t IHS_SessionPacketTimestamp();
+
+/**
+ * Convert time on monotonic clock to the same units as IHS_SessionPacketTimestamp
+ * @param micros Microseconds of CLOCK_MONOTONIC
+ */
+uint32_t IHS_SessionPacketTimestampFromMicros(uint64_t micros);
\ No newline at end of file
@@ -0,0 +1,185 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "playout.h"
+#include "ihs_thread.h"
+
+#include <stdlib.h>
+
+/* Complete frames are held for this many times of the jitter */
+#define JITTER_HOLD_FACTOR 2
+/* Minimum transit time is tracked over 2 windows, so clock drift between peers won't accumulate */
+#define BASE_TRANSIT_WINDOW 2000
+
+struct IHS_SessionPlayout {
+    IHS_Mutex *lock;
+    uint32_t targetLatency;
+    bool started;
+    uint32_t lastTimestamp;
+    /**
+     * Send timestamp extended to 64 bits, so it won't wrap around
+     */
+    int64_t lastTicks;
+    int64_t lastTransit;
+    struct {
+        int64_t current;
+        int64_t previous;
+        uint64_t windowStart;
+    } baseTransit;
+    uint32_t jitter;
+    struct {
+        uint64_t framesIncomplete;
+        uint64_t framesLate;
+    } stats;
+};
+
+static int64_t TimestampToMicros(const IHS_SessionPlayout *playout, uint32_t timestamp);
+
+static uint32_t MicrosToWaitMillis(int64_t micros);
+
+IHS_SessionPlayout *IHS_SessionPlayoutCreate() {
+    IHS_SessionPlayout *playout = calloc(1, sizeof(IHS_SessionPlayout));
+    playout->lock = IHS_MutexCreate();
+    return playout;
+}
+
+void IHS_SessionPlayoutDestroy(IHS_SessionPlayout *playout) {
+    IHS_MutexDestroy(playout->lock);
+    free(playout);
+}
+
+void IHS_SessionPlayoutSetConfig(IHS_SessionPlayout *playout, const IHS_SessionPlayoutConfig *config) {
+    IHS_MutexLock(playout->lock);
+    playout->targetLatency = config->targetLatency;
+    IHS_MutexUnlock(playout->lock);
+}
+
+bool IHS_SessionPlayoutEnabled(IHS_SessionPlayout *playout) {
+    IHS_MutexLock(playout->lock);
+    bool enabled = playout->targetLatency > 0;
+    IHS_MutexUnlock(playout->lock);
+    return enabled;
+}
+
+void IHS_SessionPlayoutReset(IHS_SessionPlayout *playout) {
+    IHS_MutexLock(playout->lock);
+    playout->started = false;
+    playout->jitter = 0;
+    IHS_MutexUnlock(playout->lock);
+}
+
+void IHS_SessionPlayoutPacketArrived(IHS_SessionPlayout *playout, uint32_t timestamp, uint64_t now) {
+    IHS_MutexLock(playout->lock);
+    if (!playout->started) {
+        playout->lastTicks = timestamp;
+    } else {
+        playout->lastTicks += (int32_t) (timestamp - playout->lastTimestamp);
+    }
+    playout->lastTimestamp = timestamp;
+    int64_t transit = (int64_t) now * 1000 - TimestampToMicros(playout, timestamp);
+    if (!playout->started) {
+        playout->started = true;
+        playout->baseTransit.current = transit;
+        playout->baseTransit.previous = transit;
+        playout->baseTransit.windowStart = now;
+    } else {
+        /* Interarrival jitter, as in RFC 3550 */
+        int64_t d = transit - playout->lastTransit;
+        if (d < 0) d = -d;
+        playout->jitter = (uint32_t) ((int64_t) playout->jitter + (d - (int64_t) playout->jitter) / 16);
+        if (now - playout->baseTransit.windowStart >= BASE_TRANSIT_WINDOW) {
+            playout->baseTransit.previous = playout->baseTransit.current;
+            playout->baseTransit.current = transit;
+            playout->baseTransit.windowStart = now;
+        } else if (transit < playout->baseTransit.current) {
+            playout->baseTransit.current = transit;
+        }
+    }
+    playout->lastTransit = transit;
+    IHS_MutexUnlock(playout->lock);
+}
+
+IHS_SessionPlayoutAction IHS_SessionPlayoutSchedule(IHS_SessionPlayout *playout, uint32_t timestamp, bool complete,
+                                                    uint64_t now, uint32_t *waitMs) {
+    IHS_SessionPlayoutAction action;
+    IHS_MutexLock(playout->lock);
+    if (!playout->started) {
+        *waitMs = 0;
+        action = complete ? IHS_SessionPlayoutRelease : IHS_SessionPlayoutWait;
+        goto unlock;
+    }
+    int64_t baseTransit = playout->baseTransit.current;
+    if (playout->baseTransit.previous < baseTransit) {
+        baseTransit = playout->baseTransit.previous;
+    }
+    /* When the frame would have arrived without jitter */
+    int64_t arrival = TimestampToMicros(playout, timestamp) + baseTransit;
+    int64_t deadline = arrival + (int64_t) playout->targetLatency * 1000;
+    int64_t nowMicros = (int64_t) now * 1000;
+    if (nowMicros >= deadline) {
+        if (complete) {
+            playout->stats.framesLate++;
+        } else {
+            playout->stats.framesIncomplete++;
+        }
+        action = IHS_SessionPlayoutDrop;
+        goto unlock;
+    }
+    if (!complete) {
+        *waitMs = MicrosToWaitMillis(deadline - nowMicros);
+        action = IHS_SessionPlayoutWait;
+        goto unlock;
+    }
+    int64_t release = arrival + (int64_t) playout->jitter * JITTER_HOLD_FACTOR;
+    if (release > deadline) {
+        release = deadline;
+    }
+    if (nowMicros >= release) {
+        action = IHS_SessionPlayoutRelease;
+    } else {
+        *waitMs = MicrosToWaitMillis(release - nowMicros);
+        action = IHS_SessionPlayoutWait;
+    }
+    unlock:
+    IHS_MutexUnlock(playout->lock);
+    return action;
+}
+
+void IHS_SessionPlayoutGetStats(IHS_SessionPlayout *playout, IHS_SessionPlayoutStats *stats) {
+    IHS_MutexLock(playout->lock);
+    stats->jitter = playout->jitter;
+    stats->framesIncomplete = playout->stats.framesIncomplete;
+    stats->framesLate = playout->stats.framesLate;
+    IHS_MutexUnlock(playout->lock);
+}
+
+static int64_t TimestampToMicros(const IHS_SessionPlayout *playout, uint32_t timestamp) {
+    int64_t ticks = playout->lastTicks + (int32_t) (timestamp - playout->lastTimestamp);
+    /* Timestamp is in 1/65536 seconds */
+    return ticks * 1000000 / 65536;
+}
+
+static uint32_t MicrosToWaitMillis(int64_t micros) {
+    return (uint32_t) ((micros + 999) / 1000);
+}
@@ -0,0 +1,88 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ihslib/session.h"
+
+/**
+ * @file playout.h
+ * @brief Decide when a received frame should be handed to the decoder, based on packet send timestamps
+ * @note This object is thread safe
+ */
+
+typedef struct IHS_SessionPlayout IHS_SessionPlayout;
+
+typedef enum IHS_SessionPlayoutAction {
+    IHS_SessionPlayoutRelease,
+    IHS_SessionPlayoutWait,
+    IHS_SessionPlayoutDrop,
+} IHS_SessionPlayoutAction;
+
+typedef struct IHS_SessionPlayoutStats {
+    /**
+     * Interarrival jitter in microseconds
+     */
+    uint32_t jitter;
+    uint64_t framesIncomplete;
+    uint64_t framesLate;
+} IHS_SessionPlayoutStats;
+
+IHS_SessionPlayout *IHS_SessionPlayoutCreate();
+
+void IHS_SessionPlayoutDestroy(IHS_SessionPlayout *playout);
+
+void IHS_SessionPlayoutSetConfig(IHS_SessionPlayout *playout, const IHS_SessionPlayoutConfig *config);
+
+bool IHS_SessionPlayoutEnabled(IHS_SessionPlayout *playout);
+
+/**
+ * Forget timing of previous stream. Stats are kept.
+ */
+void IHS_SessionPlayoutReset(IHS_SessionPlayout *playout);
+
+/**
+ * Update jitter and transit time estimation
+ * @param playout Playout instance
+ * @param timestamp Send timestamp of the packet
+ * @param now Current time in milliseconds
+ */
+void IHS_SessionPlayoutPacketArrived(IHS_SessionPlayout *playout, uint32_t timestamp, uint64_t now);
+
+/**
+ * Decide what to do with the frame at head
+ * @param playout Playout instance
+ * @param timestamp Newest send timestamp of received packets of the frame
+ * @param complete Whether all packets of the frame are received
+ * @param now Current time in milliseconds
+ * @param waitMs Set when the action is IHS_SessionPlayoutWait. 0 means wait for next packet.
+ * @return Action to take. Dropped frames are counted in stats.
+ */
+IHS_SessionPlayoutAction IHS_SessionPlayoutSchedule(IHS_SessionPlayout *playout, uint32_t timestamp, bool complete,
+                                                    uint64_t now, uint32_t *waitMs);
+
+void IHS_SessionPlayoutGetStats(IHS_SessionPlayout *playout, IHS_SessionPlayoutStats *stats);
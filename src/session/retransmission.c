@@ -1,155 +1,395 @@
 /*
- *  _____  _   _  _____  _  _  _
- * |_   _|| | | |/  ___|| |(_)| |     Steam
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
  *   | |  | |_| |\ `--. | | _ | |__     In-Home
  *   | |  |  _  | `--. \| || || '_ \      Streaming
  *  _| |_ | | | |/\__/ /| || || |_) |       Library
  *  \___/ \_| |_/\____/ |_||_||_.__/
  *
  * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
- *
+ * 
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU Lesser General Public
  * License as published by the Free Software Foundation; either
  * version 3 of the License, or (at your option) any later version.
- *
+ * 
  * This program is distributed in the hope that it will be useful,
  * but WITHOUT ANY WARRANTY; without even the implied warranty of
  * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
  * Lesser General Public License for more details.
- *
+ * 
  * You should have received a copy of the GNU Lesser General Public License
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  *
  */
 
+#include <stdlib.h>
+
 #include "retransmission.h"
 #include "session_pri.h"
 
-#define RETRANSMISSION_INTERVAL 10
 #define RETRANSMISSION_ATTEMPTS 20
+#define RETRANSMISSION_INITIAL_CAPACITY 64
+/* Packets collected from the table before sending them, so the lock isn't held while queueing */
+#define RETRANSMISSION_BATCH_SIZE 32
+/* Keep the task alive while nothing is pending, a new packet will reschedule it */
+#define RETRANSMISSION_IDLE_INTERVAL 1000
 
-typedef struct IHS_QueueItem {
+struct IHS_RetransmissionEntry {
     IHS_SessionPacket packet;
-    IHS_TimerTask *task;
-    IHS_SessionRetransmission *retransmission;
-} PendingRetransmission;
-
-typedef struct RetransmissionQuery {
-    IHS_SessionChannelId channelId;
-    uint16_t packetId;
-    uint16_t fragmentId;
-} RetransmissionQuery;
-
-static void RetransmissionQueueItemDestroy(PendingRetransmission *item, void *context);
+    /**
+     * Packet timestamp of when the packet was sent
+     */
+    uint32_t sentAt;
+    /**
+     * Time in milliseconds to send the packet again
+     */
+    uint64_t deadline;
+    /**
+     * Class to queue the packet with when it's sent again
+     */
+    IHS_SessionSendClass sendClass;
+    /**
+     * Next free entry, when this entry is not used
+     */
+    int32_t next;
+    bool used;
+};
 
 static uint64_t RetransmissionTimerRun(int runCount, void *context);
 
 static void RetransmissionTimerEnd(void *context);
 
-static bool RetransmissionIdenticalPredicate(PendingRetransmission *item, void *context);
+static void RetransmissionGrow(IHS_SessionRetransmission *retransmission);
+
+static int32_t RetransmissionTake(IHS_SessionRetransmission *retransmission, IHS_SessionChannelId channelId,
+                                  uint16_t packetId, uint16_t fragmentId);
+
+static void RetransmissionRelease(IHS_SessionRetransmission *retransmission, int32_t index);
+
+static bool EarlyAckTake(IHS_SessionRetransmission *retransmission, const IHS_SessionPacketHeader *header);
 
-static bool RetransmissionPacketPredicate(PendingRetransmission *item, void *context);
+static void TableRebuild(IHS_SessionRetransmission *retransmission);
+
+static void TableInsert(IHS_SessionRetransmission *retransmission, int32_t index);
+
+static void TableRemoveAt(IHS_SessionRetransmission *retransmission, size_t pos);
+
+static inline size_t TableHome(const IHS_SessionRetransmission *retransmission, IHS_SessionChannelId channelId,
+                               uint16_t packetId, uint16_t fragmentId);
 
 void IHS_RetransmissionInit(IHS_SessionRetransmission *retransmission, IHS_Session *session) {
     retransmission->session = session;
     retransmission->lock = IHS_MutexCreate();
-    retransmission->queue = IHS_QueueCreate(sizeof(PendingRetransmission));
+    retransmission->entries = NULL;
+    retransmission->capacity = 0;
+    retransmission->count = 0;
+    retransmission->freeList = -1;
+    retransmission->table = NULL;
+    retransmission->tableSize = 0;
+    retransmission->task = NULL;
+    retransmission->nextRun = UINT64_MAX;
+    retransmission->sending = false;
+    retransmission->numEarlyAcks = 0;
+    IHS_SessionRTTInit(&retransmission->rtt);
+    RetransmissionGrow(retransmission);
 }
 
 void IHS_RetransmissionDeinit(IHS_SessionRetransmission *retransmission) {
     IHS_MutexLock(retransmission->lock);
-    IHS_QueueDestroy(retransmission->queue, RetransmissionQueueItemDestroy, retransmission);
+    IHS_TimerTask *task = retransmission->task;
     IHS_MutexUnlock(retransmission->lock);
+    // Task has been ended if session timers are destroyed
+    if (task != NULL) {
+        IHS_TimerTaskStopImmediate(task);
+    }
+    for (size_t i = 0; i < retransmission->capacity; i++) {
+        IHS_RetransmissionEntry *entry = &retransmission->entries[i];
+        if (entry->used) {
+            IHS_SessionPacketClear(&entry->packet, true);
+        }
+    }
+    free(retransmission->entries);
+    free(retransmission->table);
     IHS_MutexDestroy(retransmission->lock);
 }
 
-bool IHS_RetransmissionQueue(IHS_SessionRetransmission *retransmission, IHS_SessionPacket *packet) {
+bool IHS_RetransmissionQueue(IHS_SessionRetransmission *retransmission, IHS_SessionPacket *packet,
+                             IHS_SessionSendClass sendClass) {
     assert(packet->body.data != NULL);
     assert(packet->body.offset == IHS_PACKET_HEADER_SIZE);
     if (packet->header.retransmitCount >= RETRANSMISSION_ATTEMPTS) {
         return false;
     }
-    PendingRetransmission *pending = IHS_QueueItemObtain(retransmission->queue);
+    IHS_MutexLock(retransmission->lock);
+    // Host acknowledged it while it was being sent
+    if (EarlyAckTake(retransmission, &packet->header)) {
+        IHS_MutexUnlock(retransmission->lock);
+        IHS_SessionLog(retransmission->session, IHS_LogLevelVerbose, "Retransmission",
+                       "Packet(channelId=%u, packetId=%u, fragmentId=%u) acknowledged before queued",
+                       packet->header.channelId, packet->header.packetId, packet->header.fragmentId);
+        return false;
+    }
+    // Packet with the same ID is not acknowledged yet, the new one replaces it
+    int32_t existing = RetransmissionTake(retransmission, packet->header.channelId, packet->header.packetId,
+                                          packet->header.fragmentId);
+    if (existing >= 0) {
+        IHS_SessionPacketClear(&retransmission->entries[existing].packet, true);
+        RetransmissionRelease(retransmission, existing);
+    }
+    if (retransmission->freeList < 0) {
+        RetransmissionGrow(retransmission);
+    }
+    int32_t index = retransmission->freeList;
+    IHS_RetransmissionEntry *pending = &retransmission->entries[index];
+    retransmission->freeList = pending->next;
     pending->packet = *packet;
-    pending->retransmission = retransmission;
     pending->packet.header.retransmitCount++;
     IHS_BufferTransferOwnership(&packet->body, &pending->packet.body);
-    pending->task = IHS_TimerTaskStart(retransmission->session->timers, RetransmissionTimerRun, RetransmissionTimerEnd,
-                                       RETRANSMISSION_INTERVAL, pending);
-    IHS_MutexLock(retransmission->lock);
-    IHS_QueueAppend(retransmission->queue, pending);
+    pending->sentAt = IHS_SessionPacketTimestamp();
+    pending->sendClass = sendClass;
+    uint32_t timeout = IHS_SessionRTTTimeout(&retransmission->rtt, pending->packet.header.retransmitCount);
+    pending->deadline = IHS_TimerNow() + timeout;
+    pending->used = true;
+    TableInsert(retransmission, index);
+    retransmission->count++;
+
+    if (retransmission->task == NULL) {
+        retransmission->task = IHS_TimerTaskStart(retransmission->session->timers, RetransmissionTimerRun,
+                                                  RetransmissionTimerEnd, timeout, retransmission);
+        retransmission->nextRun = pending->deadline;
+    } else if (pending->deadline < retransmission->nextRun) {
+        IHS_TimerTaskReschedule(retransmission->task, timeout);
+        retransmission->nextRun = pending->deadline;
+    }
+    // Entry may be moved or reused once unlocked
+    IHS_SessionPacketHeader header = pending->packet.header;
     IHS_MutexUnlock(retransmission->lock);
     IHS_SessionLog(retransmission->session, IHS_LogLevelVerbose, "Retransmission",
-                   "Queued Packet(channelId=%u, packetId=%u, fragmentId=%u), retransmitCount=%u",
-                   pending->packet.header.channelId, pending->packet.header.packetId,
-                   pending->packet.header.fragmentId, pending->packet.header.retransmitCount);
+                   "Queued Packet(channelId=%u, packetId=%u, fragmentId=%u), retransmitCount=%u, timeout=%u",
+                   header.channelId, header.packetId, header.fragmentId, header.retransmitCount, timeout);
     return true;
 }
 
 bool IHS_RetransmissionCancel(IHS_SessionRetransmission *retransmission, IHS_SessionChannelId channelId,
                               uint16_t packetId, uint16_t fragmentId) {
-    RetransmissionQuery query = {
-            .channelId = channelId,
-            .packetId = packetId,
-            .fragmentId = fragmentId,
-    };
+    uint32_t now = IHS_SessionPacketTimestamp();
     IHS_MutexLock(retransmission->lock);
-    PendingRetransmission *match = IHS_QueuePollBy(retransmission->queue, RetransmissionPacketPredicate, &query);
-    IHS_MutexUnlock(retransmission->lock);
-    if (match == NULL) {
+    int32_t index = RetransmissionTake(retransmission, channelId, packetId, fragmentId);
+    if (index < 0) {
+        // The packet may have been sent but not queued yet, remember it so it won't be
+        if (retransmission->sending && retransmission->numEarlyAcks < IHS_RETRANSMISSION_EARLY_ACKS) {
+            IHS_RetransmissionKey *key = &retransmission->earlyAcks[retransmission->numEarlyAcks++];
+            key->channelId = channelId;
+            key->packetId = packetId;
+            key->fragmentId = fragmentId;
+        }
+        IHS_MutexUnlock(retransmission->lock);
         return false;
-    } else if (match->task != NULL) {
-        IHS_SessionLog(retransmission->session, IHS_LogLevelVerbose, "Retransmission",
-                       "Cancelling Packet(channelId=%u, packetId=%u, fragmentId=%u), retransmitCount=%u",
-                       channelId, packetId, fragmentId, match->packet.header.retransmitCount);
-        IHS_TimerTask *task = match->task;
-        match->task = NULL;
-        IHS_TimerTaskStopImmediate(task);
     }
+    IHS_RetransmissionEntry *match = &retransmission->entries[index];
+    IHS_SessionPacket packet = match->packet;
+    /* Karn's algorithm: can't tell which transmission got acknowledged if the packet was sent more than once */
+    if (packet.header.retransmitCount == 1) {
+        IHS_SessionRTTSample(&retransmission->rtt, IHS_SESSION_PACKET_TIMESTAMP_TO_MICROS(now - match->sentAt));
+        retransmission->session->state.roundTripTime = (retransmission->rtt.srtt + 999) / 1000;
+    }
+    RetransmissionRelease(retransmission, index);
+    IHS_MutexUnlock(retransmission->lock);
+    IHS_SessionLog(retransmission->session, IHS_LogLevelVerbose, "Retransmission",
+                   "Cancelling Packet(channelId=%u, packetId=%u, fragmentId=%u), retransmitCount=%u",
+                   channelId, packetId, fragmentId, packet.header.retransmitCount);
+    IHS_SessionPacketClear(&packet, true);
     return true;
 }
 
-static void RetransmissionQueueItemDestroy(PendingRetransmission *item, void *context) {
-    (void) context;
-    IHS_TimerTask *task = item->task;
-    item->task = NULL;
-    if (task != NULL) {
-        IHS_TimerTaskStopImmediate(task);
-    }
+void IHS_RetransmissionBeginSend(IHS_SessionRetransmission *retransmission) {
+    IHS_MutexLock(retransmission->lock);
+    assert(!retransmission->sending);
+    retransmission->sending = true;
+    IHS_MutexUnlock(retransmission->lock);
+}
+
+void IHS_RetransmissionEndSend(IHS_SessionRetransmission *retransmission) {
+    IHS_MutexLock(retransmission->lock);
+    retransmission->sending = false;
+    // ACKs of packets not queued by now are duplicates
+    retransmission->numEarlyAcks = 0;
+    IHS_MutexUnlock(retransmission->lock);
+}
+
+void IHS_RetransmissionGetRTT(const IHS_SessionRetransmission *retransmission, IHS_SessionRTT *rtt) {
+    IHS_MutexLock(retransmission->lock);
+    *rtt = retransmission->rtt;
+    IHS_MutexUnlock(retransmission->lock);
 }
 
 static uint64_t RetransmissionTimerRun(int runCount, void *context) {
     (void) runCount;
-    PendingRetransmission *pending = context;
-    IHS_SessionRetransmission *retransmission = pending->retransmission;
-    IHS_SessionPacket *packet = &pending->packet;
-    IHS_SessionQueuePacket(retransmission->session, packet, packet->header.retransmitCount < RETRANSMISSION_ATTEMPTS);
-    assert(packet->body.data == NULL);
-    return 0;
+    IHS_SessionRetransmission *retransmission = context;
+    IHS_SessionPacket due[RETRANSMISSION_BATCH_SIZE];
+    IHS_SessionSendClass dueClasses[RETRANSMISSION_BATCH_SIZE];
+    int numDue;
+    uint64_t now, nextRun;
+    do {
+        numDue = 0;
+        nextRun = UINT64_MAX;
+        IHS_MutexLock(retransmission->lock);
+        now = IHS_TimerNow();
+        for (size_t i = 0; i < retransmission->capacity; i++) {
+            IHS_RetransmissionEntry *entry = &retransmission->entries[i];
+            if (!entry->used) {
+                continue;
+            }
+            if (entry->deadline <= now && numDue < RETRANSMISSION_BATCH_SIZE) {
+                IHS_SessionPacketHeader *header = &entry->packet.header;
+                int32_t index = RetransmissionTake(retransmission, header->channelId, header->packetId,
+                                                   header->fragmentId);
+                assert(index == (int32_t) i);
+                dueClasses[numDue] = entry->sendClass;
+                due[numDue++] = entry->packet;
+                RetransmissionRelease(retransmission, index);
+            } else if (entry->deadline < nextRun) {
+                nextRun = entry->deadline;
+            }
+        }
+        retransmission->nextRun = nextRun;
+        IHS_MutexUnlock(retransmission->lock);
+
+        // Packets will come back to the table once sent
+        for (int i = 0; i < numDue; i++) {
+            IHS_SessionPacket *packet = &due[i];
+            IHS_SessionQueuePacket(retransmission->session, packet,
+                                   packet->header.retransmitCount < RETRANSMISSION_ATTEMPTS, dueClasses[i]);
+            assert(packet->body.data == NULL);
+        }
+    } while (numDue == RETRANSMISSION_BATCH_SIZE);
+    if (nextRun == UINT64_MAX) {
+        return RETRANSMISSION_IDLE_INTERVAL;
+    }
+    return nextRun > now ? nextRun - now : 1;
 }
 
 static void RetransmissionTimerEnd(void *context) {
-    PendingRetransmission *pending = context;
-    IHS_SessionRetransmission *retransmission = pending->retransmission;
-    IHS_SessionLog(retransmission->session, IHS_LogLevelVerbose, "Retransmission",
-                   "Timer ended for Packet(channelId=%u, packetId=%u, fragmentId=%u), retransmitCount=%u",
-                   pending->packet.header.channelId, pending->packet.header.packetId, pending->packet.header.fragmentId,
-                   pending->packet.header.retransmitCount);
+    IHS_SessionRetransmission *retransmission = context;
     IHS_MutexLock(retransmission->lock);
-    IHS_QueuePollBy(retransmission->queue, RetransmissionIdenticalPredicate, pending);
+    retransmission->task = NULL;
+    retransmission->nextRun = UINT64_MAX;
     IHS_MutexUnlock(retransmission->lock);
-    IHS_SessionPacketClear(&pending->packet, true);
-    IHS_QueueItemFree(pending);
 }
 
-static bool RetransmissionIdenticalPredicate(PendingRetransmission *item, void *context) {
-    return item == context;
+/**
+ * Double the capacity of entries and the table. Must be called with lock held.
+ */
+static void RetransmissionGrow(IHS_SessionRetransmission *retransmission) {
+    size_t capacity = retransmission->capacity ? retransmission->capacity * 2 : RETRANSMISSION_INITIAL_CAPACITY;
+    IHS_RetransmissionEntry *entries = realloc(retransmission->entries, capacity * sizeof(IHS_RetransmissionEntry));
+    assert(entries != NULL);
+    // Link new entries in front of the free list, lowest index first
+    for (size_t i = capacity; i > retransmission->capacity; i--) {
+        IHS_RetransmissionEntry *entry = &entries[i - 1];
+        entry->used = false;
+        entry->next = retransmission->freeList;
+        retransmission->freeList = (int32_t) (i - 1);
+    }
+    retransmission->entries = entries;
+    retransmission->capacity = capacity;
+    // Keep load factor at or below 0.5
+    int32_t *table = realloc(retransmission->table, capacity * 2 * sizeof(int32_t));
+    assert(table != NULL);
+    retransmission->table = table;
+    retransmission->tableSize = capacity * 2;
+    TableRebuild(retransmission);
+}
+
+/**
+ * Find the entry and remove it from the table. The entry needs to be released by the caller.
+ * @return Index of the entry, or -1 if not found
+ */
+static int32_t RetransmissionTake(IHS_SessionRetransmission *retransmission, IHS_SessionChannelId channelId,
+                                  uint16_t packetId, uint16_t fragmentId) {
+    size_t mask = retransmission->tableSize - 1;
+    for (size_t pos = TableHome(retransmission, channelId, packetId, fragmentId);; pos = (pos + 1) & mask) {
+        int32_t index = retransmission->table[pos];
+        if (index < 0) {
+            return -1;
+        }
+        const IHS_SessionPacketHeader *header = &retransmission->entries[index].packet.header;
+        if (header->channelId == channelId && header->packetId == packetId && header->fragmentId == fragmentId) {
+            TableRemoveAt(retransmission, pos);
+            return index;
+        }
+    }
+}
+
+/**
+ * Find and remove the ACK received before the packet is queued. Must be called with lock held.
+ */
+static bool EarlyAckTake(IHS_SessionRetransmission *retransmission, const IHS_SessionPacketHeader *header) {
+    for (int i = 0; i < retransmission->numEarlyAcks; i++) {
+        IHS_RetransmissionKey *key = &retransmission->earlyAcks[i];
+        if (key->channelId == header->channelId && key->packetId == header->packetId &&
+            key->fragmentId == header->fragmentId) {
+            *key = retransmission->earlyAcks[--retransmission->numEarlyAcks];
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Put the entry back to the free list. Packet buffer is not freed.
+ */
+static void RetransmissionRelease(IHS_SessionRetransmission *retransmission, int32_t index) {
+    IHS_RetransmissionEntry *entry = &retransmission->entries[index];
+    assert(entry->used);
+    entry->used = false;
+    entry->next = retransmission->freeList;
+    retransmission->freeList = index;
+    retransmission->count--;
+}
+
+static void TableRebuild(IHS_SessionRetransmission *retransmission) {
+    for (size_t i = 0; i < retransmission->tableSize; i++) {
+        retransmission->table[i] = -1;
+    }
+    for (size_t i = 0; i < retransmission->capacity; i++) {
+        if (retransmission->entries[i].used) {
+            TableInsert(retransmission, (int32_t) i);
+        }
+    }
+}
+
+static void TableInsert(IHS_SessionRetransmission *retransmission, int32_t index) {
+    const IHS_SessionPacketHeader *header = &retransmission->entries[index].packet.header;
+    size_t mask = retransmission->tableSize - 1;
+    size_t pos = TableHome(retransmission, header->channelId, header->packetId, header->fragmentId);
+    while (retransmission->table[pos] >= 0) {
+        pos = (pos + 1) & mask;
+    }
+    retransmission->table[pos] = index;
 }
 
-static bool RetransmissionPacketPredicate(PendingRetransmission *item, void *context) {
-    RetransmissionQuery *query = context;
-    return item->packet.header.channelId == query->channelId &&
-           item->packet.header.packetId == query->packetId &&
-           item->packet.header.fragmentId == query->fragmentId;
-}
\ No newline at end of file
+/**
+ * Backward shift deletion, so lookups never need tombstones
+ */
+static void TableRemoveAt(IHS_SessionRetransmission *retransmission, size_t pos) {
+    size_t mask = retransmission->tableSize - 1;
+    size_t hole = pos;
+    for (size_t i = (pos + 1) & mask; retransmission->table[i] >= 0; i = (i + 1) & mask) {
+        const IHS_SessionPacketHeader *header = &retransmission->entries[retransmission->table[i]].packet.header;
+        size_t home = TableHome(retransmission, header->channelId, header->packetId, header->fragmentId);
+        // Move the item into the hole, unless the hole is before its home position
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            retransmission->table[hole] = retransmission->table[i];
+            hole = i;
+        }
+    }
+    retransmission->table[hole] = -1;
+}
+
+static inline size_t TableHome(const IHS_SessionRetransmission *retransmission, IHS_SessionChannelId channelId,
+                               uint16_t packetId, uint16_t fragmentId) {
+    uint64_t key = ((uint64_t) channelId << 32) | ((uint64_t) packetId << 16) | fragmentId;
+    return (size_t) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & (retransmission->tableSize - 1);
+}
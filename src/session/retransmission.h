@@ -25,24 +25,80 @@
 
 #pragma once
 
+#include "ihslib/session.h"
+
 #include "ihs_thread.h"
-#include "ihs_queue.h"
 #include "ihs_timer.h"
 #include "packet.h"
+#include "rtt.h"
 
 typedef struct IHS_Session IHS_Session;
 
+typedef struct IHS_RetransmissionEntry IHS_RetransmissionEntry;
+
+#define IHS_RETRANSMISSION_EARLY_ACKS 32
+
+typedef struct IHS_RetransmissionKey {
+    IHS_SessionChannelId channelId;
+    uint16_t packetId;
+    uint16_t fragmentId;
+} IHS_RetransmissionKey;
+
 typedef struct IHS_SessionRetransmission {
     IHS_Session *session;
     IHS_Mutex *lock;
-    IHS_Queue *queue;
+    /**
+     * Slab of pending packets. Unused entries are linked through their next field.
+     */
+    IHS_RetransmissionEntry *entries;
+    size_t capacity;
+    size_t count;
+    int32_t freeList;
+    /**
+     * Open addressed table of entry indices, keyed by channel, packet and fragment ID. -1 marks an empty slot.
+     */
+    int32_t *table;
+    size_t tableSize;
+    /**
+     * Single task for all pending packets, scheduled for the earliest deadline
+     */
+    IHS_TimerTask *task;
+    uint64_t nextRun;
+    /**
+     * Measured from ACKs of packets that were not retransmitted
+     */
+    IHS_SessionRTT rtt;
+    /**
+     * Set while send thread is sending packets it's going to queue here
+     */
+    bool sending;
+    /**
+     * ACKs received while sending that matched no pending packet. Their packets are dropped instead of queued.
+     */
+    IHS_RetransmissionKey earlyAcks[IHS_RETRANSMISSION_EARLY_ACKS];
+    int numEarlyAcks;
 } IHS_SessionRetransmission;
 
 void IHS_RetransmissionInit(IHS_SessionRetransmission *retransmission, IHS_Session *session);
 
 void IHS_RetransmissionDeinit(IHS_SessionRetransmission *retransmission);
 
-bool IHS_RetransmissionQueue(IHS_SessionRetransmission *retransmission, IHS_SessionPacket *packet);
+/**
+ * Take ownership of the packet, and send it again if it's not acknowledged in time
+ * @return false if the packet is not queued, either it has been sent too many times or acknowledged already
+ */
+bool IHS_RetransmissionQueue(IHS_SessionRetransmission *retransmission, IHS_SessionPacket *packet,
+                             IHS_SessionSendClass sendClass);
+
+/**
+ * Called by send thread before sending packets it's going to queue. ACKs arriving before the packets are queued are
+ * remembered until IHS_RetransmissionEndSend.
+ */
+void IHS_RetransmissionBeginSend(IHS_SessionRetransmission *retransmission);
+
+void IHS_RetransmissionEndSend(IHS_SessionRetransmission *retransmission);
 
 bool IHS_RetransmissionCancel(IHS_SessionRetransmission *retransmission, IHS_SessionChannelId channelId,
                               uint16_t packetId, uint16_t fragmentId);
+
+void IHS_RetransmissionGetRTT(const IHS_SessionRetransmission *retransmission, IHS_SessionRTT *rtt);
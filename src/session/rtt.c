@@ -0,0 +1,78 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "rtt.h"
+
+/* Used until the first measurement */
+#define RTT_INITIAL_TIMEOUT 10
+/* Streaming runs on LAN mostly, so the 1 second minimum from RFC 6298 is way too conservative */
+#define RTT_MIN_TIMEOUT 2
+#define RTT_MAX_TIMEOUT 1000
+/* Clock granularity in microseconds */
+#define RTT_GRANULARITY 1000
+
+static uint32_t RTTComputeTimeout(const IHS_SessionRTT *rtt);
+
+void IHS_SessionRTTInit(IHS_SessionRTT *rtt) {
+    rtt->measured = false;
+    rtt->srtt = 0;
+    rtt->rttvar = 0;
+    rtt->rto = RTT_INITIAL_TIMEOUT;
+}
+
+void IHS_SessionRTTSample(IHS_SessionRTT *rtt, uint32_t sample) {
+    if (!rtt->measured) {
+        rtt->srtt = sample;
+        rtt->rttvar = sample / 2;
+        rtt->measured = true;
+    } else {
+        uint32_t delta = sample > rtt->srtt ? sample - rtt->srtt : rtt->srtt - sample;
+        /* RTTVAR <- 3/4 * RTTVAR + 1/4 * |SRTT - R'|, then SRTT <- 7/8 * SRTT + 1/8 * R' */
+        rtt->rttvar = (uint32_t) (((uint64_t) rtt->rttvar * 3 + delta) / 4);
+        rtt->srtt = (uint32_t) (((uint64_t) rtt->srtt * 7 + sample) / 8);
+    }
+    rtt->rto = RTTComputeTimeout(rtt);
+}
+
+uint32_t IHS_SessionRTTTimeout(const IHS_SessionRTT *rtt, uint8_t attempt) {
+    uint64_t timeout = rtt->rto;
+    for (uint8_t i = 1; i < attempt && timeout < RTT_MAX_TIMEOUT; i++) {
+        timeout *= 2;
+    }
+    return timeout < RTT_MAX_TIMEOUT ? (uint32_t) timeout : RTT_MAX_TIMEOUT;
+}
+
+static uint32_t RTTComputeTimeout(const IHS_SessionRTT *rtt) {
+    uint64_t variance = (uint64_t) rtt->rttvar * 4;
+    uint64_t micros = rtt->srtt + (variance > RTT_GRANULARITY ? variance : RTT_GRANULARITY);
+    /* Round up to whole milliseconds */
+    uint64_t timeout = (micros + 999) / 1000;
+    if (timeout < RTT_MIN_TIMEOUT) {
+        return RTT_MIN_TIMEOUT;
+    } else if (timeout > RTT_MAX_TIMEOUT) {
+        return RTT_MAX_TIMEOUT;
+    }
+    return (uint32_t) timeout;
+}
@@ -0,0 +1,65 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file rtt.h
+ * @brief Round trip time estimation and retransmission timeout calculation, as described in RFC 6298
+ * @note This object is not thread safe
+ */
+
+typedef struct IHS_SessionRTT {
+    bool measured;
+    /**
+     * Smoothed round trip time in microseconds
+     */
+    uint32_t srtt;
+    /**
+     * Round trip time variation in microseconds
+     */
+    uint32_t rttvar;
+    /**
+     * Retransmission timeout in milliseconds, without backoff
+     */
+    uint32_t rto;
+} IHS_SessionRTT;
+
+void IHS_SessionRTTInit(IHS_SessionRTT *rtt);
+
+/**
+ * Feed a round trip time measurement. Samples of retransmitted packets are ambiguous and must not be used.
+ * @param sample Measured round trip time in microseconds
+ */
+void IHS_SessionRTTSample(IHS_SessionRTT *rtt, uint32_t sample);
+
+/**
+ * @param attempt Number of times the packet has been sent. Timeout doubles for each retransmission.
+ * @return Time to wait before sending the packet again, in milliseconds
+ */
+uint32_t IHS_SessionRTTTimeout(const IHS_SessionRTT *rtt, uint8_t attempt);
@@ -0,0 +1,118 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "send_queue.h"
+#include "ihs_mpsc_ring.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct IHS_SessionSendQueue {
+    /**
+     * One ring for each send class
+     */
+    IHS_MPSCRing *rings[IHS_SessionSendClassCount];
+    IHS_SessionSendStats stats[IHS_SessionSendClassCount];
+};
+
+IHS_SessionSendQueue *IHS_SessionSendQueueCreate(size_t capacity) {
+    IHS_SessionSendQueue *queue = calloc(1, sizeof(IHS_SessionSendQueue));
+    for (int i = 0; i < IHS_SessionSendClassCount; i++) {
+        queue->rings[i] = IHS_MPSCRingCreate(sizeof(IHS_SessionQueuedPacket), capacity);
+    }
+    return queue;
+}
+
+void IHS_SessionSendQueueDestroy(IHS_SessionSendQueue *queue) {
+    for (int i = 0; i < IHS_SessionSendClassCount; i++) {
+        IHS_SessionQueuedPacket queued;
+        while (IHS_MPSCRingPoll(queue->rings[i], &queued)) {
+            IHS_SessionQueuedPacketDestroy(&queued);
+        }
+        IHS_MPSCRingDestroy(queue->rings[i]);
+    }
+    free(queue);
+}
+
+bool IHS_SessionSendQueueOffer(IHS_SessionSendQueue *queue, IHS_SessionPacket *packet, bool retransmit,
+                               IHS_SessionSendClass sendClass) {
+    assert(sendClass >= 0 && sendClass < IHS_SessionSendClassCount);
+    IHS_SessionQueuedPacket queued;
+    memset(&queued, 0, sizeof(IHS_SessionQueuedPacket));
+    queued.packet.header = packet->header;
+    queued.packet.crc = packet->crc;
+    queued.retransmit = retransmit;
+    queued.sendClass = sendClass;
+    queued.queuedAt = IHS_SessionPacketTimestamp();
+    // Move buffer ownership from packet to the queued one
+    IHS_BufferTransferOwnership(&packet->body, &queued.packet.body);
+    if (!IHS_MPSCRingOffer(queue->rings[sendClass], &queued)) {
+        // Give it back, so the caller can try again
+        IHS_BufferTransferOwnership(&queued.packet.body, &packet->body);
+        return false;
+    }
+    return true;
+}
+
+int IHS_SessionSendQueuePoll(IHS_SessionSendQueue *queue, IHS_SessionQueuedPacket *batch, int capacity) {
+    int count = 0;
+    for (int i = 0; i < IHS_SessionSendClassCount; i++) {
+        while (count < capacity && IHS_MPSCRingPoll(queue->rings[i], &batch[count])) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool IHS_SessionSendQueueIsEmpty(IHS_SessionSendQueue *queue) {
+    for (int i = 0; i < IHS_SessionSendClassCount; i++) {
+        if (!IHS_MPSCRingIsEmpty(queue->rings[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void IHS_SessionSendQueueMarkSent(IHS_SessionSendQueue *queue, const IHS_SessionQueuedPacket *queued, uint32_t now) {
+    uint32_t latency = IHS_SESSION_PACKET_TIMESTAMP_TO_MICROS(now - queued->queuedAt);
+    IHS_SessionSendStats *stats = &queue->stats[queued->sendClass];
+    stats->packetsSent++;
+    // Same smoothing as RFC 3550 interarrival jitter
+    stats->latency = (uint32_t) ((int64_t) stats->latency + ((int64_t) latency - (int64_t) stats->latency) / 16);
+    if (latency > stats->maxLatency) {
+        stats->maxLatency = latency;
+    }
+}
+
+void IHS_SessionSendQueueGetStats(IHS_SessionSendQueue *queue, IHS_SessionSendClass sendClass,
+                                  IHS_SessionSendStats *stats) {
+    assert(sendClass >= 0 && sendClass < IHS_SessionSendClassCount);
+    *stats = queue->stats[sendClass];
+}
+
+void IHS_SessionQueuedPacketDestroy(IHS_SessionQueuedPacket *queued) {
+    IHS_SessionPacketClear(&queued->packet, true);
+}
@@ -0,0 +1,95 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ihslib/session.h"
+#include "packet.h"
+
+/**
+ * @file send_queue.h
+ * @brief Outgoing packets of a session, one ring for each send class
+ * @note Producers can offer from any thread, but only one thread may poll
+ */
+
+typedef struct IHS_SessionSendQueue IHS_SessionSendQueue;
+
+typedef struct IHS_SessionQueuedPacket {
+    IHS_SessionPacket packet;
+    bool retransmit;
+    IHS_SessionSendClass sendClass;
+    /**
+     * Packet timestamp of when the packet was queued
+     */
+    uint32_t queuedAt;
+} IHS_SessionQueuedPacket;
+
+typedef struct IHS_SessionSendStats {
+    uint64_t packetsSent;
+    /**
+     * Smoothed queue latency in microseconds
+     */
+    uint32_t latency;
+    uint32_t maxLatency;
+} IHS_SessionSendStats;
+
+/**
+ * @param capacity Number of packets each class can hold
+ */
+IHS_SessionSendQueue *IHS_SessionSendQueueCreate(size_t capacity);
+
+/**
+ * Release the queue, and all packets still in it
+ */
+void IHS_SessionSendQueueDestroy(IHS_SessionSendQueue *queue);
+
+/**
+ * Move the packet body into the queue, and stamp the time it's queued.
+ * @return false if the ring of this class is full, and the packet is left untouched
+ */
+bool IHS_SessionSendQueueOffer(IHS_SessionSendQueue *queue, IHS_SessionPacket *packet, bool retransmit,
+                               IHS_SessionSendClass sendClass);
+
+/**
+ * Fill the batch with packets from higher classes first. Caller owns polled packets.
+ * @return Number of packets polled
+ */
+int IHS_SessionSendQueuePoll(IHS_SessionSendQueue *queue, IHS_SessionQueuedPacket *batch, int capacity);
+
+bool IHS_SessionSendQueueIsEmpty(IHS_SessionSendQueue *queue);
+
+/**
+ * Count the packet in stats of its class
+ * @param now Packet timestamp of when the packet left the socket
+ */
+void IHS_SessionSendQueueMarkSent(IHS_SessionSendQueue *queue, const IHS_SessionQueuedPacket *queued, uint32_t now);
+
+void IHS_SessionSendQueueGetStats(IHS_SessionSendQueue *queue, IHS_SessionSendClass sendClass,
+                                  IHS_SessionSendStats *stats);
+
+void IHS_SessionQueuedPacketDestroy(IHS_SessionQueuedPacket *queued);
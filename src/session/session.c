@@ -25,6 +25,7 @@
 
 #include <stdlib.h>
 #include <memory.h>
+#include <unistd.h>
 
 #include "ihslib/session.h"
 #include "ihslib/common.h"
@@ -41,12 +42,20 @@
 
 #include "hid/manager.h"
 
-typedef struct IHS_QueueItem {
-    IHS_SessionPacket packet;
-    bool retransmit;
-} QueuedPacket;
+#define SEND_BATCH_SIZE 32
+#define SEND_QUEUE_CAPACITY 1024
+/* Enough to fill video, audio and control windows, buffers are only allocated when needed */
+#define PACKET_POOL_CAPACITY (2048 + 256 + 128 + 64)
+#define PACKET_BUFFER_SIZE 2048
+/* Enough for video frames between two stats reports */
+#define VIDEO_FRAME_STATS_CAPACITY 256
+
+/* Used until the round trip time is measured */
+#define DEFAULT_ROUND_TRIP_TIME 50
 
-static void SessionRecvCallback(IHS_Base *base, const IHS_SocketAddress *address, IHS_Buffer *data);
+static void SessionRecvCallback(IHS_Base *base, IHS_UDPPacket *packets, size_t count);
+
+static void SessionPacketReceived(IHS_Session *session, IHS_Buffer *data);
 
 static void SessionInitialized(IHS_Base *base, void *context);
 
@@ -54,9 +63,9 @@ static void SessionFinalized(IHS_Base *base, void *context);
 
 static void SessionSendWorker(void *context);
 
-static QueuedPacket *QueuedPacketCreate(IHS_Session *session, IHS_SessionPacket *packet);
+static void SessionSerializePacket(IHS_Session *session, IHS_SessionPacket *packet, IHS_Buffer *serialized);
 
-static void QueuedPacketDestroy(QueuedPacket *queued, void *unused);
+static void SessionWakeSendWorker(IHS_Session *session);
 
 static const IHS_BaseRunCallbacks SessionRunCallbacks = {
         .initialized = SessionInitialized,
@@ -68,10 +77,21 @@ IHS_Session *IHS_SessionCreate(const IHS_ClientConfig *clientConfig, const IHS_S
     IHS_BaseInit(&session->base, clientConfig, SessionRecvCallback, false);
     IHS_BaseSetRunCallbacks(&session->base, &SessionRunCallbacks, NULL);
     session->info = *sessionInfo;
+    session->state.roundTripTime = DEFAULT_ROUND_TRIP_TIME;
     session->sendQueueMutex = IHS_MutexCreate();
     session->sendQueueCond = IHS_CondCreate();
-    session->sendQueue = IHS_QueueCreate(sizeof(QueuedPacket));
+    session->sendQueue = IHS_SessionSendQueueCreate(SEND_QUEUE_CAPACITY);
+    atomic_init(&session->sendThreadWaiting, false);
     session->timers = IHS_TimerCreate();
+    session->packetPool = IHS_BufferPoolCreate(PACKET_BUFFER_SIZE, PACKET_POOL_CAPACITY);
+    session->base.receivePool = session->packetPool;
+    session->videoPlayout = IHS_SessionPlayoutCreate();
+    session->videoQueue = IHS_SessionVideoQueueCreate();
+    session->videoFrameStats = IHS_VideoFrameStatsCreate(VIDEO_FRAME_STATS_CAPACITY);
+    session->inputCoalescer = IHS_InputCoalescerCreate(session->timers, IHS_SessionInputMotionFlushed, session);
+    if (!IHS_SessionFrameCryptoInit(session)) {
+        IHS_SessionLog(session, IHS_LogLevelError, "Session", "Failed to create cipher or HMAC context");
+    }
     IHS_RetransmissionInit(&session->retransmission, session);
     session->hidManager = IHS_HIDManagerCreate();
 
@@ -90,6 +110,10 @@ IHS_Session *IHS_SessionCreate(const IHS_ClientConfig *clientConfig, const IHS_S
 
 
 bool IHS_SessionConnect(IHS_Session *session) {
+    if (session->crypto.cipher == NULL || session->crypto.hmac == NULL) {
+        IHS_SessionLog(session, IHS_LogLevelError, "Session", "Crypto contexts are not available, can't connect");
+        return false;
+    }
     IHS_SessionLog(session, IHS_LogLevelInfo, "Session", "Starting session thread");
     // After worker ready, send connect packet
     return IHS_BaseStartWorker(&session->base, "IHSSession");
@@ -105,6 +129,8 @@ void IHS_SessionThreadedJoin(IHS_Session *session) {
 }
 
 void IHS_SessionDestroy(IHS_Session *session) {
+    // Send pending motion now, timer tasks must not use channels after they're destroyed
+    IHS_InputCoalescerSetInterval(session->inputCoalescer, 0);
     for (int i = 0; i < session->numChannels; ++i) {
         IHS_SessionChannelDestroy(session->channels[i]);
     }
@@ -113,7 +139,13 @@ void IHS_SessionDestroy(IHS_Session *session) {
     IHS_RetransmissionDeinit(&session->retransmission);
     IHS_CondDestroy(session->sendQueueCond);
     IHS_MutexDestroy(session->sendQueueMutex);
-    IHS_QueueDestroy(session->sendQueue, QueuedPacketDestroy, NULL);
+    IHS_SessionSendQueueDestroy(session->sendQueue);
+    IHS_BufferPoolDestroy(session->packetPool);
+    IHS_SessionPlayoutDestroy(session->videoPlayout);
+    IHS_SessionVideoQueueDestroy(session->videoQueue);
+    IHS_VideoFrameStatsDestroy(session->videoFrameStats);
+    IHS_InputCoalescerDestroy(session->inputCoalescer);
+    IHS_SessionFrameCryptoDeinit(session);
     IHS_SessionLog(session, IHS_LogLevelInfo, "Session", "Destroying session, bye!");
     IHS_BaseDestroy(&session->base);
     free(session);
@@ -134,35 +166,26 @@ void IHS_SessionInterrupt(IHS_Session *session) {
 }
 
 bool IHS_SessionSendPacket(IHS_Session *session, IHS_SessionPacket *packet) {
-    const IHS_SessionInfo *config = &session->info;
-    // Write header and CRC to the buffer
-    IHS_SessionPacketPopulateBuffer(packet);
-    // Shallow copied buffer - offset & suffix changes will be temporary
-    IHS_Buffer serialized = packet->body;
-    IHS_BufferExtendSize(&serialized);
-
-    if (packet->header.retransmitCount > 0) {
-        IHS_SessionLog(session, IHS_LogLevelVerbose, "Retransmission",
-                       "Send Packet(channelId=%u, packetId=%u, fragmentId=%u), retransmitCount=%u",
-                       packet->header.channelId, packet->header.packetId, packet->header.fragmentId,
-                       packet->header.retransmitCount);
-    }
-    return IHS_BaseSend(&session->base, config->address, &serialized);
+    IHS_Buffer serialized;
+    SessionSerializePacket(session, packet, &serialized);
+    return IHS_BaseSend(&session->base, session->info.address, &serialized);
 }
 
-bool IHS_SessionQueuePacket(IHS_Session *session, IHS_SessionPacket *packet, bool retransmit) {
+bool IHS_SessionQueuePacket(IHS_Session *session, IHS_SessionPacket *packet, bool retransmit,
+                            IHS_SessionSendClass sendClass) {
     assert(packet->body.offset == IHS_PACKET_HEADER_SIZE);
     // If the packet has CRC, require 4 bytes extra space at the end of body
     assert(!packet->header.hasCrc || packet->body.suffix == 4);
-    IHS_MutexLock(session->sendQueueMutex);
-    // Move buffer ownership from packet to QueuedPacket
-    QueuedPacket *item = QueuedPacketCreate(session, packet);
-    item->retransmit = retransmit;
-
-    IHS_QueueAppend(session->sendQueue, item);
-
-    IHS_CondSignal(session->sendQueueCond);
-    IHS_MutexUnlock(session->sendQueueMutex);
+    while (!IHS_SessionSendQueueOffer(session->sendQueue, packet, retransmit, sendClass)) {
+        // Send thread is too far behind. Let it catch up
+        if (session->base.interrupted) {
+            IHS_SessionPacketClear(packet, true);
+            return false;
+        }
+        SessionWakeSendWorker(session);
+        usleep(100);
+    }
+    SessionWakeSendWorker(session);
     return true;
 }
 
@@ -186,9 +209,75 @@ const IHS_SessionInfo *IHS_SessionGetInfo(const IHS_Session *session) {
     return &session->info;
 }
 
-static void SessionRecvCallback(IHS_Base *base, const IHS_SocketAddress *address, IHS_Buffer *data) {
-    (void) address;
+void IHS_SessionGetStats(const IHS_Session *session, IHS_SessionStats *stats) {
+    memset(stats, 0, sizeof(IHS_SessionStats));
+    stats->receiveCalls = session->base.stats.receiveCalls;
+    stats->packetsReceived = session->base.stats.packetsReceived;
+
+    IHS_BufferPoolStats poolStats;
+    IHS_BufferPoolGetStats(session->packetPool, &poolStats);
+    stats->packetPoolCapacity = poolStats.capacity;
+    stats->packetPoolHighWaterMark = poolStats.highWaterMark;
+    stats->packetPoolExhausted = poolStats.exhausted;
+
+    IHS_SessionPlayoutStats playoutStats;
+    IHS_SessionPlayoutGetStats(session->videoPlayout, &playoutStats);
+    stats->videoJitter = playoutStats.jitter;
+    stats->videoFramesIncomplete = playoutStats.framesIncomplete;
+    stats->videoFramesLate = playoutStats.framesLate;
+
+    IHS_SessionVideoQueueStats queueStats;
+    IHS_SessionVideoQueueGetStats(session->videoQueue, &queueStats);
+    stats->videoQueueDepth = queueStats.depth;
+    stats->videoQueueFramesDropped = queueStats.framesDropped;
+
+    IHS_VideoFrameLatencyStats latency;
+    IHS_VideoFrameStatsGetLatency(session->videoFrameStats, &latency);
+    memcpy(stats->videoDecodeLatency, latency.decode, sizeof(latency.decode));
+    memcpy(stats->videoDisplayLatency, latency.display, sizeof(latency.display));
+
+    IHS_SessionRTT rtt;
+    IHS_RetransmissionGetRTT(&session->retransmission, &rtt);
+    stats->roundTripTime = rtt.srtt;
+    stats->roundTripTimeVariance = rtt.rttvar;
+    stats->retransmissionTimeout = rtt.rto;
+
+    for (int i = 0; i < IHS_SessionSendClassCount; i++) {
+        IHS_SessionSendStats sendStats;
+        IHS_SessionSendQueueGetStats(session->sendQueue, i, &sendStats);
+        stats->packetsSent[i] = sendStats.packetsSent;
+        stats->sendQueueLatency[i] = sendStats.latency;
+        stats->sendQueueMaxLatency[i] = sendStats.maxLatency;
+    }
+}
+
+void IHS_SessionSetPlayoutConfig(IHS_Session *session, const IHS_SessionPlayoutConfig *config) {
+    IHS_SessionPlayoutSetConfig(session->videoPlayout, config);
+}
+
+void IHS_SessionSetVideoQueueConfig(IHS_Session *session, const IHS_SessionVideoQueueConfig *config) {
+    IHS_SessionVideoQueueSetConfig(session->videoQueue, config);
+}
+
+void IHS_SessionSetInputConfig(IHS_Session *session, const IHS_SessionInputConfig *config) {
+    IHS_InputCoalescerSetInterval(session->inputCoalescer, config->coalesceInterval);
+}
+
+void IHS_SessionVideoReportFrameEvent(IHS_Session *session, uint16_t frameId, IHS_StreamVideoFrameEvent event,
+                                      uint64_t timestamp) {
+    uint32_t packetTimestamp = timestamp != 0 ? IHS_SessionPacketTimestampFromMicros(timestamp)
+                                              : IHS_SessionPacketTimestamp();
+    IHS_VideoFrameStatsExternalEvent(session->videoFrameStats, frameId, (EStreamFrameEvent) event, packetTimestamp);
+}
+
+static void SessionRecvCallback(IHS_Base *base, IHS_UDPPacket *packets, size_t count) {
     IHS_Session *session = (IHS_Session *) base;
+    for (size_t i = 0; i < count; i++) {
+        SessionPacketReceived(session, &packets[i].buffer);
+    }
+}
+
+static void SessionPacketReceived(IHS_Session *session, IHS_Buffer *data) {
     IHS_SessionPacket packet;
     IHS_SessionPacketReturn ret = IHS_SessionPacketParse(&packet, data);
     if (ret != IHS_SessionPacketResultOK) {
@@ -209,7 +298,8 @@ static void SessionRecvCallback(IHS_Base *base, const IHS_SocketAddress *address
         IHS_SessionLog(session, IHS_LogLevelDebug, "Session", "Unknown channel for packet(type=%u, ch=%u)", packetType,
                        channelId);
     }
-    IHS_SessionPacketClear(&packet, true);
+    // Give the buffer back if no one took it
+    IHS_BufferPoolRecycle(session->packetPool, &packet.body);
 }
 
 static void SessionInitialized(IHS_Base *base, void *context) {
@@ -236,7 +326,7 @@ static void SessionInitialized(IHS_Base *base, void *context) {
     IHS_SessionPacket packet;
     IHS_SessionChannelInitializePacket(discovery, &packet, IHS_SessionPacketTypeConnect, true, 0);
     IHS_BufferAppendMem(&packet.body, body, sizeof(body));
-    IHS_SessionQueuePacket(session, &packet, true);
+    IHS_SessionQueuePacket(session, &packet, true, IHS_SessionSendClassInteractive);
     IHS_SessionPacketClear(&packet, true);
 }
 
@@ -252,39 +342,85 @@ static void SessionFinalized(IHS_Base *base, void *context) {
 
 static void SessionSendWorker(void *context) {
     IHS_Session *session = (IHS_Session *) context;
+    IHS_SessionQueuedPacket batch[SEND_BATCH_SIZE];
+    IHS_UDPPacket datagrams[SEND_BATCH_SIZE];
     while (!session->base.interrupted) {
-        IHS_MutexLock(session->sendQueueMutex);
-        QueuedPacket *queued;
-        // Poll the first item in the queue
-        while ((queued = IHS_QueuePoll(session->sendQueue)) == NULL) {
-            // Wait till someone add item into the queue
-            IHS_CondWait(session->sendQueueCond, session->sendQueueMutex);
-            if (session->base.interrupted) {
-                IHS_MutexUnlock(session->sendQueueMutex);
-                return;
+        if (IHS_SessionSendQueueIsEmpty(session->sendQueue)) {
+            IHS_MutexLock(session->sendQueueMutex);
+            // Announce we're going to sleep before checking again, so a producer either sees the flag or we see its item
+            atomic_store(&session->sendThreadWaiting, true);
+            while (IHS_SessionSendQueueIsEmpty(session->sendQueue)) {
+                // Wait till someone add item into the queue
+                IHS_CondWait(session->sendQueueCond, session->sendQueueMutex);
+                if (session->base.interrupted) {
+                    atomic_store(&session->sendThreadWaiting, false);
+                    IHS_MutexUnlock(session->sendQueueMutex);
+                    return;
+                }
             }
+            atomic_store(&session->sendThreadWaiting, false);
+            IHS_MutexUnlock(session->sendQueueMutex);
+        }
+        // Take everything queued so far in one go. Leftovers will be picked up by next iteration without waiting
+        int count = IHS_SessionSendQueuePoll(session->sendQueue, batch, SEND_BATCH_SIZE);
+
+        bool retransmit = false;
+        for (int i = 0; i < count; i++) {
+            datagrams[i].address = session->info.address;
+            SessionSerializePacket(session, &batch[i].packet, &datagrams[i].buffer);
+            retransmit |= batch[i].retransmit;
+        }
+        // ACKs may arrive before the packets are queued for retransmission
+        if (retransmit) {
+            IHS_RetransmissionBeginSend(&session->retransmission);
+        }
+        int sent = IHS_BaseSendBatch(&session->base, datagrams, count);
+        if (sent < count) {
+            IHS_SessionLog(session, IHS_LogLevelDebug, "Session", "%d of %d packets failed to send", count - sent,
+                           count);
         }
-        IHS_MutexUnlock(session->sendQueueMutex);
-
-        IHS_SessionSendPacket(session, &queued->packet);
 
-        if (queued->retransmit) {
-            IHS_RetransmissionQueue(&session->retransmission, &queued->packet);
+        uint32_t now = IHS_SessionPacketTimestamp();
+        for (int i = 0; i < count; i++) {
+            IHS_SessionQueuedPacket *queued = &batch[i];
+            IHS_SessionSendQueueMarkSent(session->sendQueue, queued, now);
+            // Unsent packets still go to retransmission queue, so they will be attempted again later
+            if (queued->retransmit) {
+                IHS_RetransmissionQueue(&session->retransmission, &queued->packet, queued->sendClass);
+            }
+            IHS_SessionQueuedPacketDestroy(queued);
+        }
+        if (retransmit) {
+            IHS_RetransmissionEndSend(&session->retransmission);
         }
-        QueuedPacketDestroy(queued, NULL);
-        IHS_QueueItemFree(queued);
     }
 }
 
-static QueuedPacket *QueuedPacketCreate(IHS_Session *session, IHS_SessionPacket *packet) {
-    QueuedPacket *item = IHS_QueueItemObtain(session->sendQueue);
-    item->packet.header = packet->header;
-    item->packet.crc = packet->crc;
-    IHS_BufferTransferOwnership(&packet->body, &item->packet.body);
-    return item;
+/**
+ * Write header and CRC of the packet, and make a shallow copy of its buffer covering the whole datagram.
+ * The serialized buffer doesn't own the data.
+ */
+static void SessionSerializePacket(IHS_Session *session, IHS_SessionPacket *packet, IHS_Buffer *serialized) {
+    // Write header and CRC to the buffer
+    IHS_SessionPacketPopulateBuffer(packet);
+    // Shallow copied buffer - offset & suffix changes will be temporary
+    *serialized = packet->body;
+    IHS_BufferExtendSize(serialized);
+
+    if (packet->header.retransmitCount > 0) {
+        IHS_SessionLog(session, IHS_LogLevelVerbose, "Retransmission",
+                       "Send Packet(channelId=%u, packetId=%u, fragmentId=%u), retransmitCount=%u",
+                       packet->header.channelId, packet->header.packetId, packet->header.fragmentId,
+                       packet->header.retransmitCount);
+    }
 }
 
-static void QueuedPacketDestroy(QueuedPacket *queued, void *unused) {
-    (void) unused;
-    IHS_SessionPacketClear(&queued->packet, true);
-}
\ No newline at end of file
+static void SessionWakeSendWorker(IHS_Session *session) {
+    // Cheap check, only take the lock when the send thread is actually waiting
+    if (!atomic_load(&session->sendThreadWaiting)) {
+        return;
+    }
+    IHS_MutexLock(session->sendQueueMutex);
+    IHS_CondSignal(session->sendQueueCond);
+    IHS_MutexUnlock(session->sendQueueMutex);
+}
@@ -29,16 +29,28 @@
 #include "base.h"
 #include "packet.h"
 #include "retransmission.h"
+#include "playout.h"
+#include "video_queue.h"
+#include "send_queue.h"
+#include "input_coalescer.h"
+#include "channels/video/frame_stats.h"
+#include "crypto.h"
 
 #include "channels/channel.h"
 
 #include "protobuf/remoteplay.pb-c.h"
 #include "ihs_queue.h"
 
+#include <stdatomic.h>
+
 typedef struct IHS_SessionState {
     int mtu;
     uint8_t connectionId;
     uint8_t hostConnectionId;
+    /**
+     * Estimated round trip time in milliseconds
+     */
+    uint32_t roundTripTime;
 } IHS_SessionState;
 
 struct IHS_Session {
@@ -48,12 +60,50 @@ struct IHS_Session {
     uint8_t numChannels;
     IHS_SessionChannel *channels[16];
     IHS_Thread *sendThread;
+    /**
+     * Only used for waking up send thread
+     */
     IHS_Cond *sendQueueCond;
     IHS_Mutex *sendQueueMutex;
-    IHS_Queue *sendQueue;
+    /**
+     * Send thread always drains higher classes first
+     */
+    IHS_SessionSendQueue *sendQueue;
+    /**
+     * Set when the send thread is about to sleep, so producers know they need to signal sendQueueCond
+     */
+    atomic_bool sendThreadWaiting;
     IHS_Timer *timers;
+    IHS_BufferPool *packetPool;
+    /**
+     * Playout schedule of video frames. Kept by session, so it can be configured before video stream starts
+     */
+    IHS_SessionPlayout *videoPlayout;
+    /**
+     * Frames waiting for the decoder. Kept by session for the same reason as videoPlayout
+     */
+    IHS_SessionVideoQueue *videoQueue;
+    /**
+     * Events of video frames. Kept by session, as application may report events after video stream stopped
+     */
+    IHS_VideoFrameStats *videoFrameStats;
+    /**
+     * Mouse and touch motion waiting to be sent
+     */
+    IHS_InputCoalescer *inputCoalescer;
     IHS_SessionRetransmission retransmission;
     IHS_HIDManager *hidManager;
+    /**
+     * Key schedules derived from session key, created once for the whole session
+     */
+    struct {
+        IHS_CryptoCipher *cipher;
+        IHS_CryptoHMAC *hmac;
+        /**
+         * Control frames can be encrypted from any thread, and HMAC context is not thread safe
+         */
+        IHS_Mutex *hmacLock;
+    } crypto;
     struct {
         const IHS_StreamSessionCallbacks *session;
         const IHS_StreamAudioCallbacks *audio;
@@ -79,11 +129,25 @@ bool IHS_SessionSendPacket(IHS_Session *session, IHS_SessionPacket *packet);
  * @param session Session instance
  * @param packet Packet
  * @param retransmit If true, the packet will be retransmitted 10 times before cancellation
+ * @param sendClass Packets of a higher class are sent first
  * @return
  */
-bool IHS_SessionQueuePacket(IHS_Session *session, IHS_SessionPacket *packet, bool retransmit);
+bool IHS_SessionQueuePacket(IHS_Session *session, IHS_SessionPacket *packet, bool retransmit,
+                            IHS_SessionSendClass sendClass);
 
 bool IHS_SessionSendControlMessage(IHS_Session *session, EStreamControlMessage type, const ProtobufCMessage *message);
 
+/**
+ * Send mouse or touch motion, or hold it for the input coalescer
+ */
+bool IHS_SessionSendInputMotion(IHS_Session *session, const IHS_InputMotion *motion);
+
+/**
+ * Send input event after all pending motion
+ */
+bool IHS_SessionSendInputEvent(IHS_Session *session, EStreamControlMessage type, const ProtobufCMessage *message);
+
+void IHS_SessionInputMotionFlushed(const IHS_InputMotion *motion, void *context);
+
 bool IHS_SessionCancelRetransmission(IHS_Session *session, IHS_SessionChannelId channelId, uint16_t packetId,
                                      uint16_t fragmentId);
@@ -0,0 +1,200 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "video_queue.h"
+#include "ihs_thread.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+struct IHS_SessionVideoQueue {
+    IHS_Mutex *lock;
+    IHS_Cond *cond;
+    IHS_SessionVideoQueueConfig config;
+    IHS_Thread *thread;
+    bool running;
+    IHS_SessionVideoQueueSubmitFunction *submit;
+    void *context;
+    /**
+     * Ring of queued frames
+     */
+    IHS_StreamVideoFrame **frames;
+    size_t capacity;
+    size_t head;
+    size_t count;
+    IHS_SessionVideoQueuePolicy policy;
+    bool waitingKeyFrame;
+    struct {
+        uint64_t framesDropped;
+    } stats;
+};
+
+static void QueueWorker(void *context);
+
+static IHS_StreamVideoFrame *QueuePoll(IHS_SessionVideoQueue *queue);
+
+/**
+ * Release all queued frames. Must be called with lock held.
+ * @return Number of released frames
+ */
+static size_t QueueDropAll(IHS_SessionVideoQueue *queue);
+
+IHS_SessionVideoQueue *IHS_SessionVideoQueueCreate() {
+    IHS_SessionVideoQueue *queue = calloc(1, sizeof(IHS_SessionVideoQueue));
+    queue->lock = IHS_MutexCreate();
+    queue->cond = IHS_CondCreate();
+    return queue;
+}
+
+void IHS_SessionVideoQueueDestroy(IHS_SessionVideoQueue *queue) {
+    IHS_SessionVideoQueueStop(queue);
+    IHS_CondDestroy(queue->cond);
+    IHS_MutexDestroy(queue->lock);
+    free(queue);
+}
+
+void IHS_SessionVideoQueueSetConfig(IHS_SessionVideoQueue *queue, const IHS_SessionVideoQueueConfig *config) {
+    IHS_MutexLock(queue->lock);
+    queue->config = *config;
+    IHS_MutexUnlock(queue->lock);
+}
+
+bool IHS_SessionVideoQueueStart(IHS_SessionVideoQueue *queue, IHS_SessionVideoQueueSubmitFunction *submit,
+                                void *context) {
+    IHS_MutexLock(queue->lock);
+    assert(queue->thread == NULL);
+    if (queue->config.depth == 0) {
+        IHS_MutexUnlock(queue->lock);
+        return false;
+    }
+    queue->capacity = queue->config.depth;
+    queue->policy = queue->config.policy;
+    queue->frames = calloc(queue->capacity, sizeof(IHS_StreamVideoFrame *));
+    queue->head = 0;
+    queue->count = 0;
+    queue->waitingKeyFrame = false;
+    queue->submit = submit;
+    queue->context = context;
+    queue->running = true;
+    IHS_MutexUnlock(queue->lock);
+    queue->thread = IHS_ThreadCreate(QueueWorker, "IHSVideoSubmit", queue);
+    return true;
+}
+
+void IHS_SessionVideoQueueStop(IHS_SessionVideoQueue *queue) {
+    if (queue->thread == NULL) {
+        return;
+    }
+    IHS_MutexLock(queue->lock);
+    queue->running = false;
+    IHS_CondBroadcast(queue->cond);
+    IHS_MutexUnlock(queue->lock);
+    IHS_ThreadJoin(queue->thread);
+    queue->thread = NULL;
+
+    IHS_MutexLock(queue->lock);
+    QueueDropAll(queue);
+    free(queue->frames);
+    queue->frames = NULL;
+    queue->capacity = 0;
+    IHS_MutexUnlock(queue->lock);
+}
+
+IHS_SessionVideoQueueResult IHS_SessionVideoQueuePush(IHS_SessionVideoQueue *queue, IHS_StreamVideoFrame *frame) {
+    bool keyFrame = IHS_StreamVideoFrameGetFlags(frame) & IHS_StreamVideoFrameKeyFrame;
+    IHS_SessionVideoQueueResult result = IHS_SessionVideoQueueQueued;
+    IHS_MutexLock(queue->lock);
+    if (!queue->running || (queue->waitingKeyFrame && !keyFrame)) {
+        queue->stats.framesDropped++;
+        IHS_MutexUnlock(queue->lock);
+        IHS_StreamVideoFrameRelease(frame);
+        return IHS_SessionVideoQueueDropped;
+    }
+    queue->waitingKeyFrame = false;
+    if (queue->count == queue->capacity) {
+        result = IHS_SessionVideoQueueDropped;
+        if (queue->policy == IHS_SessionVideoQueueDropOldest) {
+            IHS_StreamVideoFrameRelease(QueuePoll(queue));
+            queue->stats.framesDropped++;
+        } else {
+            queue->stats.framesDropped += QueueDropAll(queue);
+            /* Following frames can't be decoded without their references */
+            if (!keyFrame) {
+                queue->stats.framesDropped++;
+                queue->waitingKeyFrame = true;
+                IHS_MutexUnlock(queue->lock);
+                IHS_StreamVideoFrameRelease(frame);
+                return IHS_SessionVideoQueueRequestKeyFrame;
+            }
+        }
+    }
+    queue->frames[(queue->head + queue->count) % queue->capacity] = frame;
+    queue->count++;
+    IHS_CondSignal(queue->cond);
+    IHS_MutexUnlock(queue->lock);
+    return result;
+}
+
+void IHS_SessionVideoQueueGetStats(IHS_SessionVideoQueue *queue, IHS_SessionVideoQueueStats *stats) {
+    IHS_MutexLock(queue->lock);
+    stats->depth = (uint32_t) queue->count;
+    stats->framesDropped = queue->stats.framesDropped;
+    IHS_MutexUnlock(queue->lock);
+}
+
+static void QueueWorker(void *context) {
+    IHS_SessionVideoQueue *queue = context;
+    IHS_MutexLock(queue->lock);
+    while (true) {
+        while (queue->running && queue->count == 0) {
+            IHS_CondWait(queue->cond, queue->lock);
+        }
+        if (!queue->running) {
+            break;
+        }
+        IHS_StreamVideoFrame *frame = QueuePoll(queue);
+        IHS_MutexUnlock(queue->lock);
+        queue->submit(frame, queue->context);
+        IHS_MutexLock(queue->lock);
+    }
+    IHS_MutexUnlock(queue->lock);
+}
+
+static IHS_StreamVideoFrame *QueuePoll(IHS_SessionVideoQueue *queue) {
+    assert(queue->count > 0);
+    IHS_StreamVideoFrame *frame = queue->frames[queue->head];
+    queue->frames[queue->head] = NULL;
+    queue->head = (queue->head + 1) % queue->capacity;
+    queue->count--;
+    return frame;
+}
+
+static size_t QueueDropAll(IHS_SessionVideoQueue *queue) {
+    size_t dropped = queue->count;
+    while (queue->count > 0) {
+        IHS_StreamVideoFrameRelease(QueuePoll(queue));
+    }
+    return dropped;
+}
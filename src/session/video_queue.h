@@ -0,0 +1,88 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ihslib/session.h"
+
+/**
+ * @file video_queue.h
+ * @brief Bounded queue of video frames, submitted to the decoder from a dedicated thread
+ * @note This object is thread safe
+ */
+
+typedef struct IHS_SessionVideoQueue IHS_SessionVideoQueue;
+
+/**
+ * Called from the queue thread for every frame. Callee owns the frame reference.
+ */
+typedef void (IHS_SessionVideoQueueSubmitFunction)(IHS_StreamVideoFrame *frame, void *context);
+
+typedef enum IHS_SessionVideoQueueResult {
+    IHS_SessionVideoQueueQueued,
+    /**
+     * The frame, or older frames, were dropped
+     */
+    IHS_SessionVideoQueueDropped,
+    /**
+     * Frames were dropped, and a keyframe should be requested
+     */
+    IHS_SessionVideoQueueRequestKeyFrame,
+} IHS_SessionVideoQueueResult;
+
+typedef struct IHS_SessionVideoQueueStats {
+    uint32_t depth;
+    uint64_t framesDropped;
+} IHS_SessionVideoQueueStats;
+
+IHS_SessionVideoQueue *IHS_SessionVideoQueueCreate();
+
+void IHS_SessionVideoQueueDestroy(IHS_SessionVideoQueue *queue);
+
+void IHS_SessionVideoQueueSetConfig(IHS_SessionVideoQueue *queue, const IHS_SessionVideoQueueConfig *config);
+
+/**
+ * Start the submit thread, if the queue is enabled
+ * @param submit Function to call for every frame
+ * @return true if the queue is started, and frames should be pushed to it
+ */
+bool IHS_SessionVideoQueueStart(IHS_SessionVideoQueue *queue, IHS_SessionVideoQueueSubmitFunction *submit,
+                                void *context);
+
+/**
+ * Stop the submit thread, and release frames not submitted yet. Does nothing if not started.
+ */
+void IHS_SessionVideoQueueStop(IHS_SessionVideoQueue *queue);
+
+/**
+ * Add a frame to the queue. The queue takes ownership of the frame reference.
+ * @return What happened to the frame
+ */
+IHS_SessionVideoQueueResult IHS_SessionVideoQueuePush(IHS_SessionVideoQueue *queue, IHS_StreamVideoFrame *frame);
+
+void IHS_SessionVideoQueueGetStats(IHS_SessionVideoQueue *queue, IHS_SessionVideoQueueStats *stats);
@@ -31,6 +31,7 @@
 struct IHS_SessionPacketsWindow {
     IHS_SessionWindowItem *data;
     uint16_t capacity;
+    IHS_BufferPool *pool;
     /*
      * [+][+][+][-]
      *       ^ head.pos = 2
@@ -46,6 +47,10 @@ struct IHS_SessionPacketsWindow {
         int pos;
         uint16_t id;
     } tail;
+    /**
+     * Unused slots between head and tail
+     */
+    uint16_t missing;
 };
 
 static inline bool FrameItemIsHead(const IHS_SessionWindowItem *item);
@@ -54,11 +59,27 @@ static inline bool FrameItemIsUsed(const IHS_SessionWindowItem *item);
 
 static inline void FrameItemUsePacket(IHS_SessionWindowItem *item, IHS_SessionPacket *packet);
 
-static inline void FrameItemRecycle(IHS_SessionWindowItem *item);
+static inline void FrameItemRecycle(IHS_SessionPacketsWindow *window, IHS_SessionWindowItem *item);
+
+/**
+ * Check if all fragments of the frame at head are received
+ * @param window Window instance
+ * @param bodyLen Total body length of the frame
+ * @return Number of packets of the frame, or 0 if the frame is not complete
+ */
+static int FrameReadyPackets(const IHS_SessionPacketsWindow *window, size_t *bodyLen);
+
+static void AdvanceHead(IHS_SessionPacketsWindow *window, int count);
 
-IHS_SessionPacketsWindow *IHS_SessionPacketsWindowCreate(uint16_t capacity) {
+/**
+ * @return Number of slots from head to the start of next frame, in the range of window size
+ */
+static int HeadFrameSlots(const IHS_SessionPacketsWindow *window, uint16_t size);
+
+IHS_SessionPacketsWindow *IHS_SessionPacketsWindowCreate(uint16_t capacity, IHS_BufferPool *pool) {
     IHS_SessionPacketsWindow *window = calloc(1, sizeof(IHS_SessionPacketsWindow));
     window->capacity = capacity;
+    window->pool = pool;
     window->data = calloc(capacity, sizeof(IHS_SessionWindowItem));
     window->head.pos = 0;
     window->tail.pos = -1;
@@ -70,7 +91,7 @@ void IHS_SessionPacketsWindowDestroy(IHS_SessionPacketsWindow *window) {
         if (!FrameItemIsUsed(&window->data[i])) {
             continue;
         }
-        FrameItemRecycle(&window->data[i]);
+        FrameItemRecycle(window, &window->data[i]);
     }
     free(window->data);
     free(window);
@@ -79,8 +100,8 @@ void IHS_SessionPacketsWindowDestroy(IHS_SessionPacketsWindow *window) {
 bool IHS_SessionPacketsWindowAdd(IHS_SessionPacketsWindow *window, IHS_SessionPacket *packet) {
     /* Calculate distance of 2 items */
     int tailOffset = window->tail.pos < 0 ? 1 : (int16_t) (packet->header.packetId - window->tail.id);
-    /* We already processed this packet, so ignore it */
-    if (tailOffset < 0 && -tailOffset > IHS_SessionPacketsWindowSize(window)) {
+    /* Packet at or before the consumed head was already processed, ignore it before touching the slot */
+    if (tailOffset <= 0 && -tailOffset >= IHS_SessionPacketsWindowSize(window)) {
         return true;
     }
     /* Not sure why but the offset is significantly larger than window capacity. Ignore it reset */
@@ -101,41 +122,24 @@ bool IHS_SessionPacketsWindowAdd(IHS_SessionPacketsWindow *window, IHS_SessionPa
 
     /* Only do incremental update */
     if (tailOffset > 0) {
+        /* Skipped packets are missing until they arrive out of order */
+        window->missing += tailOffset - 1;
         window->tail.pos = writePos;
         window->tail.id = packet->header.packetId;
+    } else {
+        assert(window->missing > 0);
+        window->missing--;
     }
     return true;
 }
 
 bool IHS_SessionPacketsWindowPoll(IHS_SessionPacketsWindow *window, IHS_SessionFrame *frame) {
-    uint16_t size = IHS_SessionPacketsWindowSize(window);
-    if (size == 0) {
-        return false;
-    }
-    assert(window->head.pos >= 0);
-    IHS_SessionWindowItem *head = &window->data[window->head.pos % window->capacity];
-
-    /* Must start from packet head */
-    if (!FrameItemIsHead(head)) {
-        return false;
-    }
-
-    /* Must have size enough for all fragments */
-    int packetsCount = 1 + head->header.fragmentId;
-    if (size < packetsCount) {
-        return false;
-    }
-
     size_t frameBodyLen = 0;
-    for (int i = window->head.pos, j = window->head.pos + packetsCount; i < j; i++) {
-        /* The array is sparse, must collect all fragments */
-        const IHS_SessionWindowItem *item = &window->data[i % window->capacity];
-        if (!FrameItemIsUsed(item)) {
-            return false;
-        }
-        frameBodyLen += item->body.size;
+    int packetsCount = FrameReadyPackets(window, &frameBodyLen);
+    if (packetsCount <= 0) {
+        return false;
     }
-    frame->header = head->header;
+    frame->header = window->data[window->head.pos % window->capacity].header;
     IHS_BufferEnsureMaxSize(&frame->body, frameBodyLen);
 
     for (int i = window->head.pos, j = window->head.pos + packetsCount; i < j; i++) {
@@ -143,14 +147,33 @@ bool IHS_SessionPacketsWindowPoll(IHS_SessionPacketsWindow *window, IHS_SessionF
         IHS_BufferAppend(&frame->body, &item->body);
 
         /* This item is used, recycle it */
-        FrameItemRecycle(item);
+        FrameItemRecycle(window, item);
     }
     assert(frame->body.size == frameBodyLen);
 
-    window->head.pos = window->head.pos + packetsCount;
-    if (window->head.pos > window->capacity) {
-        window->head.pos = window->head.pos % window->capacity;
+    AdvanceHead(window, packetsCount);
+    return true;
+}
+
+bool IHS_SessionPacketsWindowPollSegments(IHS_SessionPacketsWindow *window, IHS_SessionSegmentedFrame *frame) {
+    assert(frame->count == 0);
+    size_t frameBodyLen = 0;
+    int packetsCount = FrameReadyPackets(window, &frameBodyLen);
+    if (packetsCount <= 0) {
+        return false;
     }
+    frame->header = window->data[window->head.pos % window->capacity].header;
+    frame->pool = window->pool;
+
+    for (int i = window->head.pos, j = window->head.pos + packetsCount; i < j; i++) {
+        IHS_SessionWindowItem *item = &window->data[i % window->capacity];
+        /* Buffer is moved to the frame, only the slot needs to be cleared */
+        IHS_SessionSegmentedFrameAppend(frame, &item->body);
+        memset(item, 0, sizeof(IHS_SessionWindowItem));
+    }
+    assert(frame->size == frameBodyLen);
+
+    AdvanceHead(window, packetsCount);
     return true;
 }
 
@@ -179,10 +202,12 @@ uint16_t IHS_SessionPacketsWindowDiscard(IHS_SessionPacketsWindow *window, uint3
         IHS_SessionWindowItem *item = &window->data[i % window->capacity];
         discarded++;
         if (!FrameItemIsUsed(item)) {
+            assert(window->missing > 0);
+            window->missing--;
             continue;
         }
         /* This packet is used, recycle it */
-        FrameItemRecycle(item);
+        FrameItemRecycle(window, item);
     }
     window->head.pos = firstValid;
     if (window->head.pos > window->capacity) {
@@ -191,6 +216,48 @@ uint16_t IHS_SessionPacketsWindowDiscard(IHS_SessionPacketsWindow *window, uint3
     return discarded;
 }
 
+uint16_t IHS_SessionPacketsWindowDiscardHead(IHS_SessionPacketsWindow *window) {
+    uint16_t size = IHS_SessionPacketsWindowSize(window);
+    if (!size) return 0;
+    int slots = HeadFrameSlots(window, size);
+    for (int i = window->head.pos, j = window->head.pos + slots; i < j; i++) {
+        IHS_SessionWindowItem *item = &window->data[i % window->capacity];
+        if (!FrameItemIsUsed(item)) {
+            assert(window->missing > 0);
+            window->missing--;
+            continue;
+        }
+        FrameItemRecycle(window, item);
+    }
+    AdvanceHead(window, slots);
+    return slots;
+}
+
+bool IHS_SessionPacketsWindowHeadTimestamp(const IHS_SessionPacketsWindow *window, uint32_t *timestamp) {
+    uint16_t size = IHS_SessionPacketsWindowSize(window);
+    if (!size) return false;
+    int slots = HeadFrameSlots(window, size);
+    bool found = false;
+    uint32_t newest = 0;
+    /* If no packet of the frame is received, the next received one is the best guess */
+    for (int i = window->head.pos, j = window->head.pos + size; i < j; i++) {
+        const IHS_SessionWindowItem *item = &window->data[i % window->capacity];
+        if (!FrameItemIsUsed(item)) {
+            continue;
+        }
+        if (!found || (int32_t) (item->header.sendTimestamp - newest) > 0) {
+            newest = item->header.sendTimestamp;
+        }
+        found = true;
+        if (i + 1 >= window->head.pos + slots) {
+            break;
+        }
+    }
+    assert(found);
+    *timestamp = newest;
+    return true;
+}
+
 void IHS_SessionPacketsWindowReleaseFrame(IHS_SessionFrame *frame) {
     IHS_SessionFrameClear(frame, false);
 }
@@ -230,6 +297,88 @@ uint16_t IHS_SessionPacketsWindowSize(const IHS_SessionPacketsWindow *window) {
     }
 }
 
+bool IHS_SessionPacketsWindowHasFrame(const IHS_SessionPacketsWindow *window) {
+    size_t bodyLen;
+    return FrameReadyPackets(window, &bodyLen) > 0;
+}
+
+uint16_t IHS_SessionPacketsWindowMissingCount(const IHS_SessionPacketsWindow *window) {
+    return window->missing;
+}
+
+size_t IHS_SessionPacketsWindowCollectMissing(const IHS_SessionPacketsWindow *window, uint16_t minDistance,
+                                              uint32_t *ids, size_t maxIds) {
+    uint16_t size = IHS_SessionPacketsWindowSize(window);
+    if (window->missing == 0 || size <= minDistance) {
+        return 0;
+    }
+    size_t count = 0;
+    for (int i = 0, j = size - minDistance; i < j && count < maxIds; i++) {
+        const IHS_SessionWindowItem *item = &window->data[(window->head.pos + i) % window->capacity];
+        if (FrameItemIsUsed(item)) {
+            continue;
+        }
+        /* Tail is at distance size - 1 from head */
+        ids[count++] = (uint16_t) (window->tail.id - (size - 1 - i));
+    }
+    return count;
+}
+
+static int FrameReadyPackets(const IHS_SessionPacketsWindow *window, size_t *bodyLen) {
+    uint16_t size = IHS_SessionPacketsWindowSize(window);
+    if (size == 0) {
+        return 0;
+    }
+    assert(window->head.pos >= 0);
+    const IHS_SessionWindowItem *head = &window->data[window->head.pos % window->capacity];
+
+    /* Must start from packet head */
+    if (!FrameItemIsHead(head)) {
+        return 0;
+    }
+
+    /* Must have size enough for all fragments */
+    int packetsCount = 1 + head->header.fragmentId;
+    if (size < packetsCount) {
+        return 0;
+    }
+
+    size_t frameBodyLen = 0;
+    for (int i = window->head.pos, j = window->head.pos + packetsCount; i < j; i++) {
+        /* The array is sparse, must collect all fragments */
+        const IHS_SessionWindowItem *item = &window->data[i % window->capacity];
+        if (!FrameItemIsUsed(item)) {
+            return 0;
+        }
+        frameBodyLen += item->body.size;
+    }
+    *bodyLen = frameBodyLen;
+    return packetsCount;
+}
+
+static void AdvanceHead(IHS_SessionPacketsWindow *window, int count) {
+    window->head.pos = window->head.pos + count;
+    if (window->head.pos > window->capacity) {
+        window->head.pos = window->head.pos % window->capacity;
+    }
+}
+
+static int HeadFrameSlots(const IHS_SessionPacketsWindow *window, uint16_t size) {
+    const IHS_SessionWindowItem *head = &window->data[window->head.pos % window->capacity];
+    if (FrameItemIsUsed(head) && FrameItemIsHead(head)) {
+        int packetsCount = 1 + head->header.fragmentId;
+        return packetsCount < size ? packetsCount : size;
+    }
+    /* First packet of the frame is missing, so the frame ends before next received frame head */
+    for (int i = 1; i < size; i++) {
+        const IHS_SessionWindowItem *item = &window->data[(window->head.pos + i) % window->capacity];
+        if (FrameItemIsUsed(item) && FrameItemIsHead(item)) {
+            return i;
+        }
+    }
+    return size;
+}
+
 static inline bool FrameItemIsHead(const IHS_SessionWindowItem *item) {
     return item->header.type == IHS_SessionPacketTypeReliable || item->header.type == IHS_SessionPacketTypeUnreliable;
 }
@@ -243,7 +392,11 @@ static inline void FrameItemUsePacket(IHS_SessionWindowItem *item, IHS_SessionPa
     IHS_BufferTransferOwnership(&packet->body, &item->body);
 }
 
-static inline void FrameItemRecycle(IHS_SessionWindowItem *item) {
-    IHS_BufferClear(&item->body, true);
+static inline void FrameItemRecycle(IHS_SessionPacketsWindow *window, IHS_SessionWindowItem *item) {
+    if (window->pool != NULL) {
+        IHS_BufferPoolRecycle(window->pool, &item->body);
+    } else {
+        IHS_BufferClear(&item->body, true);
+    }
     memset(item, 0, sizeof(IHS_SessionWindowItem));
 }
\ No newline at end of file
@@ -30,14 +30,16 @@
 
 #include "packet.h"
 #include "frame.h"
+#include "ihs_buffer_pool.h"
 
 typedef struct IHS_SessionPacketsWindow IHS_SessionPacketsWindow;
 
 /**
  * Create packets window window
  * @param capacity Maximum packets capacity
+ * @param pool Pool to return packet buffers to when they are consumed. If NULL, buffers will be freed.
  */
-IHS_SessionPacketsWindow *IHS_SessionPacketsWindowCreate(uint16_t capacity);
+IHS_SessionPacketsWindow *IHS_SessionPacketsWindowCreate(uint16_t capacity, IHS_BufferPool *pool);
 
 void IHS_SessionPacketsWindowDestroy(IHS_SessionPacketsWindow *window);
 
@@ -45,6 +47,15 @@ bool IHS_SessionPacketsWindowAdd(IHS_SessionPacketsWindow *window, IHS_SessionPa
 
 bool IHS_SessionPacketsWindowPoll(IHS_SessionPacketsWindow *window, IHS_SessionFrame *frame);
 
+/**
+ * Poll one frame without copying fragment bodies. Buffers of the fragments will be moved to the frame, so window slots
+ * can be reused immediately. Release the frame with IHS_SessionSegmentedFrameRelease when done.
+ * @param window Window instance
+ * @param frame Frame to append segments to. It must be empty.
+ * @return true if a frame was polled
+ */
+bool IHS_SessionPacketsWindowPollSegments(IHS_SessionPacketsWindow *window, IHS_SessionSegmentedFrame *frame);
+
 /**
  * Discard all frames with timestamp difference between tail larger than `diff`
  * @param window
@@ -52,10 +63,40 @@ bool IHS_SessionPacketsWindowPoll(IHS_SessionPacketsWindow *window, IHS_SessionF
  */
 uint16_t IHS_SessionPacketsWindowDiscard(IHS_SessionPacketsWindow *window, uint32_t diff);
 
+/**
+ * Discard the frame at head, whether it's complete or not
+ * @return Number of discarded slots
+ */
+uint16_t IHS_SessionPacketsWindowDiscardHead(IHS_SessionPacketsWindow *window);
+
+/**
+ * Get newest send timestamp among received packets of the frame at head
+ * @param window Window instance
+ * @param timestamp Output timestamp
+ * @return false if the window is empty
+ */
+bool IHS_SessionPacketsWindowHeadTimestamp(const IHS_SessionPacketsWindow *window, uint32_t *timestamp);
+
 void IHS_SessionPacketsWindowReleaseFrame(IHS_SessionFrame *frame);
 
 uint16_t IHS_SessionPacketsWindowAvailable(const IHS_SessionPacketsWindow *window);
 
 uint16_t IHS_SessionPacketsWindowSize(const IHS_SessionPacketsWindow *window);
 
+/**
+ * @return Number of packets not yet received between head and tail
+ */
+uint16_t IHS_SessionPacketsWindowMissingCount(const IHS_SessionPacketsWindow *window);
+
+/**
+ * Collect IDs of packets not yet received between head and tail
+ * @param window Window instance
+ * @param minDistance Only collect packets at least this far behind tail, so slightly reordered packets are not reported
+ * @param ids Output packet IDs, oldest first
+ * @param maxIds Capacity of ids
+ * @return Number of IDs collected
+ */
+size_t IHS_SessionPacketsWindowCollectMissing(const IHS_SessionPacketsWindow *window, uint16_t minDistance,
+                                              uint32_t *ids, size_t maxIds);
+
 bool IHS_SessionPacketsWindowHasFrame(const IHS_SessionPacketsWindow *window);
@@ -0,0 +1,154 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "crypto.h"
+#include "endianness.h"
+#include "session/frame.h"
+#include "session/session_pri.h"
+#include "protobuf/pb_utils.h"
+
+#define ITERATIONS 200000
+#define HMAC_SIZE 16
+
+typedef size_t (EncodeFunction)(IHS_Session *session, const ProtobufCMessage *message, IHS_Buffer *body,
+                                uint64_t sequence);
+
+static size_t EncodeWithCopies(IHS_Session *session, const ProtobufCMessage *message, IHS_Buffer *body,
+                               uint64_t sequence);
+
+static size_t EncodeInPlace(IHS_Session *session, const ProtobufCMessage *message, IHS_Buffer *body,
+                            uint64_t sequence);
+
+static void Benchmark(const char *name, EncodeFunction *encode, IHS_Session *session,
+                      const ProtobufCMessage *message);
+
+static size_t EncryptedCapacity(size_t messageSize);
+
+static double NowSeconds();
+
+int main() {
+    IHS_Session session = {
+            .info = {
+                    .sessionKeyLen = 32,
+            },
+    };
+    for (int i = 0; i < 32; i++) {
+        session.info.sessionKey[i] = (uint8_t) rand();
+    }
+    IHS_SessionFrameCryptoInit(&session);
+
+    /* A typical input event */
+    CInputMouseMotionMsg message = CINPUT_MOUSE_MOTION_MSG__INIT;
+    PROTOBUF_C_SET_VALUE(message, dx, 12);
+    PROTOBUF_C_SET_VALUE(message, dy, -7);
+
+    /* Both ways give the same frame */
+    IHS_Buffer expected, actual;
+    IHS_BufferInit(&expected, 256, 256);
+    IHS_BufferInit(&actual, 256, 256);
+    EncodeWithCopies(&session, (const ProtobufCMessage *) &message, &expected, 1);
+    EncodeInPlace(&session, (const ProtobufCMessage *) &message, &actual, 1);
+    assert(expected.size == actual.size);
+    assert(memcmp(IHS_BufferPointer(&expected), IHS_BufferPointer(&actual), actual.size) == 0);
+    IHS_BufferClear(&expected, true);
+    IHS_BufferClear(&actual, true);
+
+    Benchmark("copies", EncodeWithCopies, &session, (const ProtobufCMessage *) &message);
+    Benchmark("in-place", EncodeInPlace, &session, (const ProtobufCMessage *) &message);
+
+    IHS_SessionFrameCryptoDeinit(&session);
+    return 0;
+}
+
+/**
+ * Message is packed into a scratch buffer, then copied again behind sequence number before encryption
+ */
+static size_t EncodeWithCopies(IHS_Session *session, const ProtobufCMessage *message, IHS_Buffer *body,
+                               uint64_t sequence) {
+    size_t messageSize = protobuf_c_message_get_packed_size(message);
+    uint8_t *serialized = calloc(1, messageSize);
+    size_t serializedLen = protobuf_c_message_pack(message, serialized);
+
+    size_t plainLen = sizeof(uint64_t) + serializedLen;
+    uint8_t *plain = malloc(plainLen);
+    IHS_WriteUInt64LE(plain, sequence);
+    memcpy(&plain[sizeof(uint64_t)], serialized, serializedLen);
+
+    size_t cipherSize = EncryptedCapacity(messageSize);
+    uint8_t *cipher = IHS_BufferPointerForAppend(body, cipherSize);
+    IHS_MutexLock(session->crypto.hmacLock);
+    IHS_CryptoHMACCompute(session->crypto.hmac, plain, plainLen, cipher);
+    IHS_MutexUnlock(session->crypto.hmacLock);
+    cipherSize -= HMAC_SIZE;
+    IHS_CryptoCipherEncryptWithIV(session->crypto.cipher, plain, plainLen, cipher, HMAC_SIZE, false,
+                                  &cipher[HMAC_SIZE], &cipherSize);
+    body->size += HMAC_SIZE + cipherSize;
+    free(plain);
+    free(serialized);
+    return body->size;
+}
+
+/**
+ * Message is packed into the frame body, and encrypted where it is
+ */
+static size_t EncodeInPlace(IHS_Session *session, const ProtobufCMessage *message, IHS_Buffer *body,
+                            uint64_t sequence) {
+    size_t cipherCapacity = EncryptedCapacity(protobuf_c_message_get_packed_size(message));
+    uint8_t *cipher = IHS_BufferPointerForAppend(body, cipherCapacity);
+    size_t cipherSize = protobuf_c_message_pack(message, &cipher[IHS_SESSION_FRAME_ENCRYPT_HEADER_SIZE]);
+    IHS_SessionFrameEncryptInPlace(session, cipher, &cipherSize, cipherCapacity, sequence);
+    body->size += cipherSize;
+    return body->size;
+}
+
+static void Benchmark(const char *name, EncodeFunction *encode, IHS_Session *session,
+                      const ProtobufCMessage *message) {
+    IHS_Buffer body;
+    IHS_BufferInit(&body, 256, 256);
+    double start = NowSeconds();
+    for (int i = 0; i < ITERATIONS; i++) {
+        IHS_BufferClear(&body, false);
+        encode(session, message, &body, i);
+    }
+    double elapsed = NowSeconds() - start;
+    printf("%-10s %6.1f ns/message\n", name, elapsed * 1e9 / ITERATIONS);
+    IHS_BufferClear(&body, true);
+}
+
+static size_t EncryptedCapacity(size_t messageSize) {
+    /* iv + pkcs7pad(sequence + message) */
+    return HMAC_SIZE + ((messageSize + sizeof(uint64_t)) / IHS_CRYPTO_AES_BLOCK_SIZE + 1) * IHS_CRYPTO_AES_BLOCK_SIZE;
+}
+
+static double NowSeconds() {
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (double) tp.tv_sec + (double) tp.tv_nsec / 1e9;
+}
@@ -0,0 +1,74 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "crc32c.h"
+
+#define PACKET_SIZE 1400
+#define ITERATIONS 200000
+
+typedef uint32_t (CRC32CFunction)(const uint8_t *buf, size_t len);
+
+static void Benchmark(const char *name, CRC32CFunction *fn, const uint8_t *data);
+
+static double NowSeconds();
+
+int main() {
+    IHS_CRC32CInit();
+    uint8_t *data = malloc(PACKET_SIZE);
+    for (int i = 0; i < PACKET_SIZE; i++) {
+        data[i] = (uint8_t) rand();
+    }
+    Benchmark("table", IHS_CRC32CTable, data);
+    Benchmark("slicing-by-8", IHS_CRC32CSlicing8, data);
+    if (IHS_CRC32CHardwareSupported()) {
+        Benchmark("hardware", IHS_CRC32CHardware, data);
+    } else {
+        printf("%-14s not supported\n", "hardware");
+    }
+    Benchmark("dispatched", IHS_CRC32C, data);
+    free(data);
+    return 0;
+}
+
+static void Benchmark(const char *name, CRC32CFunction *fn, const uint8_t *data) {
+    volatile uint32_t sink = 0;
+    double start = NowSeconds();
+    for (int i = 0; i < ITERATIONS; i++) {
+        sink ^= fn(data, PACKET_SIZE);
+    }
+    double elapsed = NowSeconds() - start;
+    double megabytes = (double) PACKET_SIZE * ITERATIONS / (1024 * 1024);
+    printf("%-14s %8.1f MB/s, %6.1f ns/packet\n", name, megabytes / elapsed, elapsed * 1e9 / ITERATIONS);
+    (void) sink;
+}
+
+static double NowSeconds() {
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (double) tp.tv_sec + (double) tp.tv_nsec / 1e9;
+}
@@ -0,0 +1,118 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "crypto.h"
+
+#define PACKET_SIZE 1200
+#define HMAC_SIZE 16
+#define ITERATIONS 50000
+
+static void BenchmarkOneShot(const uint8_t *key, const uint8_t *packet, size_t packetLen, uint8_t *out);
+
+static void BenchmarkCached(const uint8_t *key, const uint8_t *packet, size_t packetLen, uint8_t *out);
+
+static void PrintResult(const char *name, double elapsed);
+
+static double NowSeconds();
+
+int main() {
+    uint8_t key[32];
+    for (int i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t) rand();
+    }
+    uint8_t *plain = malloc(PACKET_SIZE);
+    for (int i = 0; i < PACKET_SIZE; i++) {
+        plain[i] = (uint8_t) rand();
+    }
+    /* Same layout as encrypted control frames: HMAC of plain data, used as IV, followed by cipher text */
+    size_t packetLen = HMAC_SIZE + PACKET_SIZE + IHS_CRYPTO_AES_BLOCK_SIZE;
+    uint8_t *packet = malloc(packetLen), *out = malloc(packetLen);
+    IHS_CryptoHMAC *hmac = IHS_CryptoHMACCreate(IHS_CryptoHMACMD5, key, sizeof(key));
+    IHS_CryptoHMACCompute(hmac, plain, PACKET_SIZE, packet);
+    IHS_CryptoHMACDestroy(hmac);
+    size_t cipherLen = packetLen - HMAC_SIZE;
+    IHS_CryptoSymmetricEncryptWithIV(plain, PACKET_SIZE, packet, HMAC_SIZE, key, sizeof(key), false,
+                                     &packet[HMAC_SIZE], &cipherLen);
+    packetLen = HMAC_SIZE + cipherLen;
+
+    BenchmarkOneShot(key, packet, packetLen, out);
+    BenchmarkCached(key, packet, packetLen, out);
+
+    free(plain);
+    free(packet);
+    free(out);
+    return 0;
+}
+
+/**
+ * Key schedule and HMAC pads are computed for every packet
+ */
+static void BenchmarkOneShot(const uint8_t *key, const uint8_t *packet, size_t packetLen, uint8_t *out) {
+    uint8_t hash[HMAC_SIZE];
+    double start = NowSeconds();
+    for (int i = 0; i < ITERATIONS; i++) {
+        size_t outLen = packetLen;
+        IHS_CryptoSymmetricDecryptWithIV(&packet[HMAC_SIZE], packetLen - HMAC_SIZE, packet, HMAC_SIZE, key, 32,
+                                         out, &outLen);
+        IHS_CryptoHMAC *hmac = IHS_CryptoHMACCreate(IHS_CryptoHMACMD5, key, 32);
+        IHS_CryptoHMACCompute(hmac, out, outLen, hash);
+        IHS_CryptoHMACDestroy(hmac);
+    }
+    PrintResult("one-shot", NowSeconds() - start);
+}
+
+/**
+ * Key schedule and HMAC pads are computed once for the session
+ */
+static void BenchmarkCached(const uint8_t *key, const uint8_t *packet, size_t packetLen, uint8_t *out) {
+    uint8_t hash[HMAC_SIZE];
+    IHS_CryptoCipher *cipher = IHS_CryptoCipherCreate(key, 32);
+    IHS_CryptoHMAC *hmac = IHS_CryptoHMACCreate(IHS_CryptoHMACMD5, key, 32);
+    double start = NowSeconds();
+    for (int i = 0; i < ITERATIONS; i++) {
+        size_t outLen = packetLen;
+        IHS_CryptoCipherDecryptWithIV(cipher, &packet[HMAC_SIZE], packetLen - HMAC_SIZE, packet, HMAC_SIZE,
+                                      out, &outLen);
+        IHS_CryptoHMACCompute(hmac, out, outLen, hash);
+    }
+    PrintResult("cached", NowSeconds() - start);
+    IHS_CryptoHMACDestroy(hmac);
+    IHS_CryptoCipherDestroy(cipher);
+}
+
+static void PrintResult(const char *name, double elapsed) {
+    double megabytes = (double) PACKET_SIZE * ITERATIONS / (1024 * 1024);
+    printf("%-10s %8.1f MB/s, %6.1f ns/packet\n", name, megabytes / elapsed, elapsed * 1e9 / ITERATIONS);
+}
+
+static double NowSeconds() {
+    struct timespec tp;
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return (double) tp.tv_sec + (double) tp.tv_nsec / 1e9;
+}
@@ -0,0 +1,123 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2024 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <unistd.h>
+
+#include "session/input_coalescer.h"
+
+typedef struct Flushed {
+    IHS_InputMotion motions[16];
+    int count;
+} Flushed;
+
+static void TestMerge(IHS_Timer *timer);
+
+static void TestTick(IHS_Timer *timer);
+
+static void MotionFlushed(const IHS_InputMotion *motion, void *context);
+
+int main() {
+    IHS_TimerInit();
+    IHS_Timer *timer = IHS_TimerCreate();
+    TestMerge(timer);
+    TestTick(timer);
+    IHS_TimerDestroy(timer);
+    IHS_TimerQuit();
+    return 0;
+}
+
+static void TestMerge(IHS_Timer *timer) {
+    Flushed flushed = {.count = 0};
+    IHS_InputCoalescer *coalescer = IHS_InputCoalescerCreate(timer, MotionFlushed, &flushed);
+    IHS_InputMotion relative = {.type = IHS_InputMotionRelative, .dx = 1, .dy = -2};
+    IHS_InputMotion absolute = {.type = IHS_InputMotionAbsolute, .x = 0.5f, .y = 0.25f};
+    IHS_InputMotion finger1 = {.type = IHS_InputMotionTouch, .x = 0.1f, .y = 0.1f, .fingerId = 1};
+    IHS_InputMotion finger2 = {.type = IHS_InputMotionTouch, .x = 0.2f, .y = 0.2f, .fingerId = 2};
+
+    /* Disabled by default */
+    assert(!IHS_InputCoalescerAdd(coalescer, &relative));
+
+    IHS_InputCoalescerSetInterval(coalescer, 1000);
+    for (int i = 0; i < 10; i++) {
+        assert(IHS_InputCoalescerAdd(coalescer, &relative));
+        assert(IHS_InputCoalescerAdd(coalescer, &finger1));
+    }
+    assert(IHS_InputCoalescerAdd(coalescer, &finger2));
+    /* Absolute motion goes after relative motion, and following relative motion goes after it */
+    assert(IHS_InputCoalescerAdd(coalescer, &absolute));
+    assert(IHS_InputCoalescerAdd(coalescer, &relative));
+    finger1.x = 0.9f;
+    assert(IHS_InputCoalescerAdd(coalescer, &finger1));
+    assert(flushed.count == 0);
+
+    IHS_InputCoalescerFlushAndHold(coalescer);
+    IHS_InputCoalescerRelease(coalescer);
+    assert(flushed.count == 5);
+    assert(flushed.motions[0].type == IHS_InputMotionRelative);
+    assert(flushed.motions[0].dx == 10 && flushed.motions[0].dy == -20);
+    assert(flushed.motions[1].type == IHS_InputMotionTouch);
+    assert(flushed.motions[1].fingerId == 1 && flushed.motions[1].x == 0.9f);
+    assert(flushed.motions[2].fingerId == 2);
+    assert(flushed.motions[3].type == IHS_InputMotionAbsolute);
+    assert(flushed.motions[4].type == IHS_InputMotionRelative);
+    assert(flushed.motions[4].dx == 1 && flushed.motions[4].dy == -2);
+
+    /* Disabling sends what's left */
+    assert(IHS_InputCoalescerAdd(coalescer, &absolute));
+    IHS_InputCoalescerSetInterval(coalescer, 0);
+    assert(flushed.count == 6);
+    assert(!IHS_InputCoalescerAdd(coalescer, &absolute));
+    IHS_InputCoalescerDestroy(coalescer);
+}
+
+static void TestTick(IHS_Timer *timer) {
+    Flushed flushed = {.count = 0};
+    IHS_InputCoalescer *coalescer = IHS_InputCoalescerCreate(timer, MotionFlushed, &flushed);
+    IHS_InputCoalescerSetInterval(coalescer, 10);
+    IHS_InputMotion relative = {.type = IHS_InputMotionRelative, .dx = 3, .dy = 4};
+    assert(IHS_InputCoalescerAdd(coalescer, &relative));
+    assert(IHS_InputCoalescerAdd(coalescer, &relative));
+    usleep(50000);
+    IHS_InputCoalescerFlushAndHold(coalescer);
+    assert(flushed.count == 1);
+    assert(flushed.motions[0].dx == 6 && flushed.motions[0].dy == 8);
+    IHS_InputCoalescerRelease(coalescer);
+
+    /* Next tick is scheduled again */
+    assert(IHS_InputCoalescerAdd(coalescer, &relative));
+    usleep(50000);
+    IHS_InputCoalescerFlushAndHold(coalescer);
+    assert(flushed.count == 2);
+    IHS_InputCoalescerRelease(coalescer);
+    IHS_InputCoalescerSetInterval(coalescer, 0);
+    IHS_InputCoalescerDestroy(coalescer);
+}
+
+static void MotionFlushed(const IHS_InputMotion *motion, void *context) {
+    Flushed *flushed = context;
+    assert(flushed->count < 16);
+    flushed->motions[flushed->count++] = *motion;
+}
@@ -0,0 +1,124 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <assert.h>
+
+#include "session/playout.h"
+#include "session/packet.h"
+
+#define MS(millis) IHS_SESSION_PACKET_TIMESTAMP_FROM_MILLIS(millis)
+
+static void TestSteadyStream();
+
+static void TestJitterHold();
+
+static void TestTimestampWrap();
+
+int main() {
+    TestSteadyStream();
+    TestJitterHold();
+    TestTimestampWrap();
+    return 0;
+}
+
+static void TestSteadyStream() {
+    IHS_SessionPlayout *playout = IHS_SessionPlayoutCreate();
+    assert(!IHS_SessionPlayoutEnabled(playout));
+    IHS_SessionPlayoutConfig config = {.targetLatency = 30};
+    IHS_SessionPlayoutSetConfig(playout, &config);
+    assert(IHS_SessionPlayoutEnabled(playout));
+
+    uint32_t waitMs = 0;
+    /* Nothing known yet, release complete frames right away */
+    assert(IHS_SessionPlayoutSchedule(playout, MS(0), true, 1000, &waitMs) == IHS_SessionPlayoutRelease);
+
+    /* Constant 5ms transit time */
+    for (int i = 0; i < 10; i++) {
+        IHS_SessionPlayoutPacketArrived(playout, MS(i * 16), 1005 + i * 16);
+    }
+    assert(IHS_SessionPlayoutSchedule(playout, MS(144), true, 1149, &waitMs) == IHS_SessionPlayoutRelease);
+
+    /* Incomplete frame waits until 30ms after it should arrive */
+    assert(IHS_SessionPlayoutSchedule(playout, MS(144), false, 1150, &waitMs) == IHS_SessionPlayoutWait);
+    assert(waitMs >= 28 && waitMs <= 30);
+    assert(IHS_SessionPlayoutSchedule(playout, MS(144), false, 1180, &waitMs) == IHS_SessionPlayoutDrop);
+    assert(IHS_SessionPlayoutSchedule(playout, MS(144), true, 1180, &waitMs) == IHS_SessionPlayoutDrop);
+
+    IHS_SessionPlayoutStats stats;
+    IHS_SessionPlayoutGetStats(playout, &stats);
+    assert(stats.jitter < 1000);
+    assert(stats.framesIncomplete == 1);
+    assert(stats.framesLate == 1);
+    IHS_SessionPlayoutDestroy(playout);
+}
+
+static void TestJitterHold() {
+    IHS_SessionPlayout *playout = IHS_SessionPlayoutCreate();
+    IHS_SessionPlayoutConfig config = {.targetLatency = 80};
+    IHS_SessionPlayoutSetConfig(playout, &config);
+
+    /* Transit time alternates between 5ms and 15ms */
+    for (int i = 0; i < 200; i++) {
+        IHS_SessionPlayoutPacketArrived(playout, MS(i * 16), 1005 + i * 16 + (i % 2) * 10);
+    }
+    IHS_SessionPlayoutStats stats;
+    IHS_SessionPlayoutGetStats(playout, &stats);
+    assert(stats.jitter > 8000 && stats.jitter < 11000);
+
+    /* Frame arrived without delay is held for twice the jitter */
+    uint32_t waitMs = 0;
+    assert(IHS_SessionPlayoutSchedule(playout, MS(3200), true, 4205, &waitMs) == IHS_SessionPlayoutWait);
+    assert(waitMs >= 15 && waitMs <= 23);
+    assert(IHS_SessionPlayoutSchedule(playout, MS(3200), true, 4205 + 23, &waitMs) == IHS_SessionPlayoutRelease);
+
+    /* Holding never exceeds target latency */
+    config.targetLatency = 10;
+    IHS_SessionPlayoutSetConfig(playout, &config);
+    assert(IHS_SessionPlayoutSchedule(playout, MS(3200), true, 4205, &waitMs) == IHS_SessionPlayoutWait);
+    assert(waitMs <= 10);
+
+    /* New stream forgets timing, but keeps stats */
+    IHS_SessionPlayoutReset(playout);
+    IHS_SessionPlayoutGetStats(playout, &stats);
+    assert(stats.jitter == 0);
+    assert(IHS_SessionPlayoutSchedule(playout, MS(0), true, 0, &waitMs) == IHS_SessionPlayoutRelease);
+    IHS_SessionPlayoutDestroy(playout);
+}
+
+static void TestTimestampWrap() {
+    IHS_SessionPlayout *playout = IHS_SessionPlayoutCreate();
+    IHS_SessionPlayoutConfig config = {.targetLatency = 30};
+    IHS_SessionPlayoutSetConfig(playout, &config);
+    uint32_t start = UINT32_MAX - MS(50);
+    for (int i = 0; i < 10; i++) {
+        IHS_SessionPlayoutPacketArrived(playout, start + MS(i * 16), 1005 + i * 16);
+    }
+    IHS_SessionPlayoutStats stats;
+    IHS_SessionPlayoutGetStats(playout, &stats);
+    assert(stats.jitter < 1000);
+    uint32_t waitMs = 0;
+    assert(IHS_SessionPlayoutSchedule(playout, start + MS(144), true, 1149, &waitMs) == IHS_SessionPlayoutRelease);
+    assert(IHS_SessionPlayoutSchedule(playout, start + MS(144), false, 1150, &waitMs) == IHS_SessionPlayoutWait);
+    IHS_SessionPlayoutDestroy(playout);
+}
@@ -0,0 +1,197 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "test_session.h"
+#include "session/retransmission.h"
+
+static void TestCollisions(IHS_SessionRetransmission *retransmission);
+
+static void TestGrow(IHS_SessionRetransmission *retransmission);
+
+static void TestReplace(IHS_SessionRetransmission *retransmission);
+
+static void TestEarlyAck(IHS_SessionRetransmission *retransmission);
+
+static void QueuePacket(IHS_SessionRetransmission *retransmission, uint16_t packetId, uint8_t payload);
+
+static bool TryQueuePacket(IHS_SessionRetransmission *retransmission, uint16_t packetId, uint8_t payload);
+
+/**
+ * Queue the packet alone in the table, and find the slot it lands in
+ */
+static size_t HomeOf(IHS_SessionRetransmission *retransmission, uint16_t packetId);
+
+static bool SlotUsed(IHS_SessionRetransmission *retransmission, size_t pos);
+
+int main() {
+    IHS_Init();
+    IHS_Session *session = IHS_TestSessionCreate();
+    IHS_SessionRetransmission *retransmission = &session->retransmission;
+    /* Longest timeout, so nothing gets retransmitted during the test */
+    IHS_SessionRTTSample(&retransmission->rtt, 1000000);
+    TestCollisions(retransmission);
+    TestGrow(retransmission);
+    TestReplace(retransmission);
+    TestEarlyAck(retransmission);
+    IHS_SessionDestroy(session);
+    IHS_Quit();
+    return 0;
+}
+
+static void TestCollisions(IHS_SessionRetransmission *retransmission) {
+    /* Find 3 keys with the same home slot */
+    uint16_t keys[3];
+    size_t home = HomeOf(retransmission, 0);
+    int found = 0;
+    keys[found++] = 0;
+    for (uint16_t packetId = 1; found < 3; packetId++) {
+        assert(packetId != 0);
+        if (HomeOf(retransmission, packetId) == home) {
+            keys[found++] = packetId;
+        }
+    }
+    size_t mask = retransmission->tableSize - 1;
+
+    /* Colliding keys are probed into following slots */
+    for (int i = 0; i < 3; i++) {
+        QueuePacket(retransmission, keys[i], 0);
+    }
+    assert(retransmission->count == 3);
+    for (size_t i = 0; i < 3; i++) {
+        assert(SlotUsed(retransmission, (home + i) & mask));
+    }
+    assert(!SlotUsed(retransmission, (home + 3) & mask));
+
+    /* Remove from the middle of the chain, last key is shifted back */
+    assert(IHS_RetransmissionCancel(retransmission, 1, keys[1], 0));
+    assert(SlotUsed(retransmission, home));
+    assert(SlotUsed(retransmission, (home + 1) & mask));
+    assert(!SlotUsed(retransmission, (home + 2) & mask));
+    assert(!IHS_RetransmissionCancel(retransmission, 1, keys[1], 0));
+    assert(IHS_RetransmissionCancel(retransmission, 1, keys[2], 0));
+    assert(IHS_RetransmissionCancel(retransmission, 1, keys[0], 0));
+    assert(retransmission->count == 0);
+    assert(!SlotUsed(retransmission, home));
+}
+
+static void TestGrow(IHS_SessionRetransmission *retransmission) {
+    size_t initialCapacity = retransmission->capacity;
+    assert(initialCapacity == 64);
+    for (uint16_t packetId = 0; packetId < 200; packetId++) {
+        QueuePacket(retransmission, packetId, (uint8_t) packetId);
+    }
+    assert(retransmission->count == 200);
+    assert(retransmission->capacity >= 200);
+    assert(retransmission->tableSize == retransmission->capacity * 2);
+    /* Every entry can still be found after rehashing */
+    for (uint16_t packetId = 0; packetId < 200; packetId += 2) {
+        assert(IHS_RetransmissionCancel(retransmission, 1, packetId, 0));
+    }
+    for (uint16_t packetId = 1; packetId < 200; packetId += 2) {
+        assert(IHS_RetransmissionCancel(retransmission, 1, packetId, 0));
+    }
+    assert(retransmission->count == 0);
+}
+
+static void TestReplace(IHS_SessionRetransmission *retransmission) {
+    QueuePacket(retransmission, 42, 1);
+    /* Same ID again, the pending one is replaced instead of added */
+    QueuePacket(retransmission, 42, 2);
+    assert(retransmission->count == 1);
+    QueuePacket(retransmission, 43, 3);
+    assert(retransmission->count == 2);
+    assert(IHS_RetransmissionCancel(retransmission, 1, 43, 0));
+    assert(IHS_RetransmissionCancel(retransmission, 1, 42, 0));
+    assert(!IHS_RetransmissionCancel(retransmission, 1, 42, 0));
+    assert(retransmission->count == 0);
+}
+
+static void TestEarlyAck(IHS_SessionRetransmission *retransmission) {
+    /* ACK arrives while the packet is being sent, it's dropped instead of queued */
+    IHS_RetransmissionBeginSend(retransmission);
+    assert(!IHS_RetransmissionCancel(retransmission, 1, 50, 0));
+    assert(!TryQueuePacket(retransmission, 50, 0));
+    QueuePacket(retransmission, 51, 0);
+    /* The ACK is used up */
+    QueuePacket(retransmission, 50, 0);
+    IHS_RetransmissionEndSend(retransmission);
+    assert(retransmission->count == 2);
+    assert(IHS_RetransmissionCancel(retransmission, 1, 50, 0));
+    assert(IHS_RetransmissionCancel(retransmission, 1, 51, 0));
+
+    /* Duplicate ACKs outside of sending, or not matched before sending ends, are not remembered */
+    assert(!IHS_RetransmissionCancel(retransmission, 1, 52, 0));
+    IHS_RetransmissionBeginSend(retransmission);
+    assert(!IHS_RetransmissionCancel(retransmission, 1, 53, 0));
+    IHS_RetransmissionEndSend(retransmission);
+    QueuePacket(retransmission, 52, 0);
+    QueuePacket(retransmission, 53, 0);
+    assert(retransmission->count == 2);
+    assert(IHS_RetransmissionCancel(retransmission, 1, 52, 0));
+    assert(IHS_RetransmissionCancel(retransmission, 1, 53, 0));
+    assert(retransmission->count == 0);
+}
+
+static void QueuePacket(IHS_SessionRetransmission *retransmission, uint16_t packetId, uint8_t payload) {
+    assert(TryQueuePacket(retransmission, packetId, payload));
+}
+
+static bool TryQueuePacket(IHS_SessionRetransmission *retransmission, uint16_t packetId, uint8_t payload) {
+    IHS_SessionPacket packet;
+    memset(&packet, 0, sizeof(IHS_SessionPacket));
+    IHS_SessionPacketBodyInitialize(&packet.body, false);
+    IHS_BufferAppendMem(&packet.body, &payload, 1);
+    packet.header.channelId = 1;
+    packet.header.packetId = packetId;
+    /* Already sent once, so cancelling it doesn't take RTT samples */
+    packet.header.retransmitCount = 1;
+    bool queued = IHS_RetransmissionQueue(retransmission, &packet, IHS_SessionSendClassInteractive);
+    IHS_SessionPacketClear(&packet, true);
+    return queued;
+}
+
+static size_t HomeOf(IHS_SessionRetransmission *retransmission, uint16_t packetId) {
+    assert(retransmission->count == 0);
+    QueuePacket(retransmission, packetId, 0);
+    size_t home = SIZE_MAX;
+    for (size_t i = 0; i < retransmission->tableSize; i++) {
+        if (SlotUsed(retransmission, i)) {
+            home = i;
+        }
+    }
+    assert(home != SIZE_MAX);
+    assert(IHS_RetransmissionCancel(retransmission, 1, packetId, 0));
+    return home;
+}
+
+static bool SlotUsed(IHS_SessionRetransmission *retransmission, size_t pos) {
+    IHS_MutexLock(retransmission->lock);
+    bool used = retransmission->table[pos] >= 0;
+    IHS_MutexUnlock(retransmission->lock);
+    return used;
+}
@@ -0,0 +1,84 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+
+#include "session/rtt.h"
+
+static void TestInitial();
+
+static void TestConverge();
+
+static void TestBackoff();
+
+int main() {
+    TestInitial();
+    TestConverge();
+    TestBackoff();
+    return 0;
+}
+
+static void TestInitial() {
+    IHS_SessionRTT rtt;
+    IHS_SessionRTTInit(&rtt);
+    assert(!rtt.measured);
+    assert(IHS_SessionRTTTimeout(&rtt, 1) == 10);
+
+    /* First sample: SRTT = R, RTTVAR = R / 2, RTO = R + 4 * R / 2 */
+    IHS_SessionRTTSample(&rtt, 20000);
+    assert(rtt.measured);
+    assert(rtt.srtt == 20000);
+    assert(rtt.rttvar == 10000);
+    assert(rtt.rto == 60);
+}
+
+static void TestConverge() {
+    IHS_SessionRTT rtt;
+    IHS_SessionRTTInit(&rtt);
+    /* Stable sub-millisecond LAN round trips end up at the minimum timeout */
+    for (int i = 0; i < 50; i++) {
+        IHS_SessionRTTSample(&rtt, 500);
+    }
+    assert(rtt.srtt == 500);
+    assert(rtt.rttvar < 10);
+    assert(rtt.rto == 2);
+
+    /* A spike raises variance, and the timeout along with it */
+    IHS_SessionRTTSample(&rtt, 40500);
+    assert(rtt.srtt == 5500);
+    assert(rtt.rttvar >= 10000);
+    assert(rtt.rto >= 45);
+}
+
+static void TestBackoff() {
+    IHS_SessionRTT rtt;
+    IHS_SessionRTTInit(&rtt);
+    IHS_SessionRTTSample(&rtt, 4000);
+    assert(rtt.rto == 12);
+    assert(IHS_SessionRTTTimeout(&rtt, 1) == 12);
+    assert(IHS_SessionRTTTimeout(&rtt, 2) == 24);
+    assert(IHS_SessionRTTTimeout(&rtt, 3) == 48);
+    assert(IHS_SessionRTTTimeout(&rtt, 20) == 1000);
+}
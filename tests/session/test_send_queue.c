@@ -0,0 +1,139 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include "session/send_queue.h"
+
+static void TestInteractiveFirst();
+
+static void TestFull();
+
+static void TestStats();
+
+static void Offer(IHS_SessionSendQueue *queue, uint16_t packetId, IHS_SessionSendClass sendClass);
+
+static void AssertPolled(IHS_SessionSendQueue *queue, int capacity, const uint16_t *expected, int count);
+
+int main() {
+    TestInteractiveFirst();
+    TestFull();
+    TestStats();
+    return 0;
+}
+
+static void TestInteractiveFirst() {
+    IHS_SessionSendQueue *queue = IHS_SessionSendQueueCreate(8);
+    assert(IHS_SessionSendQueueIsEmpty(queue));
+
+    Offer(queue, 1, IHS_SessionSendClassBulk);
+    Offer(queue, 2, IHS_SessionSendClassBulk);
+    Offer(queue, 3, IHS_SessionSendClassInteractive);
+    Offer(queue, 4, IHS_SessionSendClassInteractive);
+    Offer(queue, 5, IHS_SessionSendClassBulk);
+    assert(!IHS_SessionSendQueueIsEmpty(queue));
+
+    /* A short batch is filled by interactive packets before any bulk one */
+    const uint16_t first[] = {3, 4, 1};
+    AssertPolled(queue, 3, first, 3);
+
+    /* Interactive packets queued later still overtake bulk ones left behind */
+    Offer(queue, 6, IHS_SessionSendClassInteractive);
+    const uint16_t second[] = {6, 2, 5};
+    AssertPolled(queue, 8, second, 3);
+    assert(IHS_SessionSendQueueIsEmpty(queue));
+
+    /* Packets never polled are released with the queue */
+    Offer(queue, 7, IHS_SessionSendClassBulk);
+    IHS_SessionSendQueueDestroy(queue);
+}
+
+static void TestFull() {
+    IHS_SessionSendQueue *queue = IHS_SessionSendQueueCreate(2);
+    Offer(queue, 1, IHS_SessionSendClassBulk);
+    Offer(queue, 2, IHS_SessionSendClassBulk);
+
+    /* Caller keeps the packet if the ring is full */
+    IHS_SessionPacket packet = {.header.packetId = 3};
+    IHS_SessionPacketBodyInitialize(&packet.body, false);
+    assert(!IHS_SessionSendQueueOffer(queue, &packet, false, IHS_SessionSendClassBulk));
+    assert(packet.body.data != NULL);
+
+    /* Rings don't share room */
+    assert(IHS_SessionSendQueueOffer(queue, &packet, false, IHS_SessionSendClassInteractive));
+
+    const uint16_t expected[] = {3, 1, 2};
+    AssertPolled(queue, 8, expected, 3);
+    IHS_SessionSendQueueDestroy(queue);
+}
+
+static void TestStats() {
+    IHS_SessionSendQueue *queue = IHS_SessionSendQueueCreate(8);
+    Offer(queue, 1, IHS_SessionSendClassBulk);
+    Offer(queue, 2, IHS_SessionSendClassInteractive);
+
+    IHS_SessionQueuedPacket batch[2];
+    assert(IHS_SessionSendQueuePoll(queue, batch, 2) == 2);
+    assert(batch[0].sendClass == IHS_SessionSendClassInteractive);
+    assert(batch[1].sendClass == IHS_SessionSendClassBulk);
+
+    /* Interactive packet leaves right away, bulk one waits for 100ms */
+    IHS_SessionSendQueueMarkSent(queue, &batch[0], batch[0].queuedAt);
+    IHS_SessionSendQueueMarkSent(queue, &batch[1], batch[1].queuedAt + 6554);
+    IHS_SessionQueuedPacketDestroy(&batch[0]);
+    IHS_SessionQueuedPacketDestroy(&batch[1]);
+
+    IHS_SessionSendStats stats;
+    IHS_SessionSendQueueGetStats(queue, IHS_SessionSendClassInteractive, &stats);
+    assert(stats.packetsSent == 1);
+    assert(stats.latency == 0);
+    assert(stats.maxLatency == 0);
+
+    uint32_t latency = IHS_SESSION_PACKET_TIMESTAMP_TO_MICROS(6554);
+    IHS_SessionSendQueueGetStats(queue, IHS_SessionSendClassBulk, &stats);
+    assert(stats.packetsSent == 1);
+    assert(stats.latency == latency / 16);
+    assert(stats.maxLatency == latency);
+
+    IHS_SessionSendQueueDestroy(queue);
+}
+
+static void Offer(IHS_SessionSendQueue *queue, uint16_t packetId, IHS_SessionSendClass sendClass) {
+    IHS_SessionPacket packet = {.header.packetId = packetId};
+    IHS_SessionPacketBodyInitialize(&packet.body, false);
+    assert(IHS_SessionSendQueueOffer(queue, &packet, false, sendClass));
+    assert(packet.body.data == NULL);
+}
+
+static void AssertPolled(IHS_SessionSendQueue *queue, int capacity, const uint16_t *expected, int count) {
+    IHS_SessionQueuedPacket batch[8];
+    assert(capacity <= 8);
+    assert(IHS_SessionSendQueuePoll(queue, batch, capacity) == count);
+    for (int i = 0; i < count; i++) {
+        assert(batch[i].packet.header.packetId == expected[i]);
+        IHS_SessionQueuedPacketDestroy(&batch[i]);
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <unistd.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "ihs_timer.h"
+
+typedef struct TaskContext {
+    uint64_t executedAt;
+    int order;
+    bool ended;
+} TaskContext;
+
+static int executionOrder = 0;
+
+static uint64_t TaskRunOnce(int runCount, void *context);
+
+static void TaskEnd(void *context);
+
+int main() {
+    IHS_TimerInit();
+    IHS_Timer *timer = IHS_TimerCreate();
+
+    // Timer thread is sleeping for the far deadline, an earlier task must wake it up
+    uint64_t start = IHS_TimerNow();
+    TaskContext far = {0}, near = {0};
+    IHS_TimerTaskStart(timer, TaskRunOnce, TaskEnd, 500, &far);
+    usleep(10000);
+    IHS_TimerTaskStart(timer, TaskRunOnce, TaskEnd, 20, &near);
+    usleep(100000);
+    assert(near.ended);
+    assert(near.executedAt - start < 100);
+    assert(!far.ended);
+
+    // Tasks with same deadline run in the order they were started
+    TaskContext first = {0}, second = {0};
+    IHS_TimerTaskStart(timer, TaskRunOnce, TaskEnd, 0, &first);
+    IHS_TimerTaskStart(timer, TaskRunOnce, TaskEnd, 0, &second);
+    usleep(50000);
+    assert(first.ended && second.ended);
+    assert(first.order < second.order);
+
+    // Stopping immediately ends the task before returning
+    TaskContext stopped = {0};
+    IHS_TimerTask *task = IHS_TimerTaskStart(timer, TaskRunOnce, TaskEnd, 1000, &stopped);
+    IHS_TimerTaskStopImmediate(task);
+    assert(stopped.ended);
+    assert(stopped.executedAt == 0);
+
+    // Remaining tasks are ended when timer gets destroyed
+    IHS_TimerDestroy(timer);
+    assert(far.ended);
+    assert(far.executedAt == 0);
+    // Rescheduling moves the deadline both ways
+    timer = IHS_TimerCreate();
+    TaskContext later = {0}, sooner = {0};
+    start = IHS_TimerNow();
+    task = IHS_TimerTaskStart(timer, TaskRunOnce, TaskEnd, 10, &later);
+    IHS_TimerTaskReschedule(task, 300);
+    task = IHS_TimerTaskStart(timer, TaskRunOnce, TaskEnd, 1000, &sooner);
+    IHS_TimerTaskReschedule(task, 20);
+    usleep(100000);
+    assert(sooner.ended);
+    assert(sooner.executedAt - start < 100);
+    assert(!later.ended);
+    usleep(300000);
+    assert(later.ended);
+    assert(later.executedAt - start >= 300);
+
+    IHS_TimerDestroy(timer);
+    IHS_TimerQuit();
+    return 0;
+}
+
+static uint64_t TaskRunOnce(int runCount, void *context) {
+    (void) runCount;
+    TaskContext *ctx = context;
+    ctx->executedAt = IHS_TimerNow();
+    ctx->order = ++executionOrder;
+    return 0;
+}
+
+static void TaskEnd(void *context) {
+    TaskContext *ctx = context;
+    ctx->ended = true;
+}
@@ -0,0 +1,150 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <unistd.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "ihs_timer.h"
+#include "ihs_thread.h"
+
+typedef void (StopFunction)(IHS_TimerTask *task);
+
+typedef struct BlockingTask {
+    IHS_Mutex *lock;
+    IHS_Cond *cond;
+    IHS_TimerTask *self;
+    /**
+     * Stop the task from its own run function
+     */
+    bool stopSelf;
+    StopFunction *stopFunction;
+    bool entered;
+    bool released;
+    bool returned;
+    bool ended;
+} BlockingTask;
+
+static void TestStopWhileRunning(IHS_Timer *timer, StopFunction *stop);
+
+static void TestStopSelf(IHS_Timer *timer, StopFunction *stop);
+
+static uint64_t TaskRunBlocking(int runCount, void *context);
+
+static void TaskEnd(void *context);
+
+static void ReleaseLater(void *context);
+
+int main() {
+    IHS_TimerInit();
+    IHS_Timer *timer = IHS_TimerCreate();
+
+    TestStopWhileRunning(timer, IHS_TimerTaskStop);
+    TestStopWhileRunning(timer, IHS_TimerTaskStopImmediate);
+    TestStopSelf(timer, IHS_TimerTaskStop);
+    TestStopSelf(timer, IHS_TimerTaskStopImmediate);
+
+    IHS_TimerDestroy(timer);
+    IHS_TimerQuit();
+    return 0;
+}
+
+static void TestStopWhileRunning(IHS_Timer *timer, StopFunction *stop) {
+    BlockingTask ctx = {.lock = IHS_MutexCreate(), .cond = IHS_CondCreate()};
+    IHS_TimerTask *task = IHS_TimerTaskStart(timer, TaskRunBlocking, TaskEnd, 0, &ctx);
+
+    IHS_MutexLock(ctx.lock);
+    while (!ctx.entered) {
+        IHS_CondWait(ctx.cond, ctx.lock);
+    }
+    IHS_MutexUnlock(ctx.lock);
+
+    // Run function is blocked, stopping must wait for it to return and the task to end
+    IHS_Thread *releaser = IHS_ThreadCreate(ReleaseLater, "ReleaseLater", &ctx);
+    stop(task);
+    IHS_MutexLock(ctx.lock);
+    assert(ctx.returned);
+    assert(ctx.ended);
+    IHS_MutexUnlock(ctx.lock);
+
+    IHS_ThreadJoin(releaser);
+    IHS_CondDestroy(ctx.cond);
+    IHS_MutexDestroy(ctx.lock);
+}
+
+static void TestStopSelf(IHS_Timer *timer, StopFunction *stop) {
+    BlockingTask ctx = {.lock = IHS_MutexCreate(), .cond = IHS_CondCreate(), .stopSelf = true, .stopFunction = stop,
+            .released = true};
+    // Run function waits for self to be assigned
+    IHS_MutexLock(ctx.lock);
+    ctx.self = IHS_TimerTaskStart(timer, TaskRunBlocking, TaskEnd, 0, &ctx);
+    // Stopping itself doesn't wait for its own run to return
+    while (!ctx.ended) {
+        IHS_CondWait(ctx.cond, ctx.lock);
+    }
+    assert(ctx.returned);
+    IHS_MutexUnlock(ctx.lock);
+
+    IHS_CondDestroy(ctx.cond);
+    IHS_MutexDestroy(ctx.lock);
+}
+
+static uint64_t TaskRunBlocking(int runCount, void *context) {
+    (void) runCount;
+    BlockingTask *ctx = context;
+    IHS_MutexLock(ctx->lock);
+    ctx->entered = true;
+    IHS_CondBroadcast(ctx->cond);
+    while (!ctx->released) {
+        IHS_CondWait(ctx->cond, ctx->lock);
+    }
+    IHS_TimerTask *self = ctx->self;
+    IHS_MutexUnlock(ctx->lock);
+    if (ctx->stopSelf) {
+        ctx->stopFunction(self);
+    }
+    IHS_MutexLock(ctx->lock);
+    ctx->returned = true;
+    IHS_MutexUnlock(ctx->lock);
+    // Keep running unless stopped
+    return 10;
+}
+
+static void TaskEnd(void *context) {
+    BlockingTask *ctx = context;
+    IHS_MutexLock(ctx->lock);
+    ctx->ended = true;
+    IHS_CondBroadcast(ctx->cond);
+    IHS_MutexUnlock(ctx->lock);
+}
+
+static void ReleaseLater(void *context) {
+    BlockingTask *ctx = context;
+    usleep(50000);
+    IHS_MutexLock(ctx->lock);
+    ctx->released = true;
+    IHS_CondBroadcast(ctx->cond);
+    IHS_MutexUnlock(ctx->lock);
+}
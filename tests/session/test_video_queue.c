@@ -0,0 +1,208 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "session/video_queue.h"
+#include "session/channels/video/frame_pool.h"
+#include "ihs_buffer.h"
+#include "ihs_buffer_ext.h"
+#include "ihs_thread.h"
+
+#define QUEUE_DEPTH 3
+
+/**
+ * Decoder that blocks until allowed to continue, and records ids of submitted frames
+ */
+typedef struct SlowDecoder {
+    IHS_Mutex *lock;
+    IHS_Cond *cond;
+    bool blocked;
+    int entered;
+    uint8_t submitted[16];
+    int numSubmitted;
+} SlowDecoder;
+
+static void TestDisabled();
+
+static void TestDropOldest();
+
+static void TestSkipToKeyFrame();
+
+static IHS_SessionVideoQueue *StartQueue(SlowDecoder *decoder, IHS_SessionVideoQueuePolicy policy);
+
+static IHS_StreamVideoFrame *NewFrame(IHS_VideoFramePool *pool, uint8_t id, bool keyFrame);
+
+static void DecoderSubmit(IHS_StreamVideoFrame *frame, void *context);
+
+static void DecoderWaitEntered(SlowDecoder *decoder, int entered);
+
+static void DecoderUnblock(SlowDecoder *decoder);
+
+static void DecoderWaitSubmitted(SlowDecoder *decoder, int count);
+
+int main() {
+    TestDisabled();
+    TestDropOldest();
+    TestSkipToKeyFrame();
+    return 0;
+}
+
+static void TestDisabled() {
+    IHS_SessionVideoQueue *queue = IHS_SessionVideoQueueCreate();
+    assert(!IHS_SessionVideoQueueStart(queue, DecoderSubmit, NULL));
+    IHS_SessionVideoQueueStop(queue);
+    IHS_SessionVideoQueueDestroy(queue);
+}
+
+static void TestDropOldest() {
+    IHS_VideoFramePool *pool = IHS_VideoFramePoolCreate(4);
+    SlowDecoder decoder = {.lock = IHS_MutexCreate(), .cond = IHS_CondCreate(), .blocked = true};
+    IHS_SessionVideoQueue *queue = StartQueue(&decoder, IHS_SessionVideoQueueDropOldest);
+
+    /* Decoder is stuck with frame 0 */
+    assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, 0, true)) == IHS_SessionVideoQueueQueued);
+    DecoderWaitEntered(&decoder, 1);
+    for (uint8_t id = 1; id <= QUEUE_DEPTH; id++) {
+        assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, id, false)) == IHS_SessionVideoQueueQueued);
+    }
+    /* Frame 1 makes room for frame 4 */
+    assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, 4, false)) == IHS_SessionVideoQueueDropped);
+
+    IHS_SessionVideoQueueStats stats;
+    IHS_SessionVideoQueueGetStats(queue, &stats);
+    assert(stats.depth == QUEUE_DEPTH);
+    assert(stats.framesDropped == 1);
+
+    DecoderUnblock(&decoder);
+    DecoderWaitSubmitted(&decoder, 4);
+    const uint8_t expected[] = {0, 2, 3, 4};
+    assert(memcmp(decoder.submitted, expected, sizeof(expected)) == 0);
+
+    IHS_SessionVideoQueueStop(queue);
+    IHS_SessionVideoQueueDestroy(queue);
+    IHS_CondDestroy(decoder.cond);
+    IHS_MutexDestroy(decoder.lock);
+    IHS_VideoFramePoolDestroy(pool);
+}
+
+static void TestSkipToKeyFrame() {
+    IHS_VideoFramePool *pool = IHS_VideoFramePoolCreate(4);
+    SlowDecoder decoder = {.lock = IHS_MutexCreate(), .cond = IHS_CondCreate(), .blocked = true};
+    IHS_SessionVideoQueue *queue = StartQueue(&decoder, IHS_SessionVideoQueueSkipToKeyFrame);
+
+    assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, 0, true)) == IHS_SessionVideoQueueQueued);
+    DecoderWaitEntered(&decoder, 1);
+    for (uint8_t id = 1; id <= QUEUE_DEPTH; id++) {
+        assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, id, false)) == IHS_SessionVideoQueueQueued);
+    }
+    /* Queue is flushed, and nothing is accepted until next keyframe */
+    assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, 4, false)) == IHS_SessionVideoQueueRequestKeyFrame);
+    assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, 5, false)) == IHS_SessionVideoQueueDropped);
+    assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, 6, true)) == IHS_SessionVideoQueueQueued);
+    assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, 7, false)) == IHS_SessionVideoQueueQueued);
+
+    IHS_SessionVideoQueueStats stats;
+    IHS_SessionVideoQueueGetStats(queue, &stats);
+    assert(stats.depth == 2);
+    assert(stats.framesDropped == QUEUE_DEPTH + 2);
+
+    DecoderUnblock(&decoder);
+    DecoderWaitSubmitted(&decoder, 3);
+    const uint8_t expected[] = {0, 6, 7};
+    assert(memcmp(decoder.submitted, expected, sizeof(expected)) == 0);
+
+    /* Frames left in the queue are released on stop */
+    IHS_MutexLock(decoder.lock);
+    decoder.blocked = true;
+    IHS_MutexUnlock(decoder.lock);
+    assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, 8, true)) == IHS_SessionVideoQueueQueued);
+    DecoderWaitEntered(&decoder, 4);
+    assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, 9, false)) == IHS_SessionVideoQueueQueued);
+    DecoderUnblock(&decoder);
+    IHS_SessionVideoQueueStop(queue);
+    assert(IHS_SessionVideoQueuePush(queue, NewFrame(pool, 10, true)) == IHS_SessionVideoQueueDropped);
+
+    IHS_SessionVideoQueueDestroy(queue);
+    IHS_CondDestroy(decoder.cond);
+    IHS_MutexDestroy(decoder.lock);
+    IHS_VideoFramePoolDestroy(pool);
+}
+
+static IHS_SessionVideoQueue *StartQueue(SlowDecoder *decoder, IHS_SessionVideoQueuePolicy policy) {
+    IHS_SessionVideoQueue *queue = IHS_SessionVideoQueueCreate();
+    IHS_SessionVideoQueueConfig config = {.depth = QUEUE_DEPTH, .policy = policy};
+    IHS_SessionVideoQueueSetConfig(queue, &config);
+    assert(IHS_SessionVideoQueueStart(queue, DecoderSubmit, decoder));
+    return queue;
+}
+
+static IHS_StreamVideoFrame *NewFrame(IHS_VideoFramePool *pool, uint8_t id, bool keyFrame) {
+    IHS_Buffer buffer = IHS_BUFFER_INIT(16, 16);
+    IHS_BufferAppendUInt8(&buffer, id);
+    IHS_StreamVideoFrameFlag flags = keyFrame ? IHS_StreamVideoFrameKeyFrame : IHS_StreamVideoFrameNone;
+    IHS_StreamVideoFrame *frame = IHS_VideoFramePoolWrap(pool, &buffer, NULL, id, flags);
+    IHS_BufferClear(&buffer, true);
+    return frame;
+}
+
+static void DecoderSubmit(IHS_StreamVideoFrame *frame, void *context) {
+    SlowDecoder *decoder = context;
+    IHS_MutexLock(decoder->lock);
+    decoder->entered++;
+    IHS_CondBroadcast(decoder->cond);
+    while (decoder->blocked) {
+        IHS_CondWait(decoder->cond, decoder->lock);
+    }
+    decoder->submitted[decoder->numSubmitted++] = IHS_BufferPointer(IHS_StreamVideoFrameGetData(frame))[0];
+    IHS_CondBroadcast(decoder->cond);
+    IHS_MutexUnlock(decoder->lock);
+    IHS_StreamVideoFrameRelease(frame);
+}
+
+static void DecoderWaitEntered(SlowDecoder *decoder, int entered) {
+    IHS_MutexLock(decoder->lock);
+    while (decoder->entered < entered) {
+        IHS_CondWait(decoder->cond, decoder->lock);
+    }
+    IHS_MutexUnlock(decoder->lock);
+}
+
+static void DecoderUnblock(SlowDecoder *decoder) {
+    IHS_MutexLock(decoder->lock);
+    decoder->blocked = false;
+    IHS_CondBroadcast(decoder->cond);
+    IHS_MutexUnlock(decoder->lock);
+}
+
+static void DecoderWaitSubmitted(SlowDecoder *decoder, int count) {
+    IHS_MutexLock(decoder->lock);
+    while (decoder->numSubmitted < count) {
+        IHS_CondWait(decoder->cond, decoder->lock);
+    }
+    IHS_MutexUnlock(decoder->lock);
+}
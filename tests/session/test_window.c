@@ -0,0 +1,284 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <assert.h>
+#include <string.h>
+
+#include "session/window.h"
+#include "ihs_buffer_ext.h"
+#include "session/channels/video/frame_h264.h"
+
+static void AddFrame(IHS_SessionPacketsWindow *window, uint16_t packetId, int fragments, uint8_t seed);
+
+/**
+ * Add one packet of a frame starting at firstId, with fragments + 1 packets
+ */
+static void AddPacket(IHS_SessionPacketsWindow *window, uint16_t firstId, uint16_t packetId, int16_t fragments);
+
+static void TestPollSegments();
+
+static void TestEscapeSegments();
+
+static void TestMissing();
+
+static void TestDiscardHead();
+
+static void TestDuplicateAfterPoll();
+
+int main() {
+    TestPollSegments();
+    TestEscapeSegments();
+    TestMissing();
+    TestDiscardHead();
+    TestDuplicateAfterPoll();
+    return 0;
+}
+
+static void TestPollSegments() {
+    IHS_BufferPool *pool = IHS_BufferPoolCreate(64, 16);
+    IHS_SessionPacketsWindow *window = IHS_SessionPacketsWindowCreate(16, pool);
+    AddFrame(window, 1, 3, 10);
+    AddFrame(window, 4, 1, 20);
+
+    IHS_SessionFrame frame;
+    IHS_BufferInit(&frame.body, 64, 1024);
+    assert(IHS_SessionPacketsWindowPoll(window, &frame));
+    assert(frame.body.size == 3 * 32);
+
+    IHS_SessionSegmentedFrame segmented;
+    IHS_SessionSegmentedFrameInit(&segmented, NULL);
+    assert(IHS_SessionPacketsWindowPollSegments(window, &segmented));
+    assert(segmented.count == 1);
+    assert(segmented.size == 32);
+    /* Slots are released as soon as the frame is polled */
+    assert(IHS_SessionPacketsWindowSize(window) == 0);
+    IHS_SessionSegmentedFrameRelease(&segmented);
+
+    AddFrame(window, 5, 3, 10);
+    assert(IHS_SessionPacketsWindowPollSegments(window, &segmented));
+    assert(segmented.count == 3);
+    assert(segmented.size == frame.body.size);
+    uint8_t gathered[3 * 32];
+    assert(IHS_SessionSegmentedFrameCopy(&segmented, 0, gathered, sizeof(gathered)) == sizeof(gathered));
+    assert(memcmp(gathered, IHS_BufferPointer(&frame.body), sizeof(gathered)) == 0);
+
+    /* Skip across segment boundary */
+    IHS_SessionSegmentedFrameOffsetBy(&segmented, 40);
+    assert(segmented.size == 3 * 32 - 40);
+    assert(segmented.segments[0].size == 0);
+    assert(segmented.segments[1].size == 24);
+    uint8_t byte;
+    assert(IHS_SessionSegmentedFrameCopy(&segmented, 0, &byte, 1) == 1);
+    assert(byte == gathered[40]);
+
+    /* Merged segment fits in a pool buffer, so it's taken from the pool */
+    IHS_Buffer *flattened = IHS_SessionSegmentedFrameFlatten(&segmented);
+    assert(flattened != NULL);
+    assert(flattened->capacity == 64);
+    assert(segmented.count == 1);
+    assert(segmented.size == 3 * 32 - 40);
+    assert(flattened->size == segmented.size);
+    assert(memcmp(IHS_BufferPointer(flattened), &gathered[40], flattened->size) == 0);
+    /* Already contiguous, returned as is */
+    assert(IHS_SessionSegmentedFrameFlatten(&segmented) == flattened);
+
+    IHS_SessionSegmentedFrameClear(&segmented);
+    IHS_BufferClear(&frame.body, true);
+    IHS_SessionPacketsWindowDestroy(window);
+
+    IHS_BufferPoolStats stats;
+    IHS_BufferPoolGetStats(pool, &stats);
+    /* Every packet buffer went back to the pool, including the merged one */
+    assert(stats.idle == 7);
+    assert(stats.inUse == 0);
+    IHS_BufferPoolDestroy(pool);
+}
+
+static void TestEscapeSegments() {
+    /* Zeros on segment boundaries must be escaped the same way as contiguous data */
+    const uint8_t data[] = {0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x03, 0x65, 0x00, 0x00};
+    IHS_VideoFrameHeader header = {.flags = VideoFrameFlagNeedEscape | VideoFrameFlagNeedStartSequence};
+
+    IHS_Buffer expected = IHS_BUFFER_INIT(64, 64);
+    IHS_SessionVideoFrameAppendH264(&expected, NULL, data, sizeof(data), 0, &header);
+
+    for (size_t split1 = 1; split1 < sizeof(data); split1++) {
+        for (size_t split2 = split1; split2 < sizeof(data); split2++) {
+            IHS_Buffer actual = IHS_BUFFER_INIT(64, 64);
+            IHS_SessionVideoFrameAppendH264(&actual, NULL, data, split1, 0, &header);
+            IHS_SessionVideoFrameAppendH264(&actual, NULL, &data[split1], split2 - split1, split1, &header);
+            IHS_SessionVideoFrameAppendH264(&actual, NULL, &data[split2], sizeof(data) - split2, split2, &header);
+            assert(actual.size == expected.size);
+            assert(memcmp(IHS_BufferPointer(&actual), IHS_BufferPointer(&expected), expected.size) == 0);
+            IHS_BufferClear(&actual, true);
+        }
+    }
+    IHS_BufferClear(&expected, true);
+}
+
+static void TestMissing() {
+    IHS_SessionPacketsWindow *window = IHS_SessionPacketsWindowCreate(16, NULL);
+    uint32_t ids[8];
+    AddFrame(window, 65533, 1, 0);
+    AddFrame(window, 65534, 1, 0);
+    /* 65535 and 0 are lost, across packet ID wrap around */
+    for (uint16_t id = 1; id <= 4; id++) {
+        AddFrame(window, id, 1, 0);
+    }
+    assert(IHS_SessionPacketsWindowMissingCount(window) == 2);
+    assert(IHS_SessionPacketsWindowCollectMissing(window, 3, ids, 8) == 2);
+    assert(ids[0] == 65535);
+    assert(ids[1] == 0);
+    /* Recently skipped packets may be just reordered */
+    assert(IHS_SessionPacketsWindowCollectMissing(window, 5, ids, 8) == 1);
+    assert(ids[0] == 65535);
+    assert(IHS_SessionPacketsWindowCollectMissing(window, 3, ids, 1) == 1);
+
+    /* Late packet fills the gap */
+    AddFrame(window, 0, 1, 0);
+    assert(IHS_SessionPacketsWindowMissingCount(window) == 1);
+    assert(IHS_SessionPacketsWindowCollectMissing(window, 0, ids, 8) == 1);
+    assert(ids[0] == 65535);
+
+    /* Frames after the gap are discarded with it */
+    IHS_SessionFrame frame;
+    IHS_BufferInit(&frame.body, 64, 1024);
+    for (int i = 0; i < 2; i++) {
+        assert(IHS_SessionPacketsWindowPoll(window, &frame));
+        IHS_SessionPacketsWindowReleaseFrame(&frame);
+    }
+    assert(!IHS_SessionPacketsWindowPoll(window, &frame));
+    IHS_SessionPacketsWindowDiscard(window, 0);
+    assert(IHS_SessionPacketsWindowMissingCount(window) == 0);
+    assert(IHS_SessionPacketsWindowCollectMissing(window, 0, ids, 8) == 0);
+
+    IHS_BufferClear(&frame.body, true);
+    IHS_SessionPacketsWindowDestroy(window);
+}
+
+static void TestDiscardHead() {
+    IHS_SessionPacketsWindow *window = IHS_SessionPacketsWindowCreate(16, NULL);
+    uint32_t timestamp;
+    assert(!IHS_SessionPacketsWindowHeadTimestamp(window, &timestamp));
+
+    /* Frame with 3 packets, the middle one is lost */
+    AddPacket(window, 1, 1, 2);
+    AddPacket(window, 1, 3, 2);
+    AddFrame(window, 4, 1, 0);
+    assert(!IHS_SessionPacketsWindowHasFrame(window));
+    /* Newest packet of the frame */
+    assert(IHS_SessionPacketsWindowHeadTimestamp(window, &timestamp));
+    assert(timestamp == 3);
+    assert(IHS_SessionPacketsWindowDiscardHead(window) == 3);
+    assert(IHS_SessionPacketsWindowMissingCount(window) == 0);
+    assert(IHS_SessionPacketsWindowHasFrame(window));
+    assert(IHS_SessionPacketsWindowHeadTimestamp(window, &timestamp));
+    assert(timestamp == 4);
+
+    IHS_SessionFrame frame;
+    IHS_BufferInit(&frame.body, 64, 1024);
+    assert(IHS_SessionPacketsWindowPoll(window, &frame));
+    IHS_SessionPacketsWindowReleaseFrame(&frame);
+    assert(!IHS_SessionPacketsWindowHeadTimestamp(window, &timestamp));
+
+    /* First packet is lost, frame ends at next frame head */
+    AddPacket(window, 5, 6, 1);
+    assert(IHS_SessionPacketsWindowHeadTimestamp(window, &timestamp));
+    assert(timestamp == 6);
+    AddFrame(window, 7, 1, 0);
+    assert(!IHS_SessionPacketsWindowHasFrame(window));
+    assert(IHS_SessionPacketsWindowDiscardHead(window) == 2);
+    assert(IHS_SessionPacketsWindowMissingCount(window) == 0);
+    assert(IHS_SessionPacketsWindowHasFrame(window));
+    assert(IHS_SessionPacketsWindowHeadTimestamp(window, &timestamp));
+    assert(timestamp == 7);
+
+    IHS_BufferClear(&frame.body, true);
+    IHS_SessionPacketsWindowDestroy(window);
+}
+
+static void TestDuplicateAfterPoll() {
+    IHS_SessionPacketsWindow *window = IHS_SessionPacketsWindowCreate(16, NULL);
+    IHS_SessionFrame frame;
+    IHS_BufferInit(&frame.body, 64, 1024);
+
+    AddFrame(window, 1, 1, 0);
+    assert(IHS_SessionPacketsWindowPoll(window, &frame));
+    IHS_SessionPacketsWindowReleaseFrame(&frame);
+
+    /* Duplicate of a consumed packet, while the window is empty */
+    AddFrame(window, 1, 1, 0);
+    assert(IHS_SessionPacketsWindowSize(window) == 0);
+    assert(IHS_SessionPacketsWindowMissingCount(window) == 0);
+    assert(!IHS_SessionPacketsWindowHasFrame(window));
+
+    /* Duplicate of the packet right before head, while the window is not empty */
+    AddFrame(window, 3, 1, 0);
+    assert(IHS_SessionPacketsWindowMissingCount(window) == 1);
+    AddFrame(window, 1, 1, 0);
+    assert(IHS_SessionPacketsWindowSize(window) == 2);
+    assert(IHS_SessionPacketsWindowMissingCount(window) == 1);
+
+    /* Late packet still fills the gap */
+    AddFrame(window, 2, 1, 0);
+    assert(IHS_SessionPacketsWindowMissingCount(window) == 0);
+    for (int i = 0; i < 2; i++) {
+        assert(IHS_SessionPacketsWindowPoll(window, &frame));
+        IHS_SessionPacketsWindowReleaseFrame(&frame);
+    }
+
+    IHS_BufferClear(&frame.body, true);
+    IHS_SessionPacketsWindowDestroy(window);
+}
+
+static void AddFrame(IHS_SessionPacketsWindow *window, uint16_t packetId, int fragments, uint8_t seed) {
+    for (int i = 0; i < fragments; i++) {
+        IHS_SessionPacket packet;
+        memset(&packet, 0, sizeof(IHS_SessionPacket));
+        packet.header.type = i == 0 ? IHS_SessionPacketTypeUnreliable : IHS_SessionPacketTypeUnreliableFrag;
+        packet.header.fragmentId = (int16_t) (i == 0 ? fragments - 1 : i);
+        packet.header.packetId = packetId + i;
+        packet.header.sendTimestamp = packet.header.packetId;
+        IHS_BufferInit(&packet.body, 64, 64);
+        for (int j = 0; j < 32; j++) {
+            IHS_BufferAppendUInt8(&packet.body, (uint8_t) (seed + i * 32 + j));
+        }
+        assert(IHS_SessionPacketsWindowAdd(window, &packet));
+        /* Ignored packets are still owned by the caller */
+        IHS_BufferClear(&packet.body, true);
+    }
+}
+
+static void AddPacket(IHS_SessionPacketsWindow *window, uint16_t firstId, uint16_t packetId, int16_t fragments) {
+    IHS_SessionPacket packet;
+    memset(&packet, 0, sizeof(IHS_SessionPacket));
+    bool head = packetId == firstId;
+    packet.header.type = head ? IHS_SessionPacketTypeUnreliable : IHS_SessionPacketTypeUnreliableFrag;
+    packet.header.fragmentId = (int16_t) (head ? fragments : packetId - firstId);
+    packet.header.packetId = packetId;
+    packet.header.sendTimestamp = packetId;
+    IHS_BufferInit(&packet.body, 64, 64);
+    IHS_BufferAppendUInt8(&packet.body, (uint8_t) packetId);
+    assert(IHS_SessionPacketsWindowAdd(window, &packet));
+}
@@ -0,0 +1,95 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "session/channels/video/frame_pool.h"
+#include "ihs_buffer.h"
+#include "ihs_buffer_ext.h"
+
+static void TestWrapAndRecycle();
+
+static void TestDestroyWhileReferenced();
+
+int main() {
+    TestWrapAndRecycle();
+    TestDestroyWhileReferenced();
+    return 0;
+}
+
+static void TestWrapAndRecycle() {
+    IHS_VideoFramePool *pool = IHS_VideoFramePoolCreate(2);
+    IHS_Buffer buffer = IHS_BUFFER_INIT(1024, 4096);
+    IHS_BufferFillMem(&buffer, 0, 0x42, 100);
+    uint8_t *assembled = IHS_BufferPointer(&buffer);
+
+    IHS_StreamVideoFrame *frame = IHS_VideoFramePoolWrap(pool, &buffer, NULL, 1, IHS_StreamVideoFrameKeyFrame);
+    /* Data is moved, not copied */
+    IHS_Buffer *data = IHS_StreamVideoFrameGetData(frame);
+    assert(IHS_BufferPointer(data) == assembled);
+    assert(data->size == 100);
+    assert(IHS_StreamVideoFrameGetFlags(frame) == IHS_StreamVideoFrameKeyFrame);
+    assert(IHS_StreamVideoFrameGetId(frame) == 1);
+    assert(buffer.size == 0);
+    assert(buffer.maxCapacity == 4096);
+
+    assert(IHS_StreamVideoFrameRetain(frame) == frame);
+    IHS_StreamVideoFrameRelease(frame);
+    assert(IHS_BufferPointer(data) == assembled);
+    IHS_StreamVideoFrameRelease(frame);
+
+    /* Storage of released frame goes back to the buffer on next wrap */
+    IHS_BufferFillMem(&buffer, 0, 0x43, 10);
+    IHS_StreamVideoFrame *frame2 = IHS_VideoFramePoolWrap(pool, &buffer, NULL, 2, IHS_StreamVideoFrameNone);
+    assert(frame2 == frame);
+    assert(IHS_StreamVideoFrameGetData(frame2)->size == 10);
+    assert(buffer.data == assembled);
+    assert(buffer.size == 0);
+    IHS_StreamVideoFrameRelease(frame2);
+
+    IHS_BufferClear(&buffer, true);
+    IHS_VideoFramePoolDestroy(pool);
+}
+
+static void TestDestroyWhileReferenced() {
+    IHS_VideoFramePool *pool = IHS_VideoFramePoolCreate(1);
+    IHS_Buffer buffer = IHS_BUFFER_INIT(1024, 4096);
+    IHS_BufferFillMem(&buffer, 0, 0x42, 100);
+    IHS_StreamVideoFrame *frame1 = IHS_VideoFramePoolWrap(pool, &buffer, NULL, 1, IHS_StreamVideoFrameNone);
+    IHS_BufferFillMem(&buffer, 0, 0x43, 100);
+    IHS_StreamVideoFrame *frame2 = IHS_VideoFramePoolWrap(pool, &buffer, NULL, 2, IHS_StreamVideoFrameNone);
+    /* Only one idle frame can be kept, the other will be freed */
+    IHS_StreamVideoFrameRelease(frame1);
+    IHS_StreamVideoFrameRelease(frame2);
+
+    IHS_BufferFillMem(&buffer, 0, 0x44, 100);
+    IHS_StreamVideoFrame *frame3 = IHS_VideoFramePoolWrap(pool, &buffer, NULL, 3, IHS_StreamVideoFrameNone);
+    IHS_BufferClear(&buffer, true);
+    /* Decoder may still hold frames after the video channel is gone */
+    IHS_VideoFramePoolDestroy(pool);
+    assert(IHS_BufferPointer(IHS_StreamVideoFrameGetData(frame3))[99] == 0x44);
+    IHS_StreamVideoFrameRelease(frame3);
+}
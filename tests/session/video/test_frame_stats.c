@@ -0,0 +1,256 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+
+#include "session/channels/video/frame_stats.h"
+#include "session/packet.h"
+
+#define MS(millis) IHS_SESSION_PACKET_TIMESTAMP_FROM_MILLIS(millis)
+
+static void TestDisplayed();
+
+static void TestDroppedBySkip();
+
+static void TestPendingTimeout();
+
+static void TestCapacity();
+
+static void TestExternalEvents();
+
+static void TestLatencyHistogram();
+
+static void DecodeFrame(IHS_VideoFrameStats *stats, uint16_t frameId, uint32_t begin, uint32_t end);
+
+static const CFrameStatAccumulatedValue *FindAccumulated(const CFrameStatsListMsg *message,
+                                                         EFrameAccumulatedStat type);
+
+int main() {
+    TestDisplayed();
+    TestDroppedBySkip();
+    TestPendingTimeout();
+    TestCapacity();
+    TestExternalEvents();
+    TestLatencyHistogram();
+    return 0;
+}
+
+static void TestDisplayed() {
+    IHS_VideoFrameStats *stats = IHS_VideoFrameStatsCreate(16);
+    uint32_t base = MS(1000);
+    /* Collect once to set the start of accumulation */
+    CFrameStatsListMsg message = CFRAME_STATS_LIST_MSG__INIT;
+    IHS_VideoFrameStatsCollect(stats, base, &message);
+    assert(message.n_stats == 0);
+
+    for (uint16_t i = 0; i < 10; i++) {
+        uint32_t recv = base + MS(i * 20);
+        IHS_VideoFrameStatsReceived(stats, i, 1000, recv);
+        DecodeFrame(stats, i, recv + MS(2), recv + MS(6));
+    }
+    /* Last frame is still decoding */
+    IHS_VideoFrameStatsReceived(stats, 10, 1000, base + MS(200));
+
+    IHS_VideoFrameStatsCollect(stats, base + MS(1000), &message);
+    assert(message.n_stats == 10);
+    for (size_t i = 0; i < message.n_stats; i++) {
+        const CFrameStats *item = message.stats[i];
+        assert(item->frame_id == i);
+        assert(item->result == k_EStreamFrameResultDisplayed);
+        assert(item->has_frame_size && item->frame_size == 1000);
+        assert(item->n_events == 4);
+        assert(item->events[0]->event_id == k_EStreamFrameEventRecv);
+        assert(item->events[0]->timestamp == base + MS(i * 20));
+    }
+    const CFrameStatAccumulatedValue *fps = FindAccumulated(&message, k_EFrameStatFPS);
+    assert(fps != NULL && fps->count == 10);
+    assert(fps->average > 9.9f && fps->average < 10.1f);
+    const CFrameStatAccumulatedValue *bitrate = FindAccumulated(&message, k_EFrameStatClientBitrateKbitPerSec);
+    assert(bitrate != NULL && bitrate->average > 79.9f && bitrate->average < 80.1f);
+    const CFrameStatAccumulatedValue *decode = FindAccumulated(&message, k_EFrameStatDecodeDurationMS);
+    assert(decode != NULL && decode->count == 10);
+    assert(decode->average > 3.9f && decode->average < 4.1f);
+    assert(decode->has_stddev && decode->stddev < 0.1f);
+    const CFrameStatAccumulatedValue *client = FindAccumulated(&message, k_EFrameStatClientDurationMS);
+    assert(client != NULL && client->average > 5.9f && client->average < 6.1f);
+    const CFrameStatAccumulatedValue *frame = FindAccumulated(&message, k_EFrameStatFrameDurationMS);
+    assert(frame != NULL && frame->count == 9);
+    assert(frame->average > 19.9f && frame->average < 20.1f);
+
+    /* Pending frame is reported once decoded */
+    DecodeFrame(stats, 10, base + MS(1010), base + MS(1020));
+    IHS_VideoFrameStatsCollect(stats, base + MS(2000), &message);
+    assert(message.n_stats == 1);
+    assert(message.stats[0]->frame_id == 10);
+    assert(FindAccumulated(&message, k_EFrameStatFPS)->count == 1);
+
+    /* Nothing left, no duration stats */
+    IHS_VideoFrameStatsCollect(stats, base + MS(3000), &message);
+    assert(message.n_stats == 0);
+    assert(FindAccumulated(&message, k_EFrameStatFPS)->count == 0);
+    assert(FindAccumulated(&message, k_EFrameStatDecodeDurationMS) == NULL);
+    IHS_VideoFrameStatsDestroy(stats);
+}
+
+static void TestDroppedBySkip() {
+    IHS_VideoFrameStats *stats = IHS_VideoFrameStatsCreate(16);
+    uint32_t base = MS(1000);
+    IHS_VideoFrameStatsReceived(stats, 65534, 100, base);
+    IHS_VideoFrameStatsReceived(stats, 65535, 100, base);
+    IHS_VideoFrameStatsReceived(stats, 0, 100, base);
+    /* Earlier frames never decoded were dropped from decoder queue */
+    DecodeFrame(stats, 0, base + MS(5), base + MS(10));
+    IHS_VideoFrameStatsReceived(stats, 1, 100, base + MS(10));
+    IHS_VideoFrameStatsEvent(stats, 1, k_EStreamFrameEventDecodeBegin, base + MS(10));
+    IHS_VideoFrameStatsEvent(stats, 1, k_EStreamFrameEventDecodeEnd, base + MS(12));
+    IHS_VideoFrameStatsResult(stats, 1, k_EStreamFrameResultDroppedDecodeCorrupt);
+    /* Unknown frames are ignored */
+    IHS_VideoFrameStatsResult(stats, 100, k_EStreamFrameResultDisplayed);
+
+    CFrameStatsListMsg message = CFRAME_STATS_LIST_MSG__INIT;
+    IHS_VideoFrameStatsCollect(stats, base + MS(20), &message);
+    assert(message.n_stats == 4);
+    assert(message.stats[0]->frame_id == 65534);
+    assert(message.stats[0]->result == k_EStreamFrameResultDroppedDecodeSlow);
+    assert(message.stats[1]->result == k_EStreamFrameResultDroppedDecodeSlow);
+    assert(message.stats[2]->result == k_EStreamFrameResultDisplayed);
+    assert(message.stats[3]->result == k_EStreamFrameResultDroppedDecodeCorrupt);
+    assert(message.stats[3]->n_events == 3);
+    assert(FindAccumulated(&message, k_EFrameStatFPS)->count == 1);
+    assert(FindAccumulated(&message, k_EFrameStatClientBitrateKbitPerSec)->count == 4);
+    IHS_VideoFrameStatsDestroy(stats);
+}
+
+static void TestPendingTimeout() {
+    IHS_VideoFrameStats *stats = IHS_VideoFrameStatsCreate(16);
+    uint32_t base = MS(1000);
+    IHS_VideoFrameStatsReceived(stats, 1, 100, base);
+    IHS_VideoFrameStatsEvent(stats, 1, k_EStreamFrameEventDecodeBegin, base);
+
+    CFrameStatsListMsg message = CFRAME_STATS_LIST_MSG__INIT;
+    IHS_VideoFrameStatsCollect(stats, base + MS(500), &message);
+    assert(message.n_stats == 0);
+    IHS_VideoFrameStatsCollect(stats, base + MS(1500), &message);
+    assert(message.n_stats == 1);
+    assert(message.stats[0]->result == k_EStreamFrameResultDroppedDecodeSlow);
+    IHS_VideoFrameStatsDestroy(stats);
+}
+
+static void TestCapacity() {
+    IHS_VideoFrameStats *stats = IHS_VideoFrameStatsCreate(4);
+    uint32_t base = MS(1000);
+    for (uint16_t i = 0; i < 10; i++) {
+        IHS_VideoFrameStatsReceived(stats, i, 100, base);
+        DecodeFrame(stats, i, base, base + MS(1));
+    }
+    /* Oldest frames are forgotten */
+    CFrameStatsListMsg message = CFRAME_STATS_LIST_MSG__INIT;
+    IHS_VideoFrameStatsCollect(stats, base + MS(10), &message);
+    assert(message.n_stats == 4);
+    assert(message.stats[0]->frame_id == 6);
+    assert(message.stats[3]->frame_id == 9);
+    IHS_VideoFrameStatsDestroy(stats);
+}
+
+static void TestExternalEvents() {
+    IHS_VideoFrameStats *stats = IHS_VideoFrameStatsCreate(16);
+    uint32_t base = MS(1000);
+    assert(!IHS_VideoFrameStatsHasExternalEvents(stats));
+    IHS_VideoFrameStatsReceived(stats, 1, 100, base);
+    IHS_VideoFrameStatsEvent(stats, 1, k_EStreamFrameEventDecodeBegin, base + MS(1));
+    IHS_VideoFrameStatsExternalEvent(stats, 1, k_EStreamFrameEventDecodeBegin, base + MS(2));
+    IHS_VideoFrameStatsExternalEvent(stats, 1, k_EStreamFrameEventDecodeEnd, base + MS(5));
+    IHS_VideoFrameStatsExternalEvent(stats, 1, k_EStreamFrameEventUploadBegin, base + MS(6));
+    IHS_VideoFrameStatsExternalEvent(stats, 1, k_EStreamFrameEventUploadEnd, base + MS(7));
+    assert(IHS_VideoFrameStatsHasExternalEvents(stats));
+
+    CFrameStatsListMsg message = CFRAME_STATS_LIST_MSG__INIT;
+    IHS_VideoFrameStatsCollect(stats, base + MS(10), &message);
+    assert(message.n_stats == 0);
+
+    /* Complete event marks the frame displayed */
+    IHS_VideoFrameStatsExternalEvent(stats, 1, k_EStreamFrameEventComplete, base + MS(16));
+    IHS_VideoFrameStatsCollect(stats, base + MS(20), &message);
+    assert(message.n_stats == 1);
+    assert(message.stats[0]->result == k_EStreamFrameResultDisplayed);
+    assert(message.stats[0]->n_events == 6);
+    const CFrameStatAccumulatedValue *decode = FindAccumulated(&message, k_EFrameStatDecodeDurationMS);
+    assert(decode->average > 2.9f && decode->average < 3.1f);
+    const CFrameStatAccumulatedValue *client = FindAccumulated(&message, k_EFrameStatClientDurationMS);
+    assert(client->average > 15.9f && client->average < 16.1f);
+
+    /* Reset forgets frames, but application still reports events */
+    IHS_VideoFrameStatsReceived(stats, 2, 100, base + MS(30));
+    IHS_VideoFrameStatsReset(stats);
+    IHS_VideoFrameStatsCollect(stats, base + MS(2000), &message);
+    assert(message.n_stats == 0);
+    assert(IHS_VideoFrameStatsHasExternalEvents(stats));
+    IHS_VideoFrameStatsDestroy(stats);
+}
+
+static void TestLatencyHistogram() {
+    IHS_VideoFrameStats *stats = IHS_VideoFrameStatsCreate(16);
+    uint32_t base = MS(1000);
+    const uint32_t durations[] = {0, 2, 3, 5, 100, 1000};
+    for (uint16_t i = 0; i < sizeof(durations) / sizeof(durations[0]); i++) {
+        IHS_VideoFrameStatsReceived(stats, i, 100, base);
+        DecodeFrame(stats, i, base, base + MS(durations[i]));
+    }
+    /* Not counted before collected */
+    IHS_VideoFrameLatencyStats latency;
+    IHS_VideoFrameStatsGetLatency(stats, &latency);
+    assert(latency.decode[0] == 0);
+
+    CFrameStatsListMsg message = CFRAME_STATS_LIST_MSG__INIT;
+    IHS_VideoFrameStatsCollect(stats, base + MS(1000), &message);
+    IHS_VideoFrameStatsGetLatency(stats, &latency);
+    const uint64_t expected[IHS_SESSION_LATENCY_HISTOGRAM_SIZE] = {1, 1, 1, 1, 0, 0, 0, 2};
+    for (size_t i = 0; i < IHS_SESSION_LATENCY_HISTOGRAM_SIZE; i++) {
+        assert(latency.decode[i] == expected[i]);
+        assert(latency.display[i] == expected[i]);
+    }
+    /* Histograms are kept after reset */
+    IHS_VideoFrameStatsReset(stats);
+    IHS_VideoFrameStatsGetLatency(stats, &latency);
+    assert(latency.decode[7] == 2);
+    IHS_VideoFrameStatsDestroy(stats);
+}
+
+static void DecodeFrame(IHS_VideoFrameStats *stats, uint16_t frameId, uint32_t begin, uint32_t end) {
+    IHS_VideoFrameStatsEvent(stats, frameId, k_EStreamFrameEventDecodeBegin, begin);
+    IHS_VideoFrameStatsEvent(stats, frameId, k_EStreamFrameEventDecodeEnd, end);
+    IHS_VideoFrameStatsEvent(stats, frameId, k_EStreamFrameEventComplete, end);
+    IHS_VideoFrameStatsResult(stats, frameId, k_EStreamFrameResultDisplayed);
+}
+
+static const CFrameStatAccumulatedValue *FindAccumulated(const CFrameStatsListMsg *message,
+                                                         EFrameAccumulatedStat type) {
+    for (size_t i = 0; i < message->n_accumulated_stats; i++) {
+        if (message->accumulated_stats[i]->stat_type == type) {
+            return message->accumulated_stats[i];
+        }
+    }
+    return NULL;
+}
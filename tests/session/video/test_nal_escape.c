@@ -0,0 +1,119 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "session/channels/video/nal_escape.h"
+#include "session/channels/video/frame_h264.h"
+#include "ihs_buffer_ext.h"
+
+#define DATA_SIZE 1500
+
+/**
+ * Escaping done byte by byte, same as the original implementation
+ */
+static size_t EscapeReference(uint8_t *out, const uint8_t *src, size_t inLen);
+
+static void FillData(uint8_t *data, size_t len, int zeroPercent);
+
+static void TestKernel(const uint8_t *data, size_t len);
+
+static void TestAppendSegments(const uint8_t *data, size_t len);
+
+int main() {
+    uint8_t data[DATA_SIZE];
+    const int zeroPercents[] = {0, 1, 10, 50, 90, 100};
+    for (int p = 0; p < sizeof(zeroPercents) / sizeof(int); p++) {
+        for (int round = 0; round < 20; round++) {
+            FillData(data, sizeof(data), zeroPercents[p]);
+            TestKernel(data, sizeof(data));
+            TestAppendSegments(data, sizeof(data));
+        }
+    }
+    return 0;
+}
+
+static void TestKernel(const uint8_t *data, size_t len) {
+    uint8_t expected[DATA_SIZE * 2], actual[DATA_SIZE * 2];
+    for (size_t start = 0; start < 40; start++) {
+        size_t expectedLen = EscapeReference(expected, &data[start], len - start);
+        /* Reference copies first 2 bytes unescaped */
+        int zeros = 0;
+        memcpy(actual, &data[start], 2);
+        if (actual[1] == 0) {
+            zeros = actual[0] == 0 ? 2 : 1;
+        }
+        size_t escapedSize = IHS_SessionVideoNALEscapedSize(&data[start + 2], len - start - 2, zeros);
+        size_t actualLen = 2 + IHS_SessionVideoNALEscape(&actual[2], &data[start + 2], len - start - 2, &zeros);
+        assert(escapedSize + 2 == actualLen);
+        assert(actualLen == expectedLen);
+        assert(memcmp(actual, expected, actualLen) == 0);
+    }
+}
+
+static void TestAppendSegments(const uint8_t *data, size_t len) {
+    uint8_t expected[DATA_SIZE * 2];
+    size_t expectedLen = EscapeReference(expected, data, len);
+    IHS_VideoFrameHeader header = {.flags = VideoFrameFlagNeedEscape};
+    IHS_Buffer buffer = IHS_BUFFER_INIT(64, 0);
+    for (size_t offset = 0; offset < len;) {
+        size_t segment = 1 + rand() % 64;
+        if (segment > len - offset) {
+            segment = len - offset;
+        }
+        IHS_SessionVideoFrameAppendH264(&buffer, NULL, &data[offset], segment, offset, &header);
+        offset += segment;
+    }
+    assert(buffer.size == expectedLen);
+    assert(memcmp(IHS_BufferPointer(&buffer), expected, expectedLen) == 0);
+    IHS_BufferClear(&buffer, true);
+}
+
+static size_t EscapeReference(uint8_t *out, const uint8_t *src, size_t inLen) {
+    uint8_t *dst = out;
+    const uint8_t *end = src + inLen;
+    for (size_t offset = 0; offset < 2 && src < end; offset++) {
+        *dst++ = *src++;
+    }
+    while (src < end) {
+        if (src[0] <= 0x03 && !dst[-2] && !dst[-1])
+            *dst++ = 0x03;
+        *dst++ = *src++;
+    }
+    return dst - out;
+}
+
+static void FillData(uint8_t *data, size_t len, int zeroPercent) {
+    for (size_t i = 0; i < len; i++) {
+        if (rand() % 100 < zeroPercent) {
+            data[i] = 0;
+        } else {
+            /* Bias towards small values, so that they can be escaped */
+            data[i] = (uint8_t) (rand() % 2 ? rand() % 4 : rand());
+        }
+    }
+}
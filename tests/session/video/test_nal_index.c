@@ -0,0 +1,133 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "session/channels/video/nal_index.h"
+#include "session/channels/video/frame_h264.h"
+#include "session/channels/video/frame_hevc.h"
+#include "session/channels/video/frame_pool.h"
+#include "ihs_buffer.h"
+
+static void TestEscaped();
+
+static void TestAnnexB();
+
+static void TestMovedToFrame();
+
+int main() {
+    TestEscaped();
+    TestAnnexB();
+    TestMovedToFrame();
+    return 0;
+}
+
+static void TestEscaped() {
+    IHS_Buffer buffer = IHS_BUFFER_INIT(1024, 4096);
+    IHS_VideoNALIndex nals;
+    IHS_VideoNALIndexInit(&nals);
+    IHS_VideoFrameHeader header = {.flags = VideoFrameFlagNeedEscape | VideoFrameFlagNeedStartSequence};
+
+    const uint8_t sps[] = {0x67, 0x42, 0x00, 0x1F};
+    const uint8_t slice[] = {0x65, 0x88, 0x00, 0x00, 0x01, 0x02};
+    IHS_SessionVideoFrameAppendH264(&buffer, &nals, sps, sizeof(sps), 0, &header);
+    /* Slice comes in two parts, and needs escaping */
+    IHS_SessionVideoFrameAppendH264(&buffer, &nals, slice, 3, 0, &header);
+    IHS_SessionVideoFrameAppendH264(&buffer, &nals, &slice[3], 3, 3, &header);
+    IHS_VideoNALIndexFinish(&nals, buffer.size);
+
+    assert(nals.count == 2);
+    assert(nals.units[0].offset == 4);
+    assert(nals.units[0].length == sizeof(sps));
+    assert(nals.units[0].type == 7);
+    assert(nals.units[1].offset == 12);
+    assert(nals.units[1].length == sizeof(slice) + 1);
+    assert(nals.units[1].type == 5);
+    assert(buffer.size == nals.units[1].offset + nals.units[1].length);
+
+    IHS_VideoNALIndexClear(&nals);
+    assert(nals.count == 0);
+    IHS_VideoNALIndexDeinit(&nals);
+    IHS_BufferClear(&buffer, true);
+}
+
+static void TestAnnexB() {
+    IHS_Buffer buffer = IHS_BUFFER_INIT(1024, 4096);
+    IHS_VideoNALIndex nals;
+    IHS_VideoNALIndexInit(&nals);
+    IHS_VideoFrameHeader header = {.flags = 0};
+
+    const uint8_t data[] = {
+            0x00, 0x00, 0x00, 0x01, 0x40, 0x01, 0x0C, /* VPS */
+            0x00, 0x00, 0x01, 0x42, 0x01, /* SPS */
+            0x00, 0x00, 0x00, 0x01, 0x26, 0x01, 0xAF, 0x10, /* IDR_W_RADL */
+    };
+    /* Split in the middle of start codes */
+    const size_t splits[] = {2, 9, 14, sizeof(data)};
+    size_t offset = 0;
+    for (size_t i = 0; i < sizeof(splits) / sizeof(splits[0]); i++) {
+        IHS_SessionVideoFrameAppendHEVC(&buffer, &nals, &data[offset], splits[i] - offset, offset, &header);
+        offset = splits[i];
+    }
+    IHS_VideoNALIndexFinish(&nals, buffer.size);
+
+    assert(nals.count == 3);
+    assert(nals.units[0].offset == 4 && nals.units[0].length == 3 && nals.units[0].type == 32);
+    assert(nals.units[1].offset == 10 && nals.units[1].length == 2 && nals.units[1].type == 33);
+    assert(nals.units[2].offset == 16 && nals.units[2].length == 4 && nals.units[2].type == 19);
+    IHS_VideoNALIndexDeinit(&nals);
+    IHS_BufferClear(&buffer, true);
+}
+
+static void TestMovedToFrame() {
+    IHS_VideoFramePool *pool = IHS_VideoFramePoolCreate(1);
+    IHS_Buffer buffer = IHS_BUFFER_INIT(1024, 4096);
+    IHS_VideoNALIndex nals;
+    IHS_VideoNALIndexInit(&nals);
+    IHS_VideoFrameHeader header = {.flags = VideoFrameFlagNeedEscape | VideoFrameFlagNeedStartSequence};
+    const uint8_t slice[] = {0x41, 0x9A};
+    IHS_SessionVideoFrameAppendH264(&buffer, &nals, slice, sizeof(slice), 0, &header);
+    IHS_VideoNALIndexFinish(&nals, buffer.size);
+
+    IHS_StreamVideoFrame *frame = IHS_VideoFramePoolWrap(pool, &buffer, &nals, 1, IHS_StreamVideoFrameNone);
+    assert(nals.count == 0);
+    size_t count;
+    const IHS_StreamVideoNALUnit *units = IHS_StreamVideoFrameGetNALUnits(frame, &count);
+    assert(count == 1);
+    assert(units[0].offset == 4 && units[0].length == 2 && units[0].type == 1);
+    IHS_StreamVideoFrameRelease(frame);
+
+    /* Index of recycled frame is empty */
+    frame = IHS_VideoFramePoolWrap(pool, &buffer, &nals, 2, IHS_StreamVideoFrameNone);
+    IHS_StreamVideoFrameGetNALUnits(frame, &count);
+    assert(count == 0);
+    assert(nals.count == 0 && nals.capacity > 0);
+    IHS_StreamVideoFrameRelease(frame);
+
+    IHS_VideoNALIndexDeinit(&nals);
+    IHS_BufferClear(&buffer, true);
+    IHS_VideoFramePoolDestroy(pool);
+}
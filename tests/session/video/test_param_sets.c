@@ -0,0 +1,112 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "session/channels/video/param_sets.h"
+#include "ihs_buffer.h"
+
+static void TestH264();
+
+static void TestHEVC();
+
+static void TestOtherCodec();
+
+int main() {
+    TestH264();
+    TestHEVC();
+    TestOtherCodec();
+    return 0;
+}
+
+static void TestH264() {
+    IHS_VideoParamSets sets;
+    IHS_VideoParamSetsInit(&sets, IHS_StreamVideoCodecH264);
+
+    const uint8_t idr[] = {
+            0x00, 0x00, 0x00, 0x01, 0x09, 0xF0, /* AUD */
+            0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x1F, /* SPS */
+            0x00, 0x00, 0x01, 0x68, 0xCE, 0x3C, 0x80, /* PPS */
+            0x00, 0x00, 0x00, 0x01, 0x65, 0x88, 0x84, 0x00, 0x00, 0x03, 0x00, 0x01, /* IDR slice */
+            0x00, 0x00, 0x01, 0x67, 0xFF, /* After the slice, ignored */
+    };
+    const uint8_t expected[] = {
+            0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x1F,
+            0x00, 0x00, 0x00, 0x01, 0x68, 0xCE, 0x3C, 0x80,
+    };
+    assert(IHS_VideoParamSetsUpdate(&sets, idr, sizeof(idr)));
+    const IHS_Buffer *data = IHS_VideoParamSetsGetData(&sets);
+    assert(data->size == sizeof(expected));
+    assert(memcmp(IHS_BufferPointer(data), expected, sizeof(expected)) == 0);
+
+    /* Same parameter sets again */
+    assert(!IHS_VideoParamSetsUpdate(&sets, idr, sizeof(idr)));
+
+    /* Only SPS changed, cached PPS is kept */
+    const uint8_t resized[] = {
+            0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x28,
+            0x00, 0x00, 0x00, 0x01, 0x65, 0x88,
+    };
+    assert(IHS_VideoParamSetsUpdate(&sets, resized, sizeof(resized)));
+    data = IHS_VideoParamSetsGetData(&sets);
+    assert(data->size == sizeof(expected));
+    assert(IHS_BufferPointer(data)[7] == 0x28);
+    assert(IHS_BufferPointer(data)[12] == 0x68);
+
+    /* Frame without parameter sets */
+    const uint8_t slice[] = {0x00, 0x00, 0x00, 0x01, 0x41, 0x9A, 0x00, 0x00, 0x01};
+    assert(!IHS_VideoParamSetsUpdate(&sets, slice, sizeof(slice)));
+    assert(!IHS_VideoParamSetsUpdate(&sets, slice, 0));
+    IHS_VideoParamSetsDeinit(&sets);
+}
+
+static void TestHEVC() {
+    IHS_VideoParamSets sets;
+    IHS_VideoParamSetsInit(&sets, IHS_StreamVideoCodecHEVC);
+
+    const uint8_t idr[] = {
+            0x00, 0x00, 0x00, 0x01, 0x40, 0x01, 0x0C, /* VPS */
+            0x00, 0x00, 0x00, 0x01, 0x42, 0x01, 0x01, /* SPS */
+            0x00, 0x00, 0x00, 0x01, 0x44, 0x01, 0xC1, /* PPS */
+            0x00, 0x00, 0x00, 0x01, 0x4E, 0x01, 0x05, /* SEI */
+            0x00, 0x00, 0x00, 0x01, 0x26, 0x01, 0xAF, /* IDR_W_RADL */
+    };
+    assert(IHS_VideoParamSetsUpdate(&sets, idr, sizeof(idr)));
+    const IHS_Buffer *data = IHS_VideoParamSetsGetData(&sets);
+    assert(data->size == 21);
+    assert(memcmp(IHS_BufferPointer(data), idr, 21) == 0);
+    assert(!IHS_VideoParamSetsUpdate(&sets, idr, sizeof(idr)));
+    IHS_VideoParamSetsDeinit(&sets);
+}
+
+static void TestOtherCodec() {
+    IHS_VideoParamSets sets;
+    IHS_VideoParamSetsInit(&sets, IHS_StreamVideoCodecVP9);
+    const uint8_t frame[] = {0x00, 0x00, 0x00, 0x01, 0x67, 0x42};
+    assert(!IHS_VideoParamSetsUpdate(&sets, frame, sizeof(frame)));
+    assert(IHS_VideoParamSetsGetData(&sets)->size == 0);
+    IHS_VideoParamSetsDeinit(&sets);
+}
@@ -25,7 +25,24 @@
 
 #include "session/channels/video/partial_frames.h"
 
+static IHS_SessionSegmentedFrame *WrapData(IHS_SessionSegmentedFrame *frame, IHS_Buffer *data);
+
+static IHS_SessionSegmentedFrame *NewData(IHS_SessionSegmentedFrame *frame, uint8_t value);
+
+static void TestInsert();
+
+static void TestAddOrder();
+
+static void TestWrapAndGrow();
+
 int main() {
+    TestInsert();
+    TestAddOrder();
+    TestWrapAndGrow();
+    return 0;
+}
+
+static void TestInsert() {
     IHS_VideoPartialFrames frames;
     IHS_VideoPartialFramesInit(&frames);
     IHS_VideoFrameHeader header1 = {
@@ -36,7 +53,8 @@ int main() {
     };
     IHS_Buffer data1 = IHS_BUFFER_INIT(16, 16);
     IHS_BufferFillMem(&data1, 0, 0, 16);
-    IHS_VideoPartialFrame *partial1 = IHS_VideoPartialFramesAppend(&frames, 500, &header1, &data1);
+    IHS_SessionSegmentedFrame frame1;
+    IHS_VideoPartialFramesAppend(&frames, 500, &header1, WrapData(&frame1, &data1));
     assert(IHS_VideoPartialFramesCount(&frames) == 1);
 
     IHS_VideoFrameHeader header2 = {
@@ -47,10 +65,12 @@ int main() {
     };
     IHS_Buffer data2 = IHS_BUFFER_INIT(16, 16);
     IHS_BufferFillMem(&data2, 0, 0, 16);
+    IHS_SessionSegmentedFrame frame2;
 
-    IHS_VideoPartialFrame *partial2 = IHS_VideoPartialFramesInsertBefore(&frames, partial1, 500, &header2, &data2);
+    IHS_VideoPartialFramesInsert(&frames, 0, 500, &header2, WrapData(&frame2, &data2));
     assert(IHS_VideoPartialFramesCount(&frames) == 2);
-    assert(partial2->next == partial1);
+    assert(IHS_VideoPartialFramesAt(&frames, 0)->header.sequence == 884);
+    assert(IHS_VideoPartialFramesAt(&frames, 1)->header.sequence == 883);
 
     IHS_VideoFrameHeader header3 = {
             .sequence = 885,
@@ -60,12 +80,13 @@ int main() {
     };
     IHS_Buffer data3 = IHS_BUFFER_INIT(16, 16);
     IHS_BufferFillMem(&data3, 0, 0, 16);
+    IHS_SessionSegmentedFrame frame3;
 
-    IHS_VideoPartialFrame *partial3 = IHS_VideoPartialFramesInsertBefore(&frames, partial1, 500, &header3, &data3);
+    IHS_VideoPartialFramesInsert(&frames, 1, 500, &header3, WrapData(&frame3, &data3));
     assert(IHS_VideoPartialFramesCount(&frames) == 3);
-    assert(partial3->next == partial1);
-    assert(partial2->next == partial3);
-    assert(frames.tail == partial1);
+    assert(IHS_VideoPartialFramesAt(&frames, 0)->header.sequence == 884);
+    assert(IHS_VideoPartialFramesAt(&frames, 1)->header.sequence == 885);
+    assert(IHS_VideoPartialFramesAt(&frames, 2)->header.sequence == 883);
 
     IHS_VideoFrameHeader header4 = {
             .sequence = 886,
@@ -75,11 +96,90 @@ int main() {
     };
     IHS_Buffer data4 = IHS_BUFFER_INIT(16, 16);
     IHS_BufferFillMem(&data4, 0, 0, 16);
+    IHS_SessionSegmentedFrame frame4;
 
-    IHS_VideoPartialFrame *partial4 = IHS_VideoPartialFramesAppend(&frames, 500, &header4, &data4);
+    IHS_VideoPartialFramesAppend(&frames, 500, &header4, WrapData(&frame4, &data4));
     assert(IHS_VideoPartialFramesCount(&frames) == 4);
-    assert(frames.tail == partial4);
+    assert(IHS_VideoPartialFramesAt(&frames, 3)->header.sequence == 886);
+    assert(IHS_VideoPartialFramesAt(&frames, 4) == NULL);
 
-    IHS_VideoPartialFramesClear(&frames);
-    return 0;
-}
\ No newline at end of file
+    assert(IHS_VideoPartialFramesClear(&frames) == 4);
+    assert(IHS_VideoPartialFramesCount(&frames) == 0);
+    IHS_VideoPartialFramesDeinit(&frames);
+}
+
+static void TestAddOrder() {
+    IHS_VideoPartialFrames frames;
+    IHS_VideoPartialFramesInit(&frames);
+    IHS_SessionSegmentedFrame data;
+
+    IHS_VideoFrameHeader header = {.sequence = 1, .reserved1 = 2, .reserved2 = 0};
+    IHS_VideoPartialFramesAdd(&frames, 65534, &header, NewData(&data, 1));
+    /* Newer frame ID across wrap around is appended */
+    header.sequence = 2;
+    IHS_VideoPartialFramesAdd(&frames, 2, &header, NewData(&data, 2));
+    /* Same frame ID with smaller reserved2 goes before */
+    header.sequence = 3;
+    header.reserved2 = 1;
+    IHS_VideoPartialFramesAdd(&frames, 65534, &header, NewData(&data, 3));
+    /* Older frame ID without any match goes to the tail */
+    header.sequence = 4;
+    IHS_VideoPartialFramesAdd(&frames, 65533, &header, NewData(&data, 4));
+
+    assert(IHS_VideoPartialFramesCount(&frames) == 4);
+    assert(IHS_VideoPartialFramesAt(&frames, 0)->header.sequence == 3);
+    assert(IHS_VideoPartialFramesAt(&frames, 1)->header.sequence == 1);
+    assert(IHS_VideoPartialFramesAt(&frames, 2)->header.sequence == 2);
+    assert(IHS_VideoPartialFramesAt(&frames, 3)->header.sequence == 4);
+
+    IHS_VideoPartialFramesRemoveHead(&frames);
+    assert(IHS_VideoPartialFramesCount(&frames) == 3);
+    assert(IHS_VideoPartialFramesAt(&frames, 0)->header.sequence == 1);
+    IHS_VideoPartialFramesDeinit(&frames);
+}
+
+static void TestWrapAndGrow() {
+    IHS_VideoPartialFrames frames;
+    IHS_VideoPartialFramesInit(&frames);
+    IHS_SessionSegmentedFrame data;
+    IHS_VideoFrameHeader header = {0};
+    uint16_t nextId = 0, expectSequence = 0;
+
+    /* Move head away from the start of storage */
+    for (int i = 0; i < 20; i++) {
+        header.sequence = nextId;
+        IHS_VideoPartialFramesAdd(&frames, nextId++, &header, NewData(&data, 0));
+        IHS_VideoPartialFramesRemoveHead(&frames);
+        expectSequence++;
+    }
+    size_t initialCapacity = frames.capacity;
+    /* Fill beyond capacity while wrapped around */
+    for (size_t i = 0; i < initialCapacity + 5; i++) {
+        header.sequence = nextId;
+        IHS_VideoPartialFramesAdd(&frames, nextId++, &header, NewData(&data, (uint8_t) i));
+    }
+    assert(frames.capacity > initialCapacity);
+    assert(IHS_VideoPartialFramesCount(&frames) == initialCapacity + 5);
+    for (size_t i = 0; i < initialCapacity + 5; i++) {
+        IHS_VideoPartialFrame *partial = IHS_VideoPartialFramesAt(&frames, 0);
+        assert(partial->header.sequence == expectSequence++);
+        uint8_t value;
+        assert(IHS_SessionSegmentedFrameCopy(&partial->data, 0, &value, 1) == 1);
+        assert(value == (uint8_t) i);
+        IHS_VideoPartialFramesRemoveHead(&frames);
+    }
+    assert(IHS_VideoPartialFramesCount(&frames) == 0);
+    IHS_VideoPartialFramesDeinit(&frames);
+}
+
+static IHS_SessionSegmentedFrame *WrapData(IHS_SessionSegmentedFrame *frame, IHS_Buffer *data) {
+    IHS_SessionSegmentedFrameInit(frame, NULL);
+    IHS_SessionSegmentedFrameAppend(frame, data);
+    return frame;
+}
+
+static IHS_SessionSegmentedFrame *NewData(IHS_SessionSegmentedFrame *frame, uint8_t value) {
+    IHS_Buffer buffer = IHS_BUFFER_INIT(16, 16);
+    IHS_BufferFillMem(&buffer, 0, value, 16);
+    return WrapData(frame, &buffer);
+}
@@ -0,0 +1,213 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "test_session.h"
+#include "session/channels/video/ch_data_video.h"
+#include "ihs_buffer.h"
+#include "ihs_buffer_ext.h"
+#include "ihs_thread.h"
+
+#define VIDEO_CHANNEL_ID 3
+
+/**
+ * Decoder that records submitted slices, and reports frame lost for one frame
+ */
+typedef struct SliceDecoder {
+    IHS_Mutex *lock;
+    IHS_Cond *cond;
+    IHS_StreamVideoSlice slices[8];
+    uint8_t firstBytes[8];
+    int numSlices;
+    int paramSetsChanged;
+    uint16_t lostFrameId;
+} SliceDecoder;
+
+static int framesLost = 0;
+
+static void TestSlices();
+
+static void FeedDataFrame(IHS_SessionChannel *channel, uint16_t id, uint16_t sequence, uint8_t flags,
+                          const uint8_t *data, size_t len);
+
+static void DecoderWaitSlices(SliceDecoder *decoder, int count);
+
+static int DecoderStart(IHS_Session *session, const IHS_StreamVideoConfig *config, void *context);
+
+static IHS_StreamVideoSubmitResult DecoderSubmitSlice(IHS_Session *session, const IHS_StreamVideoSlice *slice,
+                                                      void *context);
+
+static void DecoderParamSetsChanged(IHS_Session *session, const IHS_Buffer *paramSets, void *context);
+
+static void DecoderStop(IHS_Session *session, void *context);
+
+static void CountFramesLost(IHS_LogLevel level, const char *tag, const char *message);
+
+static const IHS_StreamVideoCallbacks DecoderCallbacks = {
+        .start = DecoderStart,
+        .submitSlice = DecoderSubmitSlice,
+        .parameterSetsChanged = DecoderParamSetsChanged,
+        .stop = DecoderStop,
+};
+
+int main() {
+    IHS_Init();
+    TestSlices();
+    IHS_Quit();
+    return 0;
+}
+
+static void TestSlices() {
+    const uint8_t idr[] = {
+            0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x1F, /* SPS */
+            0x00, 0x00, 0x00, 0x01, 0x68, 0xCE, 0x3C, 0x80, /* PPS */
+            0x00, 0x00, 0x00, 0x01, 0x65, 0x88, 0x84, /* IDR slice */
+    };
+    const uint8_t slice[] = {0x00, 0x00, 0x00, 0x01, 0x41, 0x9A};
+    SliceDecoder decoder = {.lock = IHS_MutexCreate(), .cond = IHS_CondCreate(), .lostFrameId = 4};
+    IHS_Session *session = IHS_TestSessionCreate();
+    IHS_SessionSetLogFunction(session, CountFramesLost);
+    IHS_SessionSetVideoCallbacks(session, &DecoderCallbacks, &decoder);
+
+    CStartVideoDataMsg message = CSTART_VIDEO_DATA_MSG__INIT;
+    message.channel = VIDEO_CHANNEL_ID;
+    message.codec = k_EStreamVideoCodecH264;
+    IHS_SessionChannel *channel = IHS_SessionChannelDataVideoCreate(session, &message);
+
+    /* Slices of a frame are submitted in order, the last one with end of frame marker */
+    FeedDataFrame(channel, 1, 0, VideoFrameFlagKeyFrame, idr, sizeof(idr));
+    FeedDataFrame(channel, 2, 1, 0, slice, sizeof(slice));
+    FeedDataFrame(channel, 3, 2, VideoFrameFlagFrameFinish, slice, sizeof(slice));
+    DecoderWaitSlices(&decoder, 3);
+    for (int i = 0; i < 3; i++) {
+        assert(decoder.slices[i].frameId == 1);
+        assert(decoder.slices[i].flags & IHS_StreamVideoFrameKeyFrame);
+        assert(decoder.slices[i].endOfFrame == (i == 2));
+    }
+    assert(decoder.slices[0].size == sizeof(idr));
+    assert(decoder.slices[1].size == sizeof(slice));
+    assert(decoder.firstBytes[2] == slice[0]);
+    /* Parameter sets are picked from the first slice of the keyframe */
+    assert(decoder.paramSetsChanged == 1);
+
+    /* Frame is cut short by next keyframe, result of its slice is still handled */
+    FeedDataFrame(channel, 4, 3, 0, slice, sizeof(slice));
+    DecoderWaitSlices(&decoder, 4);
+    assert(decoder.slices[3].frameId == 4);
+    assert(!decoder.slices[3].endOfFrame);
+    assert(framesLost == 0);
+    FeedDataFrame(channel, 5, 4, VideoFrameFlagKeyFrame | VideoFrameFlagFrameFinish, idr, sizeof(idr));
+    DecoderWaitSlices(&decoder, 5);
+    assert(decoder.slices[4].frameId == 5);
+    assert(decoder.slices[4].endOfFrame);
+    assert(framesLost == 1);
+    /* Same parameter sets */
+    assert(decoder.paramSetsChanged == 1);
+
+    IHS_SessionChannelDataStopped(channel);
+    IHS_SessionChannelDestroy(channel);
+    IHS_SessionDestroy(session);
+    IHS_CondDestroy(decoder.cond);
+    IHS_MutexDestroy(decoder.lock);
+}
+
+static void FeedDataFrame(IHS_SessionChannel *channel, uint16_t id, uint16_t sequence, uint8_t flags,
+                          const uint8_t *data, size_t len) {
+    IHS_SessionPacket packet;
+    memset(&packet, 0, sizeof(IHS_SessionPacket));
+    packet.header.type = IHS_SessionPacketTypeUnreliable;
+    packet.header.channelId = VIDEO_CHANNEL_ID;
+    packet.header.packetId = id;
+    packet.header.sendTimestamp = id;
+    IHS_BufferInit(&packet.body, 64, 64);
+    IHS_BufferAppendUInt8(&packet.body, k_EStreamDataPacket);
+    /* Data frame header */
+    IHS_BufferAppendUInt16LE(&packet.body, id);
+    IHS_BufferAppendUInt32LE(&packet.body, id);
+    IHS_BufferAppendUInt16LE(&packet.body, 0);
+    IHS_BufferAppendUInt32LE(&packet.body, 0);
+    /* Video frame header */
+    IHS_BufferAppendUInt16LE(&packet.body, sequence);
+    IHS_BufferAppendUInt8(&packet.body, flags);
+    IHS_BufferAppendUInt16LE(&packet.body, 0);
+    IHS_BufferAppendUInt16LE(&packet.body, 0);
+    IHS_BufferAppendMem(&packet.body, data, len);
+    IHS_SessionChannelDataReceived(channel, &packet);
+    IHS_BufferClear(&packet.body, true);
+}
+
+static void DecoderWaitSlices(SliceDecoder *decoder, int count) {
+    IHS_MutexLock(decoder->lock);
+    while (decoder->numSlices < count) {
+        IHS_CondWait(decoder->cond, decoder->lock);
+    }
+    IHS_MutexUnlock(decoder->lock);
+}
+
+static int DecoderStart(IHS_Session *session, const IHS_StreamVideoConfig *config, void *context) {
+    (void) session;
+    (void) config;
+    (void) context;
+    return 0;
+}
+
+static IHS_StreamVideoSubmitResult DecoderSubmitSlice(IHS_Session *session, const IHS_StreamVideoSlice *slice,
+                                                      void *context) {
+    (void) session;
+    SliceDecoder *decoder = context;
+    IHS_MutexLock(decoder->lock);
+    assert(decoder->numSlices < 8);
+    decoder->firstBytes[decoder->numSlices] = slice->size > 0 ? slice->data[0] : 0xFF;
+    decoder->slices[decoder->numSlices] = *slice;
+    /* Data is only valid during the call */
+    decoder->slices[decoder->numSlices++].data = NULL;
+    IHS_CondBroadcast(decoder->cond);
+    IHS_MutexUnlock(decoder->lock);
+    return slice->frameId == decoder->lostFrameId ? IHS_StreamVideoSubmitReportLost : IHS_StreamVideoSubmitOK;
+}
+
+static void DecoderParamSetsChanged(IHS_Session *session, const IHS_Buffer *paramSets, void *context) {
+    (void) session;
+    (void) paramSets;
+    SliceDecoder *decoder = context;
+    IHS_MutexLock(decoder->lock);
+    decoder->paramSetsChanged++;
+    IHS_MutexUnlock(decoder->lock);
+}
+
+static void DecoderStop(IHS_Session *session, void *context) {
+    (void) session;
+    (void) context;
+}
+
+static void CountFramesLost(IHS_LogLevel level, const char *tag, const char *message) {
+    (void) level;
+    if (strcmp(tag, "Video") == 0 && strstr(message, "frame lost") != NULL) {
+        framesLost++;
+    }
+}
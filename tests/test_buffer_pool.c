@@ -0,0 +1,91 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <assert.h>
+#include <stdlib.h>
+
+#include "ihs_buffer_pool.h"
+#include "ihs_buffer.h"
+
+int main() {
+    IHS_BufferPool *pool = IHS_BufferPoolCreate(64, 2);
+    IHS_BufferPoolStats stats;
+    IHS_Buffer a, b, c;
+    IHS_BufferPoolObtain(pool, &a);
+    IHS_BufferPoolObtain(pool, &b);
+    assert(a.capacity == 64 && a.size == 0 && a.offset == 0);
+    IHS_BufferAppendMem(&a, (const uint8_t *) "hello", 5);
+    assert(a.size == 5);
+
+    IHS_BufferPoolGetStats(pool, &stats);
+    assert(stats.idle == 0);
+    assert(stats.inUse == 2);
+    assert(stats.exhausted == 0);
+
+    // Pool is used up, buffer will still be allocated
+    IHS_BufferPoolObtain(pool, &c);
+    assert(!IHS_BufferIsNull(&c));
+    IHS_BufferPoolGetStats(pool, &stats);
+    assert(stats.inUse == 3);
+    assert(stats.exhausted == 1);
+
+    uint8_t *reused = a.data;
+    IHS_BufferPoolRecycle(pool, &a);
+    assert(IHS_BufferIsNull(&a));
+    IHS_BufferPoolRecycle(pool, &b);
+    // Pool is full, this one will be freed
+    IHS_BufferPoolRecycle(pool, &c);
+    assert(IHS_BufferIsNull(&c));
+
+    IHS_BufferPoolGetStats(pool, &stats);
+    assert(stats.idle == 2);
+    assert(stats.inUse == 0);
+    assert(stats.highWaterMark == 3);
+
+    // Idle buffers are reused in LIFO order
+    IHS_BufferPoolObtain(pool, &b);
+    IHS_BufferPoolObtain(pool, &a);
+    assert(a.data == reused);
+
+    // Running out of idle buffers is not exhaustion while fewer than capacity are in use
+    IHS_BufferPoolRecycle(pool, &b);
+    IHS_BufferPoolObtain(pool, &b);
+    IHS_BufferPoolRecycle(pool, &b);
+    IHS_BufferPoolObtain(pool, &b);
+    IHS_BufferPoolGetStats(pool, &stats);
+    assert(stats.inUse == 2);
+    assert(stats.highWaterMark == 3);
+    assert(stats.exhausted == 1);
+
+    // Buffers with different size are freed instead
+    IHS_BufferPoolRecycle(pool, &b);
+    IHS_Buffer other = IHS_BUFFER_INIT(128, 128);
+    IHS_BufferAppendMem(&other, (const uint8_t *) "world", 5);
+    IHS_BufferPoolRecycle(pool, &other);
+    assert(IHS_BufferIsNull(&other));
+
+    IHS_BufferPoolRecycle(pool, &a);
+    IHS_BufferPoolDestroy(pool);
+    return 0;
+}
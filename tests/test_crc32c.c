@@ -0,0 +1,73 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crc32c.h"
+
+static void CheckAllImplementations(const uint8_t *buf, size_t len);
+
+int main() {
+    IHS_CRC32CInit();
+
+    // Well known check value
+    const char *check = "123456789";
+    assert(IHS_CRC32CTable((const uint8_t *) check, 9) == 0xE3069283);
+    assert(IHS_CRC32C((const uint8_t *) check, 9) == 0xE3069283);
+    assert(IHS_CRC32C(NULL, 0) == 0);
+
+    if (!IHS_CRC32CHardwareSupported()) {
+        printf("Hardware CRC32C not supported, only checking software implementations\n");
+    }
+
+    // Every length up to a few words, then some packet sizes, from every alignment
+    uint8_t *data = malloc(4096 + 8);
+    srand(0x1EDC6F41);
+    for (int i = 0; i < 4096 + 8; i++) {
+        data[i] = (uint8_t) rand();
+    }
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len <= 64; len++) {
+            CheckAllImplementations(data + offset, len);
+        }
+        const size_t sizes[] = {13, 17, 1200, 1400, 1500, 2048, 4096};
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(size_t); i++) {
+            CheckAllImplementations(data + offset, sizes[i]);
+        }
+    }
+    free(data);
+    return 0;
+}
+
+static void CheckAllImplementations(const uint8_t *buf, size_t len) {
+    uint32_t expected = IHS_CRC32CTable(buf, len);
+    assert(IHS_CRC32CSlicing8(buf, len) == expected);
+    if (IHS_CRC32CHardwareSupported()) {
+        assert(IHS_CRC32CHardware(buf, len) == expected);
+    }
+    assert(IHS_CRC32C(buf, len) == expected);
+}
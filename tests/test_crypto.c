@@ -0,0 +1,144 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crypto.h"
+
+static void TestHMAC(IHS_CryptoHMACType type, const uint8_t *key, size_t keyLen, const char *data,
+                     const uint8_t *expected, size_t expectedLen);
+
+static void TestCipher(size_t plainLen);
+
+int main() {
+    uint8_t key[131];
+    memset(key, 0x0b, 20);
+    /* RFC 2202 test case 1 */
+    const uint8_t md5Expected[] = {
+            0x92, 0x94, 0x72, 0x7a, 0x36, 0x38, 0xbb, 0x1c, 0x13, 0xf4, 0x8e, 0xf8, 0x15, 0x8b, 0xfc, 0x9d,
+    };
+    TestHMAC(IHS_CryptoHMACMD5, key, 16, "Hi There", md5Expected, sizeof(md5Expected));
+    /* RFC 4231 test case 1 */
+    const uint8_t sha256Expected[] = {
+            0xb0, 0x34, 0x4c, 0x61, 0xd8, 0xdb, 0x38, 0x53, 0x5c, 0xa8, 0xaf, 0xce, 0xaf, 0x0b, 0xf1, 0x2b,
+            0x88, 0x1d, 0xc2, 0x00, 0xc9, 0x83, 0x3d, 0xa7, 0x26, 0xe9, 0x37, 0x6c, 0x2e, 0x32, 0xcf, 0xf7,
+    };
+    TestHMAC(IHS_CryptoHMACSHA256, key, 20, "Hi There", sha256Expected, sizeof(sha256Expected));
+    /* RFC 4231 test case 6, key longer than block size */
+    memset(key, 0xaa, sizeof(key));
+    const uint8_t sha256LongKeyExpected[] = {
+            0x60, 0xe4, 0x31, 0x59, 0x1e, 0xe0, 0xb6, 0x7f, 0x0d, 0x8a, 0x26, 0xaa, 0xcb, 0xf5, 0xb7, 0x7f,
+            0x8e, 0x0b, 0xc6, 0x21, 0x37, 0x28, 0xc5, 0x14, 0x05, 0x46, 0x04, 0x0f, 0x0e, 0xe3, 0x7f, 0x54,
+    };
+    TestHMAC(IHS_CryptoHMACSHA256, key, sizeof(key), "Test Using Larger Than Block-Size Key - Hash Key First",
+             sha256LongKeyExpected, sizeof(sha256LongKeyExpected));
+
+    TestCipher(0);
+    TestCipher(15);
+    TestCipher(16);
+    TestCipher(1200);
+    return 0;
+}
+
+static void TestHMAC(IHS_CryptoHMACType type, const uint8_t *key, size_t keyLen, const char *data,
+                     const uint8_t *expected, size_t expectedLen) {
+    IHS_CryptoHMAC *hmac = IHS_CryptoHMACCreate(type, key, keyLen);
+    assert(hmac != NULL);
+    assert(IHS_CryptoHMACSize(hmac) == expectedLen);
+    uint8_t out[32];
+    /* Computed twice to make sure the cached state isn't modified */
+    for (int i = 0; i < 2; i++) {
+        memset(out, 0, sizeof(out));
+        assert(IHS_CryptoHMACCompute(hmac, (const uint8_t *) data, strlen(data), out) == 0);
+        assert(memcmp(out, expected, expectedLen) == 0);
+    }
+    IHS_CryptoHMACDestroy(hmac);
+}
+
+static void TestCipher(size_t plainLen) {
+    uint8_t key[32], iv[IHS_CRYPTO_AES_BLOCK_SIZE];
+    for (int i = 0; i < sizeof(key); i++) {
+        key[i] = (uint8_t) rand();
+    }
+    for (int i = 0; i < sizeof(iv); i++) {
+        iv[i] = (uint8_t) rand();
+    }
+    uint8_t *plain = malloc(plainLen + 1);
+    for (size_t i = 0; i < plainLen; i++) {
+        plain[i] = (uint8_t) rand();
+    }
+    size_t cipherCap = plainLen + IHS_CRYPTO_AES_BLOCK_SIZE * 2;
+    uint8_t *expected = malloc(cipherCap), *actual = malloc(cipherCap), *decrypted = malloc(cipherCap);
+
+    IHS_CryptoCipher *cipher = IHS_CryptoCipherCreate(key, sizeof(key));
+    assert(cipher != NULL);
+
+    /* Cached key schedule gives same result as one-shot function */
+    size_t expectedLen = cipherCap, actualLen = cipherCap;
+    assert(IHS_CryptoSymmetricEncryptWithIV(plain, plainLen, iv, sizeof(iv), key, sizeof(key), true, expected,
+                                            &expectedLen) == 0);
+    assert(IHS_CryptoCipherEncryptWithIV(cipher, plain, plainLen, iv, sizeof(iv), true, actual, &actualLen) == 0);
+    assert(actualLen == expectedLen);
+    assert(actualLen == sizeof(iv) + (plainLen / IHS_CRYPTO_AES_BLOCK_SIZE + 1) * IHS_CRYPTO_AES_BLOCK_SIZE);
+    assert(memcmp(actual, expected, actualLen) == 0);
+
+    size_t decryptedLen = cipherCap;
+    assert(IHS_CryptoSymmetricDecrypt(actual, actualLen, key, sizeof(key), decrypted, &decryptedLen) == 0);
+    assert(decryptedLen == plainLen);
+    assert(memcmp(decrypted, plain, plainLen) == 0);
+
+    decryptedLen = cipherCap;
+    assert(IHS_CryptoCipherDecryptWithIV(cipher, actual + sizeof(iv), actualLen - sizeof(iv), iv, sizeof(iv),
+                                         decrypted, &decryptedLen) == 0);
+    assert(decryptedLen == plainLen);
+    assert(memcmp(decrypted, plain, plainLen) == 0);
+
+    memcpy(decrypted, actual + sizeof(iv), actualLen - sizeof(iv));
+    decryptedLen = actualLen - sizeof(iv);
+    assert(IHS_CryptoCipherDecryptInPlace(cipher, decrypted, &decryptedLen, iv, sizeof(iv)) == 0);
+    assert(decryptedLen == plainLen);
+    assert(memcmp(decrypted, plain, plainLen) == 0);
+
+    /* In place encryption matches cipher text after IV */
+    memcpy(decrypted, plain, plainLen);
+    size_t encryptedLen = plainLen;
+    assert(IHS_CryptoCipherEncryptInPlace(cipher, decrypted, &encryptedLen, cipherCap, iv, sizeof(iv)) == 0);
+    assert(encryptedLen == actualLen - sizeof(iv));
+    assert(memcmp(decrypted, actual + sizeof(iv), encryptedLen) == 0);
+
+    /* Corrupted padding is rejected */
+    actual[actualLen - 1] ^= 0xFF;
+    decryptedLen = cipherCap;
+    assert(IHS_CryptoCipherDecryptWithIV(cipher, actual + sizeof(iv), actualLen - sizeof(iv), iv, sizeof(iv),
+                                         decrypted, &decryptedLen) != 0);
+
+    IHS_CryptoCipherDestroy(cipher);
+    free(plain);
+    free(expected);
+    free(actual);
+    free(decrypted);
+}
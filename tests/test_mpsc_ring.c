@@ -0,0 +1,106 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <assert.h>
+#include <stdint.h>
+#include <sched.h>
+
+#include "ihs_mpsc_ring.h"
+#include "ihs_thread.h"
+
+#define PRODUCERS 4
+#define ITEMS_PER_PRODUCER 100000
+
+typedef struct TestItem {
+    uint32_t producer;
+    uint32_t sequence;
+} TestItem;
+
+typedef struct ProducerContext {
+    IHS_MPSCRing *ring;
+    uint32_t id;
+} ProducerContext;
+
+static void Producer(void *context);
+
+int main() {
+    IHS_MPSCRing *ring = IHS_MPSCRingCreate(sizeof(TestItem), 5);
+    TestItem item;
+    assert(IHS_MPSCRingIsEmpty(ring));
+    assert(!IHS_MPSCRingPoll(ring, &item));
+
+    // Capacity is rounded up to 8
+    for (uint32_t i = 0; i < 8; i++) {
+        item.sequence = i;
+        assert(IHS_MPSCRingOffer(ring, &item));
+    }
+    assert(!IHS_MPSCRingOffer(ring, &item));
+    for (uint32_t i = 0; i < 8; i++) {
+        assert(IHS_MPSCRingPoll(ring, &item));
+        assert(item.sequence == i);
+    }
+    assert(IHS_MPSCRingIsEmpty(ring));
+    IHS_MPSCRingDestroy(ring);
+
+    ring = IHS_MPSCRingCreate(sizeof(TestItem), 64);
+    ProducerContext contexts[PRODUCERS];
+    IHS_Thread *threads[PRODUCERS];
+    for (uint32_t i = 0; i < PRODUCERS; i++) {
+        contexts[i].ring = ring;
+        contexts[i].id = i;
+        threads[i] = IHS_ThreadCreate(Producer, "Producer", &contexts[i]);
+    }
+    // Items from the same producer must arrive in order
+    uint32_t nextSequence[PRODUCERS] = {0};
+    uint32_t received = 0;
+    while (received < PRODUCERS * ITEMS_PER_PRODUCER) {
+        if (!IHS_MPSCRingPoll(ring, &item)) {
+            sched_yield();
+            continue;
+        }
+        assert(item.producer < PRODUCERS);
+        assert(item.sequence == nextSequence[item.producer]);
+        nextSequence[item.producer]++;
+        received++;
+    }
+    for (uint32_t i = 0; i < PRODUCERS; i++) {
+        IHS_ThreadJoin(threads[i]);
+        assert(nextSequence[i] == ITEMS_PER_PRODUCER);
+    }
+    assert(IHS_MPSCRingIsEmpty(ring));
+    IHS_MPSCRingDestroy(ring);
+    return 0;
+}
+
+static void Producer(void *context) {
+    ProducerContext *producer = context;
+    TestItem item = {.producer = producer->id};
+    for (uint32_t i = 0; i < ITEMS_PER_PRODUCER; i++) {
+        item.sequence = i;
+        while (!IHS_MPSCRingOffer(producer->ring, &item)) {
+            // Ring is full, retry until consumer catches up
+            sched_yield();
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <assert.h>
+#include <stddef.h>
+
+#include "ihs_queue.h"
+
+typedef struct IHS_QueueItem {
+    int value;
+} TestItem;
+
+static bool ValueEquals(TestItem *item, void *context);
+
+static void NoopDestroy(TestItem *item, void *context);
+
+static TestItem *AppendValue(IHS_Queue *queue, int value);
+
+int main() {
+    IHS_Queue *queue = IHS_QueueCreate(sizeof(TestItem));
+    assert(IHS_QueueIsEmpty(queue));
+
+    for (int i = 0; i < 5; i++) {
+        AppendValue(queue, i);
+    }
+
+    // Remove tail, then append again. The new item must come after the new tail
+    int value = 4;
+    TestItem *removed = IHS_QueuePollBy(queue, (IHS_QueuePredicateFunction *) ValueEquals, &value);
+    assert(removed != NULL && removed->value == 4);
+    IHS_QueueItemFree(removed);
+    AppendValue(queue, 5);
+
+    // Remove every odd item, including the tail
+    size_t iterated = IHS_QueuePollEach(queue, (IHS_QueuePredicateFunction *) ValueEquals, NULL,
+                                        (IHS_QueueConsumerFunction *) NoopDestroy, NULL);
+    assert(iterated == 5);
+    AppendValue(queue, 6);
+
+    const int expected[] = {0, 2, 6};
+    for (int i = 0; i < 3; i++) {
+        TestItem *item = IHS_QueuePoll(queue);
+        assert(item != NULL && item->value == expected[i]);
+        IHS_QueueItemFree(item);
+    }
+    assert(IHS_QueueIsEmpty(queue));
+    assert(IHS_QueuePoll(queue) == NULL);
+
+    // Queue drained through poll must accept items again
+    AppendValue(queue, 7);
+    TestItem *item = IHS_QueuePoll(queue);
+    assert(item->value == 7);
+    IHS_QueueItemFree(item);
+
+    IHS_QueueDestroy(queue, NULL, NULL);
+    return 0;
+}
+
+static bool ValueEquals(TestItem *item, void *context) {
+    if (context == NULL) {
+        return item->value % 2 == 1;
+    }
+    return item->value == *((int *) context);
+}
+
+static void NoopDestroy(TestItem *item, void *context) {
+    (void) item;
+    (void) context;
+}
+
+static TestItem *AppendValue(IHS_Queue *queue, int value) {
+    TestItem *item = IHS_QueueItemObtain(queue);
+    item->value = value;
+    IHS_QueueAppend(queue, item);
+    return item;
+}
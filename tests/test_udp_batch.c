@@ -0,0 +1,148 @@
+/*
+ *  _____  _   _  _____  _  _  _     
+ * |_   _|| | | |/  ___|| |(_)| |     Steam    
+ *   | |  | |_| |\ `--. | | _ | |__     In-Home
+ *   | |  |  _  | `--. \| || || '_ \      Streaming
+ *  _| |_ | | | |/\__/ /| || || |_) |       Library
+ *  \___/ \_| |_/\____/ |_||_||_.__/
+ *
+ * Copyright (c) 2022 Mariotaku <https://github.com/mariotaku>.
+ * 
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "ihs_udp.h"
+#include "ihs_buffer.h"
+
+#define NUM_PACKETS 5
+/* Larger than any UDP datagram, so sending it fails */
+#define OVERSIZED_INDEX 2
+#define OVERSIZED_SIZE 70000
+
+static void TestSendBatch(IHS_UDPSocket *socket, int peer, const IHS_SocketAddress *peerAddress);
+
+static void TestReceiveBatch(IHS_UDPSocket *socket, int peer, const struct sockaddr_in *address,
+                             const IHS_SocketAddress *peerAddress);
+
+/**
+ * Plain socket bound to a port on loopback interface
+ */
+static int PeerOpen(IHS_SocketAddress *address);
+
+int main() {
+    IHS_SocketAddress peerAddress;
+    int peer = PeerOpen(&peerAddress);
+    IHS_UDPSocket *socket = IHS_UDPSocketOpen(false);
+    assert(IHS_UDPSocketSetRecvTimeout(socket, 1000000));
+
+    TestSendBatch(socket, peer, &peerAddress);
+
+    // Find out the port of our socket
+    struct sockaddr_in address;
+    socklen_t addressLen = sizeof(address);
+    uint8_t probe = 0xFF;
+    IHS_UDPPacket packet = {.address = peerAddress, .buffer = IHS_BUFFER_INIT(1, 1)};
+    IHS_BufferAppendMem(&packet.buffer, &probe, 1);
+    assert(IHS_UDPSocketSend(socket, &packet));
+    assert(recvfrom(peer, &probe, 1, 0, (struct sockaddr *) &address, &addressLen) == 1);
+    IHS_BufferClear(&packet.buffer, true);
+
+    TestReceiveBatch(socket, peer, &address, &peerAddress);
+
+    IHS_UDPSocketClose(socket);
+    close(peer);
+    return 0;
+}
+
+static void TestSendBatch(IHS_UDPSocket *socket, int peer, const IHS_SocketAddress *peerAddress) {
+    IHS_UDPPacket packets[NUM_PACKETS];
+    for (int i = 0; i < NUM_PACKETS; i++) {
+        packets[i].address = *peerAddress;
+        size_t size = i == OVERSIZED_INDEX ? OVERSIZED_SIZE : 1;
+        IHS_BufferInit(&packets[i].buffer, size, size);
+        IHS_BufferFillMem(&packets[i].buffer, 0, i, size);
+    }
+
+    // Failed packet is skipped, everything after it still gets sent
+    assert(IHS_UDPSocketSendBatch(socket, packets, NUM_PACKETS) == NUM_PACKETS - 1);
+    for (int i = 0; i < NUM_PACKETS; i++) {
+        if (i == OVERSIZED_INDEX) {
+            continue;
+        }
+        uint8_t data[2];
+        assert(recv(peer, data, sizeof(data), 0) == 1);
+        assert(data[0] == i);
+    }
+
+    for (int i = 0; i < NUM_PACKETS; i++) {
+        IHS_BufferClear(&packets[i].buffer, true);
+    }
+}
+
+static void TestReceiveBatch(IHS_UDPSocket *socket, int peer, const struct sockaddr_in *address,
+                             const IHS_SocketAddress *peerAddress) {
+    for (uint8_t i = 0; i < NUM_PACKETS; i++) {
+        assert(sendto(peer, &i, 1, 0, (const struct sockaddr *) address, sizeof(*address)) == 1);
+    }
+
+    IHS_UDPPacket packets[NUM_PACKETS + 1];
+    for (int i = 0; i < NUM_PACKETS + 1; i++) {
+        IHS_BufferInit(&packets[i].buffer, 2048, 2048);
+    }
+    // Without recvmmsg, datagrams are received one at a time
+    int received = 0;
+    while (received < NUM_PACKETS) {
+        int ret = IHS_UDPSocketReceiveBatch(socket, packets + received, NUM_PACKETS + 1 - received);
+        assert(ret > 0);
+        received += ret;
+    }
+    assert(received == NUM_PACKETS);
+    for (int i = 0; i < NUM_PACKETS; i++) {
+        assert(packets[i].buffer.size == 1);
+        assert(IHS_BufferPointer(&packets[i].buffer)[0] == i);
+        assert(IHS_IPAddressCompare(&packets[i].address.ip, &peerAddress->ip) == 0);
+        assert(packets[i].address.port == peerAddress->port);
+    }
+    for (int i = 0; i < NUM_PACKETS + 1; i++) {
+        IHS_BufferClear(&packets[i].buffer, true);
+    }
+}
+
+static int PeerOpen(IHS_SocketAddress *address) {
+    int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    assert(fd >= 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    assert(bind(fd, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+    socklen_t addrLen = sizeof(addr);
+    assert(getsockname(fd, (struct sockaddr *) &addr, &addrLen) == 0);
+    struct timeval timeout = {.tv_sec = 1};
+    assert(setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0);
+
+    memset(address, 0, sizeof(IHS_SocketAddress));
+    address->ip.family = IHS_IPAddressFamilyIPv4;
+    memcpy(address->ip.v4.data, &addr.sin_addr, 4);
+    address->port = ntohs(addr.sin_port);
+    return fd;
+}